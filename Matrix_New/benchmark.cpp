@@ -0,0 +1,510 @@
+﻿/**
+* \file benchmark.cpp
+* \brief Pomiary wydajności operacji macierzy (mikro i makro) z wynikami w formacie JSON.
+*
+* Budowanie pod Linuksem (z katalogu Matrix_New):
+*
+*     g++ -std=c++17 -O2 -march=native -pthread -Isrc $(find src -name '*.cpp') benchmark.cpp -o matrix_benchmark
+*
+* Użycie:
+*
+*     matrix_benchmark [--filter=REGEX] [--min-size=N] [--max-size=N] [--min-time=SEKUNDY]
+*                      [--threads=N] [--format=console|json] [--out=PLIK]
+*
+* Każda rodzina pomiarów uruchamiana jest dla rozmiarów n x n będących
+* potęgami dwójki od --min-size (domyślnie 8) do --max-size (domyślnie 8192).
+* Liczba iteracji dobierana jest tak, by pomiar trwał co najmniej --min-time
+* sekund (domyślnie 0.5). Raportowane są czas na operację, GFLOP/s, GB/s
+* oraz liczba alokacji na operację (wywołania operator new i alokatora
+* macierzy). Przy --format=json wyniki trafiają do --out (lub na stdout),
+* a tabela postępu na stderr. Pełny przegląd do 8192 trwa długo (mnożenie
+* 8192 x 8192 to ponad 10^12 operacji) - do szybkich porównań warto
+* ograniczyć --max-size.
+*/
+#include "src/matrix.h"
+#include "src/simd.h"
+#include "src/thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <regex>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// Liczba wywołań operator new od startu programu.
+static std::atomic<unsigned long long> heapAllocations(0);
+
+// Zastępcze operator new/delete używają malloc/free; GCC po ich wstawieniu
+// w miejsce wywołań fałszywie zgłasza niedopasowanie new i free.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t bytes) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(bytes ? bytes : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t bytes) {
+    return operator new(bytes);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+/**
+* \class counting_allocator
+* \brief Alokator macierzy zliczający alokacje i przekazujący je dalej.
+*/
+class counting_allocator : public allocator {
+    private:
+        allocator& upstream; ///< Właściwe źródło pamięci.
+
+    public:
+        std::atomic<unsigned long long> calls; ///< Liczba wywołań allocate().
+
+        /**
+        * \brief Konstruktor.
+        * \param u Właściwe źródło pamięci.
+        */
+        explicit counting_allocator(allocator& u) : upstream(u), calls(0) {}
+
+        void* allocate(std::size_t bytes, std::size_t alignment) override {
+            calls.fetch_add(1, std::memory_order_relaxed);
+            return upstream.allocate(bytes, alignment);
+        }
+
+        void deallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept override {
+            upstream.deallocate(p, bytes, alignment);
+        }
+};
+
+/**
+* \class null_buffer
+* \brief Bufor strumienia odrzucający dane i zliczający zapisane bajty.
+*/
+class null_buffer : public std::streambuf {
+    private:
+        char sink[1 << 14]; ///< Obszar zapisu nadpisywany przy każdym przepełnieniu.
+
+    public:
+        unsigned long long written; ///< Liczba zapisanych bajtów.
+
+        null_buffer() : written(0) {
+            setp(sink, sink + sizeof(sink));
+        }
+
+    protected:
+        int_type overflow(int_type c) override {
+            written += pptr() - pbase();
+            setp(sink, sink + sizeof(sink));
+            if (!traits_type::eq_int_type(c, traits_type::eof())) {
+                *pptr() = traits_type::to_char_type(c);
+                pbump(1);
+            }
+            return traits_type::not_eof(c);
+        }
+
+        std::streamsize xsputn(const char* s, std::streamsize n) override {
+            (void)s;
+            written += n;
+            return n;
+        }
+};
+
+/// Ujście wyników porównań, żeby kompilator nie usunął pomiaru.
+static volatile int sink = 0;
+
+/**
+* \brief Rodzina pomiarów: jedna operacja mierzona dla kolejnych rozmiarów.
+*/
+struct family {
+    std::string name; ///< Nazwa operacji.
+    std::function<double(double)> flops; ///< Liczba operacji arytmetycznych na wywołanie dla rozmiaru n.
+    std::function<double(double)> bytes; ///< Liczba bajtów czytanych i zapisywanych na wywołanie dla rozmiaru n.
+    std::function<std::function<void(long long)>(int)> prepare; ///< Przygotowuje dane dla rozmiaru n i zwraca pętlę wykonującą operację zadaną liczbę razy.
+};
+
+/**
+* \brief Wynik jednego pomiaru.
+*/
+struct result {
+    std::string name;        ///< Nazwa w postaci rodzina/rozmiar.
+    std::string familyName;  ///< Nazwa rodziny.
+    int size;                ///< Rozmiar n.
+    long long iterations;    ///< Liczba wykonanych operacji.
+    double seconds;          ///< Łączny czas.
+    double nsPerOp;          ///< Czas jednej operacji w nanosekundach.
+    double gflops;           ///< GFLOP/s (0, jeśli operacja nie liczy).
+    double gbytes;           ///< GB/s.
+    double allocsPerOp;      ///< Alokacje na operację.
+};
+
+/**
+* \brief Tworzy macierz n x n z wartościami losowymi 0..9 (stałe ziarno).
+* \param n Rozmiar.
+* \return Macierz.
+*/
+static matrix randomMatrix(int n) {
+    matrix m(n, n);
+    m.randomize(rng::options::uniform(0, 9), 2024);
+    return m;
+}
+
+/**
+* \brief Zwraca listę rodzin pomiarów dla wszystkich operatorów macierzy.
+* \return Rodziny.
+*/
+static std::vector<family> families() {
+    const double e = sizeof(int);
+    const auto none = [](double) { return 0.0; };
+    const auto readWrite = [e](double n) { return 2 * n * n * e; };
+    const auto perElement = [](double n) { return n * n; };
+    std::vector<family> f;
+
+    // Konstrukcja i kopiowanie.
+    f.push_back({ "construct", none, [e](double n) { return n * n * e; }, [](int n) {
+        return std::function<void(long long)>([n](long long iters) {
+            for (long long i = 0; i < iters; ++i) {
+                matrix m(n, n);
+                sink = sink + m.getRows();
+            }
+        });
+    } });
+    f.push_back({ "copy_construct", none, readWrite, [](int n) {
+        auto a = std::make_shared<matrix>(randomMatrix(n));
+        return std::function<void(long long)>([a](long long iters) {
+            for (long long i = 0; i < iters; ++i) {
+                matrix m(*a);
+                sink = sink + m.getRows();
+            }
+        });
+    } });
+    f.push_back({ "copy_assign", none, readWrite, [](int n) {
+        auto a = std::make_shared<matrix>(randomMatrix(n));
+        auto b = std::make_shared<matrix>(n, n);
+        return std::function<void(long long)>([a, b](long long iters) {
+            for (long long i = 0; i < iters; ++i) {
+                *b = *a;
+            }
+        });
+    } });
+    f.push_back({ "move", none, none, [](int n) {
+        auto a = std::make_shared<matrix>(randomMatrix(n));
+        return std::function<void(long long)>([a](long long iters) {
+            for (long long i = 0; i < iters; ++i) {
+                matrix t(std::move(*a));
+                *a = std::move(t);
+            }
+        });
+    } });
+
+    // Mnożenie i dodawanie macierzy (mnożenie przez jedynkową i dodawanie zerowej nie zmieniają danych).
+    f.push_back({ "multiply", [](double n) { return 2 * n * n * n; }, [e](double n) { return 3 * n * n * e; }, [](int n) {
+        auto a = std::make_shared<matrix>(randomMatrix(n));
+        auto id = std::make_shared<matrix>(n, n);
+        id->diagonal();
+        return std::function<void(long long)>([a, id](long long iters) {
+            for (long long i = 0; i < iters; ++i) {
+                *a * *id;
+            }
+        });
+    } });
+    f.push_back({ "product", [](double n) { return 2 * n * n * n; }, [e](double n) { return 3 * n * n * e; }, [](int n) {
+        auto a = std::make_shared<matrix>(randomMatrix(n));
+        auto b = std::make_shared<matrix>(randomMatrix(n));
+        return std::function<void(long long)>([a, b](long long iters) {
+            for (long long i = 0; i < iters; ++i) {
+                matrix c = a->product<int>(*b);
+                sink = sink + c.getRows();
+            }
+        });
+    } });
+    f.push_back({ "add_matrix", perElement, [e](double n) { return 3 * n * n * e; }, [](int n) {
+        auto a = std::make_shared<matrix>(randomMatrix(n));
+        auto zero = std::make_shared<matrix>(n, n);
+        return std::function<void(long long)>([a, zero](long long iters) {
+            for (long long i = 0; i < iters; ++i) {
+                *a + *zero;
+            }
+        });
+    } });
+
+    // Operatory skalarne. Kolejne wywołania na przemian wykonują operację i jej
+    // odwrotność (ciągle, także między powtórzeniami), więc wartości nie rosną.
+    const auto scalar = [&](const char* name, std::function<void(matrix&)> op, std::function<void(matrix&)> inverse) {
+        f.push_back({ name, perElement, readWrite, [op, inverse](int n) {
+            auto a = std::make_shared<matrix>(randomMatrix(n));
+            auto odd = std::make_shared<bool>(false);
+            return std::function<void(long long)>([a, odd, op, inverse](long long iters) {
+                for (long long i = 0; i < iters; ++i) {
+                    (*odd ? inverse : op)(*a);
+                    *odd = !*odd;
+                }
+            });
+        } });
+    };
+    const auto add = [](matrix& m) { m + 1; };
+    const auto sub = [](matrix& m) { m - 1; };
+    const auto negate = [](matrix& m) { m * -1; };
+    const auto addAssign = [](matrix& m) { m += 1; };
+    const auto subAssign = [](matrix& m) { m -= 1; };
+    const auto negateAssign = [](matrix& m) { m *= -1; };
+    const auto increment = [](matrix& m) { m++; };
+    const auto decrement = [](matrix& m) { m--; };
+    scalar("add_scalar", add, sub);
+    scalar("sub_scalar", sub, add);
+    scalar("mul_scalar", negate, negate);
+    scalar("add_assign", addAssign, subAssign);
+    scalar("sub_assign", subAssign, addAssign);
+    scalar("mul_assign", negateAssign, negateAssign);
+    scalar("increment", increment, decrement);
+    scalar("decrement", decrement, increment);
+    scalar("call_add", [](matrix& m) { m(1.0); }, [](matrix& m) { m(-1.0); });
+
+    // Porównania (pełne przejście danych): b = a + offset, więc relacja
+    // zachodzi dla każdego elementu i żadne porównanie nie kończy się wcześniej.
+    const auto compare = [&](const char* name, int offset, std::function<bool(const matrix&, const matrix&)> op) {
+        f.push_back({ name, none, readWrite, [offset, op](int n) {
+            auto a = std::make_shared<matrix>(randomMatrix(n));
+            auto b = std::make_shared<matrix>(*a);
+            *b += offset;
+            return std::function<void(long long)>([a, b, op](long long iters) {
+                for (long long i = 0; i < iters; ++i) {
+                    sink = sink + op(*a, *b);
+                }
+            });
+        } });
+    };
+    compare("equal", 0, [](const matrix& a, const matrix& b) { return a == b; });
+    compare("less", 1, [](const matrix& a, const matrix& b) { return a < b; });
+    compare("greater", -1, [](const matrix& a, const matrix& b) { return a > b; });
+
+    // Transpozycja.
+    f.push_back({ "transpose", none, readWrite, [](int n) {
+        auto a = std::make_shared<matrix>(randomMatrix(n));
+        return std::function<void(long long)>([a](long long iters) {
+            for (long long i = 0; i < iters; ++i) {
+                a->transpose();
+            }
+        });
+    } });
+    f.push_back({ "transpose_into", none, readWrite, [](int n) {
+        auto a = std::make_shared<matrix>(randomMatrix(n));
+        auto b = std::make_shared<matrix>(n, n);
+        return std::function<void(long long)>([a, b](long long iters) {
+            for (long long i = 0; i < iters; ++i) {
+                a->transposeInto(*b);
+            }
+        });
+    } });
+
+    // Wypisywanie tekstowe; GB/s liczone od bajtów tekstu.
+    f.push_back({ "stream_out", none, [](double n) { return n * n * 2; }, [](int n) {
+        auto a = std::make_shared<matrix>(randomMatrix(n));
+        return std::function<void(long long)>([a](long long iters) {
+            null_buffer buffer;
+            std::ostream out(&buffer);
+            for (long long i = 0; i < iters; ++i) {
+                out << *a;
+            }
+            out.flush();
+        });
+    } });
+    return f;
+}
+
+/**
+* \brief Mierzy jedną rodzinę dla rozmiaru n.
+* \param f Rodzina.
+* \param n Rozmiar.
+* \param minTime Minimalny łączny czas pomiaru w sekundach.
+* \param counter Alokator zliczający, zainstalowany jako bieżący.
+* \return Wynik.
+*/
+static result measure(const family& f, int n, double minTime, counting_allocator& counter) {
+    using clock = std::chrono::steady_clock;
+    const std::function<void(long long)> run = f.prepare(n);
+    run(1);
+    long long iters = 1;
+    double seconds = 0;
+    unsigned long long allocations = 0;
+    for (;;) {
+        const unsigned long long heapBefore = heapAllocations.load();
+        const unsigned long long matrixBefore = counter.calls.load();
+        const clock::time_point start = clock::now();
+        run(iters);
+        seconds = std::chrono::duration<double>(clock::now() - start).count();
+        allocations = heapAllocations.load() - heapBefore + counter.calls.load() - matrixBefore;
+        if (seconds >= minTime || iters >= (1LL << 40)) {
+            break;
+        }
+        // Kolejna próba celuje w 1.4 * minTime, ale zwiększa liczbę iteracji najwyżej 10 razy.
+        const double target = seconds > 0 ? minTime * 1.4 / seconds * iters : iters * 10.0;
+        iters = std::max(iters + 1, static_cast<long long>(std::min(target, iters * 10.0)));
+    }
+    result r;
+    r.familyName = f.name;
+    r.name = f.name + "/" + std::to_string(n);
+    r.size = n;
+    r.iterations = iters;
+    r.seconds = seconds;
+    r.nsPerOp = seconds * 1e9 / iters;
+    r.gflops = f.flops(n) * iters / seconds * 1e-9;
+    r.gbytes = f.bytes(n) * iters / seconds * 1e-9;
+    r.allocsPerOp = static_cast<double>(allocations) / iters;
+    return r;
+}
+
+/**
+* \brief Zwraca nazwę aktywnego zestawu instrukcji.
+* \return Nazwa.
+*/
+static const char* levelName(simd::level l) {
+    switch (l) {
+        case simd::level::sse42: return "sse4.2";
+        case simd::level::avx2: return "avx2";
+        case simd::level::avx512: return "avx512";
+        default: return "scalar";
+    }
+}
+
+/**
+* \brief Zapisuje wyniki w formacie JSON.
+* \param o Strumień.
+* \param results Wyniki.
+*/
+static void writeJson(std::ostream& o, const std::vector<result>& results) {
+    char date[32];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+    o << "{\n  \"context\": {\n";
+    o << "    \"date\": \"" << date << "\",\n";
+    o << "    \"threads\": " << thread_pool::instance().getThreadCount() << ",\n";
+    o << "    \"simd\": \"" << levelName(simd::getLevel()) << "\",\n";
+    o << "    \"element_type\": \"int\"\n  },\n  \"benchmarks\": [";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const result& r = results[i];
+        o << (i ? ",\n" : "\n") << "    {\"name\": \"" << r.name << "\", \"family\": \"" << r.familyName
+            << "\", \"size\": " << r.size << ", \"iterations\": " << r.iterations
+            << ", \"real_time_ns\": " << r.nsPerOp << ", \"gflops\": " << r.gflops
+            << ", \"gbytes_per_second\": " << r.gbytes << ", \"allocs_per_op\": " << r.allocsPerOp << "}";
+    }
+    o << "\n  ]\n}\n";
+}
+
+/**
+* \brief Wypisuje wiersz wyników w formacie tabeli.
+* \param to Strumień (stdout lub, przy wyjściu JSON, stderr).
+* \param r Wynik.
+*/
+static void printRow(std::FILE* to, const result& r) {
+    std::fprintf(to, "%-24s %14.1f %12lld %10.3f %10.3f %10.2f\n", r.name.c_str(), r.nsPerOp, r.iterations, r.gflops, r.gbytes, r.allocsPerOp);
+    std::fflush(to);
+}
+
+/**
+* \brief Zwraca wartość opcji --name=value, jeśli arg ją zawiera.
+* \param arg Argument wiersza poleceń.
+* \param name Nazwa opcji z myślnikami.
+* \param value Wartość (wyjście).
+* \return true, jeśli arg dotyczy tej opcji.
+*/
+static bool option(const std::string& arg, const std::string& name, std::string& value) {
+    if (arg.compare(0, name.size() + 1, name + "=") != 0) {
+        return false;
+    }
+    value = arg.substr(name.size() + 1);
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string filter = ".*";
+    std::string format = "console";
+    std::string outPath;
+    int minSize = 8;
+    int maxSize = 8192;
+    int threads = 0;
+    double minTime = 0.5;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        std::string v;
+        if (option(arg, "--filter", v)) filter = v;
+        else if (option(arg, "--format", v)) format = v;
+        else if (option(arg, "--out", v)) outPath = v;
+        else if (option(arg, "--min-size", v)) minSize = std::atoi(v.c_str());
+        else if (option(arg, "--max-size", v)) maxSize = std::atoi(v.c_str());
+        else if (option(arg, "--threads", v)) threads = std::atoi(v.c_str());
+        else if (option(arg, "--min-time", v)) minTime = std::atof(v.c_str());
+        else {
+            std::fprintf(stderr, "usage: %s [--filter=REGEX] [--min-size=N] [--max-size=N] [--min-time=S] [--threads=N] [--format=console|json] [--out=FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (format != "console" && format != "json") {
+        std::fprintf(stderr, "unknown format: %s\n", format.c_str());
+        return 1;
+    }
+    if (threads > 0) {
+        thread_pool::instance().configure(threads, false);
+    }
+
+    counting_allocator counter(currentAllocator());
+    setAllocator(&counter);
+    const std::regex pattern(filter);
+    // Tabela trafia na stdout, a przy wyjściu JSON - jako postęp na stderr.
+    std::FILE* table = format == "json" ? stderr : stdout;
+    std::fprintf(table, "%-24s %14s %12s %10s %10s %10s\n", "benchmark", "ns/op", "iterations", "GFLOP/s", "GB/s", "allocs/op");
+    std::vector<result> results;
+    for (const family& f : families()) {
+        for (int n = minSize; n <= maxSize; n *= 2) {
+            if (!std::regex_search(f.name + "/" + std::to_string(n), pattern)) {
+                continue;
+            }
+            results.push_back(measure(f, n, minTime, counter));
+            printRow(table, results.back());
+        }
+    }
+    setAllocator(nullptr);
+
+    if (format == "json") {
+        if (outPath.empty()) {
+            writeJson(std::cout, results);
+        } else {
+            std::ofstream out(outPath);
+            writeJson(out, results);
+            if (!out) {
+                std::fprintf(stderr, "cannot write %s\n", outPath.c_str());
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,268 @@
+﻿#include "band.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+/// Liczba wierszy w jednej porcji pracy równoległych jąder.
+static const int ROW_BLOCK = 64;
+
+/**
+* \brief Wykonuje task(first, last) dla porcji po ROW_BLOCK wierszy, równolegle przy dużym koszcie.
+* \param rows Liczba wierszy.
+* \param work Przybliżona liczba mnożeń.
+* \param task Funkcja przetwarzająca wiersze [first, last).
+*/
+template <typename F>
+static void forRowBlocks(int rows, double work, const F& task) {
+    if (work < 1 << 18) {
+        task(0, rows);
+        return;
+    }
+    thread_pool::instance().parallelFor((rows + ROW_BLOCK - 1) / ROW_BLOCK, [&](int b) {
+        task(b * ROW_BLOCK, std::min(rows, (b + 1) * ROW_BLOCK));
+    });
+}
+
+/**
+* \brief Konstruktor domyślny (macierz 0 x 0).
+*/
+template <typename T>
+band_matrix<T>::band_matrix() : rows(0), cols(0), lower(0), upper(0) {}
+
+/**
+* \brief Konstruktor tworzący zerową macierz wstęgową r x c.
+* \param r Liczba wierszy.
+* \param c Liczba kolumn.
+* \param kl Liczba przekątnych pod główną (obcinana do r - 1).
+* \param ku Liczba przekątnych nad główną (obcinana do c - 1).
+*/
+template <typename T>
+band_matrix<T>::band_matrix(int r, int c, int kl, int ku)
+    : rows(r), cols(c), lower(std::min(kl, std::max(r - 1, 0))), upper(std::min(ku, std::max(c - 1, 0))) {
+    if (lower + upper < 0) {
+        lower = 0;
+        upper = 0;
+    }
+    data.assign(static_cast<std::size_t>(rows) * width(), T(0));
+}
+
+/**
+* \brief Konstruktor kopiujący wstęgę macierzy gęstej (elementy spoza wstęgi są pomijane).
+* \param m Macierz gęsta.
+* \param kl Liczba przekątnych pod główną.
+* \param ku Liczba przekątnych nad główną.
+*/
+template <typename T>
+band_matrix<T>::band_matrix(const basic_matrix<T>& m, int kl, int ku) : band_matrix(m.rows, m.cols, kl, ku) {
+    for (int i = 0; i < rows; ++i) {
+        const int j0 = firstCol(i);
+        const T* r = m.rowPtr(i);
+        T* b = bandAt(i);
+        for (int j = j0; j < endCol(i); ++j) {
+            b[j - j0] = r[j];
+        }
+    }
+}
+
+/**
+* \brief Wstawia wartość na pozycję (x, y); pozycje spoza wstęgi są pomijane.
+* \param x Wiersz.
+* \param y Kolumna.
+* \param value Wartość do wstawienia.
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+band_matrix<T>& band_matrix<T>::insert(int x, int y, T value) {
+    if (x >= 0 && x < rows && y >= firstCol(x) && y < endCol(x)) {
+        bandRow(x)[y - x + lower] = value;
+    }
+    return *this;
+}
+
+/**
+* \brief Zwraca wartość z macierzy na pozycji (x, y).
+* \param x Wiersz.
+* \param y Kolumna.
+* \return Wartość (0 poza wstęgą i poza macierzą).
+*/
+template <typename T>
+T band_matrix<T>::show(int x, int y) const {
+    if (x >= 0 && x < rows && y >= firstCol(x) && y < endCol(x)) {
+        return bandRow(x)[y - x + lower];
+    }
+    return T(0);
+}
+
+/**
+* \brief Zamienia macierz na gęstą.
+* \return Macierz gęsta rows x cols.
+*/
+template <typename T>
+basic_matrix<T> band_matrix<T>::toDense() const {
+    basic_matrix<T> result(rows, cols);
+    for (int i = 0; i < rows; ++i) {
+        const int j0 = firstCol(i);
+        const T* b = bandAt(i);
+        T* r = result.rowPtr(i);
+        for (int j = j0; j < endCol(i); ++j) {
+            r[j] = b[j - j0];
+        }
+    }
+    return result;
+}
+
+/**
+* \brief Zamienia macierz w k-tą przekątną o zadanych wartościach (wstęga szerokości 1).
+* \param k Numer przekątnej.
+* \param t Tablica wartości (nullptr - same jedynki).
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+band_matrix<T>& band_matrix<T>::diagonal_k(int k, const T* t) {
+    lower = -k;
+    upper = k;
+    data.assign(rows, T(0));
+    const int first = k < 0 ? -k : 0;
+    for (int i = first; i < rows && i + k < cols; ++i) {
+        data[i] = t != nullptr ? t[i - first] : T(1);
+    }
+    return *this;
+}
+
+/**
+* \brief Zamienia macierz w przekątną o zadanych wartościach (wstęga szerokości 1).
+* \param t Tablica min(rows, cols) wartości do ustawienia na przekątnej.
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+band_matrix<T>& band_matrix<T>::diagonal(const T* t) {
+    return diagonal_k(0, t);
+}
+
+/**
+* \brief Zamienia macierz w jednostkową przekątną (wstęga szerokości 1).
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+band_matrix<T>& band_matrix<T>::diagonal() {
+    return diagonal_k(0, nullptr);
+}
+
+/**
+* \brief Suma macierzy wstęgowych; wstęga wyniku jest sumą wstęg.
+* \param m Macierz o tych samych wymiarach.
+* \return Nowa macierz wstęgowa.
+*/
+template <typename T>
+band_matrix<T> band_matrix<T>::add(const band_matrix& m) const {
+    if (rows != m.rows || cols != m.cols) {
+        throw std::invalid_argument("band addition: shape mismatch");
+    }
+    band_matrix result(rows, cols, std::max(lower, m.lower), std::max(upper, m.upper));
+    for (int i = 0; i < rows; ++i) {
+        const int c0 = result.firstCol(i);
+        T* c = result.bandAt(i);
+        const T* a = bandAt(i);
+        const T* b = m.bandAt(i);
+        for (int j = firstCol(i); j < endCol(i); ++j) {
+            c[j - c0] = a[j - firstCol(i)];
+        }
+        for (int j = m.firstCol(i); j < m.endCol(i); ++j) {
+            c[j - c0] += b[j - m.firstCol(i)];
+        }
+    }
+    return result;
+}
+
+/**
+* \brief Iloczyn macierzy wstęgowych w O(rows * szerokość * szerokość).
+*
+* Wiersz i wyniku to suma wierszy wstęgi m ważonych elementami wiersza i
+* wstęgi *this; każdy wiersz m leży w pamięci ciągle, więc pętla
+* wewnętrzna jest wektoryzowana.
+* \param m Macierz wstęgowa cols x n.
+* \return Nowa macierz wstęgowa rows x n.
+*/
+template <typename T>
+band_matrix<T> band_matrix<T>::multiply(const band_matrix& m) const {
+    if (cols != m.rows) {
+        throw std::invalid_argument("band multiplication: inner dimensions differ");
+    }
+    band_matrix result(rows, m.cols, lower + m.lower, upper + m.upper);
+    const double work = static_cast<double>(rows) * width() * m.width();
+    forRowBlocks(rows, work, [&](int first, int last) {
+        for (int i = first; i < last; ++i) {
+            const int k0 = firstCol(i);
+            const int c0 = result.firstCol(i);
+            T* c = result.bandAt(i);
+            const T* a = bandAt(i);
+            for (int k = k0; k < endCol(i); ++k) {
+                const T aik = a[k - k0];
+                const int j0 = m.firstCol(k);
+                const int n = m.endCol(k) - j0;
+                const T* b = m.bandAt(k);
+                T* ck = c + (j0 - c0);
+                for (int j = 0; j < n; ++j) {
+                    ck[j] += aik * b[j];
+                }
+            }
+        }
+    });
+    return result;
+}
+
+/**
+* \brief Iloczyn z macierzą gęstą w O(rows * szerokość * n).
+* \param m Macierz gęsta cols x n.
+* \return Macierz gęsta rows x n.
+*/
+template <typename T>
+basic_matrix<T> band_matrix<T>::multiply(const basic_matrix<T>& m) const {
+    if (cols != m.rows) {
+        throw std::invalid_argument("band multiplication: inner dimensions differ");
+    }
+    basic_matrix<T> result(rows, m.cols);
+    const int n = m.cols;
+    const double work = static_cast<double>(rows) * width() * n;
+    forRowBlocks(rows, work, [&](int first, int last) {
+        for (int i = first; i < last; ++i) {
+            const int k0 = firstCol(i);
+            T* c = result.rowPtr(i);
+            const T* a = bandAt(i);
+            for (int k = k0; k < endCol(i); ++k) {
+                const T aik = a[k - k0];
+                const T* b = m.rowPtr(k);
+                for (int j = 0; j < n; ++j) {
+                    c[j] += aik * b[j];
+                }
+            }
+        }
+    });
+    return result;
+}
+
+/**
+* \brief Iloczyn z wektorem: y = A * x.
+* \param x Wektor cols wartości.
+* \param y Wektor rows wartości na wynik (nie może pokrywać się z x).
+*/
+template <typename T>
+void band_matrix<T>::multiply(const T* x, T* y) const {
+    for (int i = 0; i < rows; ++i) {
+        const int j0 = firstCol(i);
+        const T* a = bandAt(i);
+        T sum = T(0);
+        for (int j = j0; j < endCol(i); ++j) {
+            sum += a[j - j0] * x[j];
+        }
+        y[i] = sum;
+    }
+}
+
+template class band_matrix<std::int8_t>;
+template class band_matrix<std::int16_t>;
+template class band_matrix<std::int32_t>;
+template class band_matrix<std::int64_t>;
+template class band_matrix<float>;
+template class band_matrix<double>;
\ No newline at end of file
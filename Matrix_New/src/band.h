@@ -0,0 +1,225 @@
+﻿#pragma once
+#include <vector>
+#include "matrix.h"
+
+/**
+ * \class band_matrix
+ * \brief Macierz wstęgowa rows x cols: przechowywane są tylko przekątne od -lower do upper.
+ *
+ * Element (i, j) należy do wstęgi, gdy -lower <= j - i <= upper, i leży
+ * w wierszu i bufora na pozycji j - i + lower (każdy wiersz ma
+ * lower + upper + 1 pozycji). lower i upper mogą być ujemne, np. sama
+ * k-ta przekątna to lower = -k, upper = k. Pamięć i koszt działań są
+ * proporcjonalne do rows * (lower + upper + 1).
+ *
+ * Jawnie konkretyzowana dla tych samych typów co basic_matrix.
+ */
+template <typename T>
+class band_matrix {
+    private:
+        int rows; ///< Liczba wierszy.
+        int cols; ///< Liczba kolumn.
+        int lower; ///< Liczba przekątnych pod główną (najniższa przekątna to -lower).
+        int upper; ///< Liczba przekątnych nad główną (najwyższa przekątna to upper).
+        std::vector<T> data; ///< Wstęga zapisana wierszami, rows * width() elementów.
+
+        /**
+         * \brief Zwraca liczbę przechowywanych przekątnych.
+         * \return lower + upper + 1.
+         */
+        int width() const { return lower + upper + 1; }
+
+        /**
+         * \brief Zwraca wskaźnik na element (i, i - lower), czyli początek wiersza i wstęgi.
+         * \param i Numer wiersza.
+         * \return Wskaźnik na pierwszy element wiersza wstęgi.
+         */
+        T* bandRow(int i) { return data.data() + static_cast<std::ptrdiff_t>(i) * width(); }
+
+        /**
+         * \brief Zwraca wskaźnik na element (i, i - lower), czyli początek wiersza i wstęgi.
+         * \param i Numer wiersza.
+         * \return Wskaźnik na pierwszy element wiersza wstęgi.
+         */
+        const T* bandRow(int i) const { return data.data() + static_cast<std::ptrdiff_t>(i) * width(); }
+
+        /**
+         * \brief Zwraca wskaźnik na element (i, firstCol(i)) bufora wstęgi.
+         *
+         * Dla wierszy, w których wstęga nie przecina macierzy, zwraca
+         * początek wiersza bufora (wskaźnik nie jest wtedy używany).
+         * \param i Numer wiersza.
+         * \return Wskaźnik na pierwszy element wiersza leżący w macierzy.
+         */
+        T* bandAt(int i) { return bandRow(i) + offsetAt(i); }
+
+        /**
+         * \brief Zwraca wskaźnik na element (i, firstCol(i)) bufora wstęgi.
+         * \param i Numer wiersza.
+         * \return Wskaźnik na pierwszy element wiersza leżący w macierzy.
+         */
+        const T* bandAt(int i) const { return bandRow(i) + offsetAt(i); }
+
+        /**
+         * \brief Zwraca pozycję elementu (i, firstCol(i)) w wierszu bufora wstęgi.
+         * \param i Numer wiersza.
+         * \return Pozycja w wierszu (0, gdy wiersz nie przecina macierzy).
+         */
+        int offsetAt(int i) const { return firstCol(i) < endCol(i) ? firstCol(i) - i + lower : 0; }
+
+        /**
+         * \brief Zwraca pierwszą kolumnę wstęgi w wierszu i leżącą w macierzy.
+         * \param i Numer wiersza.
+         * \return Pierwsza kolumna.
+         */
+        int firstCol(int i) const { return i - lower > 0 ? i - lower : 0; }
+
+        /**
+         * \brief Zwraca kolumnę za ostatnią kolumną wstęgi w wierszu i leżącą w macierzy.
+         * \param i Numer wiersza.
+         * \return Kolumna za ostatnią.
+         */
+        int endCol(int i) const { return i + upper + 1 < cols ? i + upper + 1 : cols; }
+
+    public:
+
+        /**
+         * \brief Konstruktor domyślny (macierz 0 x 0).
+         */
+        band_matrix();
+
+        /**
+         * \brief Konstruktor tworzący zerową macierz wstęgową r x c.
+         * \param r Liczba wierszy.
+         * \param c Liczba kolumn.
+         * \param kl Liczba przekątnych pod główną (obcinana do r - 1).
+         * \param ku Liczba przekątnych nad główną (obcinana do c - 1).
+         */
+        band_matrix(int r, int c, int kl, int ku);
+
+        /**
+         * \brief Konstruktor kopiujący wstęgę macierzy gęstej (elementy spoza wstęgi są pomijane).
+         * \param m Macierz gęsta.
+         * \param kl Liczba przekątnych pod główną.
+         * \param ku Liczba przekątnych nad główną.
+         */
+        band_matrix(const basic_matrix<T>& m, int kl, int ku);
+
+        /**
+         * \brief Zwraca liczbę wierszy.
+         * \return Liczba wierszy.
+         */
+        int getRows() const { return rows; }
+
+        /**
+         * \brief Zwraca liczbę kolumn.
+         * \return Liczba kolumn.
+         */
+        int getCols() const { return cols; }
+
+        /**
+         * \brief Zwraca liczbę przekątnych pod główną.
+         * \return lower.
+         */
+        int getLower() const { return lower; }
+
+        /**
+         * \brief Zwraca liczbę przekątnych nad główną.
+         * \return upper.
+         */
+        int getUpper() const { return upper; }
+
+        /**
+         * \brief Wstawia wartość na pozycję (x, y); pozycje spoza wstęgi są pomijane.
+         * \param x Wiersz.
+         * \param y Kolumna.
+         * \param value Wartość do wstawienia.
+         * \return Referencja do obiektu macierzy.
+         */
+        band_matrix& insert(int x, int y, T value);
+
+        /**
+         * \brief Zwraca wartość z macierzy na pozycji (x, y).
+         * \param x Wiersz.
+         * \param y Kolumna.
+         * \return Wartość (0 poza wstęgą i poza macierzą).
+         */
+        T show(int x, int y) const;
+
+        /**
+         * \brief Zamienia macierz na gęstą.
+         * \return Macierz gęsta rows x cols.
+         */
+        basic_matrix<T> toDense() const;
+
+        /**
+         * \brief Zamienia macierz w jednostkową przekątną (wstęga szerokości 1).
+         * \return Referencja do obiektu macierzy.
+         */
+        band_matrix& diagonal();
+
+        /**
+         * \brief Zamienia macierz w przekątną o zadanych wartościach (wstęga szerokości 1).
+         * \param t Tablica min(rows, cols) wartości do ustawienia na przekątnej.
+         * \return Referencja do obiektu macierzy.
+         */
+        band_matrix& diagonal(const T* t);
+
+        /**
+         * \brief Zamienia macierz w k-tą przekątną o zadanych wartościach (wstęga szerokości 1).
+         *
+         * Numeracja wartości jak w basic_matrix::diagonal_k().
+         * \param k Numer przekątnej (dodatni - nad główną, ujemny - pod nią).
+         * \param t Tablica wartości do ustawienia na przekątnej.
+         * \return Referencja do obiektu macierzy.
+         */
+        band_matrix& diagonal_k(int k, const T* t);
+
+        /**
+         * \brief Suma macierzy wstęgowych; wstęga wyniku jest sumą wstęg.
+         * \param m Macierz o tych samych wymiarach.
+         * \return Nowa macierz wstęgowa.
+         * \throw std::invalid_argument Przy niezgodnych wymiarach.
+         */
+        band_matrix add(const band_matrix& m) const;
+
+        /**
+         * \brief Iloczyn macierzy wstęgowych w O(rows * szerokość * szerokość).
+         *
+         * Wynik ma lower = lower + m.lower i upper = upper + m.upper.
+         * \param m Macierz wstęgowa cols x n.
+         * \return Nowa macierz wstęgowa rows x n.
+         * \throw std::invalid_argument Gdy cols różni się od liczby wierszy m.
+         */
+        band_matrix multiply(const band_matrix& m) const;
+
+        /**
+         * \brief Iloczyn z macierzą gęstą w O(rows * szerokość * n).
+         * \param m Macierz gęsta cols x n.
+         * \return Macierz gęsta rows x n.
+         * \throw std::invalid_argument Gdy cols różni się od liczby wierszy m.
+         */
+        basic_matrix<T> multiply(const basic_matrix<T>& m) const;
+
+        /**
+         * \brief Iloczyn z wektorem: y = A * x.
+         * \param x Wektor cols wartości.
+         * \param y Wektor rows wartości na wynik (nie może pokrywać się z x).
+         */
+        void multiply(const T* x, T* y) const;
+};
+
+/**
+ * \brief Tworzy k-tą przekątną r x c od razu w przechowywaniu wstęgowym.
+ * \param r Liczba wierszy.
+ * \param c Liczba kolumn.
+ * \param k Numer przekątnej.
+ * \param t Tablica wartości do ustawienia na przekątnej.
+ * \return Macierz wstęgowa szerokości 1.
+ */
+template <typename T>
+band_matrix<T> basic_matrix<T>::diagonal_k(int r, int c, int k, const T* t) {
+    band_matrix<T> result(r, c, 0, 0);
+    result.diagonal_k(k, t);
+    return result;
+}
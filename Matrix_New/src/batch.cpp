@@ -0,0 +1,376 @@
+﻿#include "batch.h"
+#include "gemm.h"
+#include "simd.h"
+#include "thread_pool.h"
+#include "transpose.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace batch {
+
+    /// Minimalna łączna praca (mnożenia lub elementy), od której partia dzielona jest między wątki.
+    static const std::size_t PARALLEL_WORK = 1 << 16;
+
+    /// Objętość m * n * k, od której pojedynczy iloczyn liczony jest przez gemm::blocked().
+    static const long long BLOCKED_WORK = 48 * 48 * 48;
+
+    /**
+    * \brief Partia macierzy ułożonych co stały krok.
+    */
+    template <typename P>
+    struct strided {
+        P base;              ///< Pierwsza macierz.
+        std::ptrdiff_t step; ///< Krok między macierzami w elementach.
+
+        P operator[](int i) const { return base + static_cast<std::ptrdiff_t>(i) * step; }
+    };
+
+    /**
+    * \brief Partia macierzy wskazywanych przez tablicę wskaźników.
+    */
+    template <typename P>
+    struct indirect {
+        const P* ptrs; ///< Wskaźniki na macierze.
+
+        P operator[](int i) const { return ptrs[i]; }
+    };
+
+    /**
+    * \brief Tworzy opis partii z krokiem.
+    */
+    template <typename P>
+    static strided<P> stridedBatch(P base, std::ptrdiff_t step) {
+        strided<P> s;
+        s.base = base;
+        s.step = step;
+        return s;
+    }
+
+    /**
+    * \brief Tworzy opis partii z tablicą wskaźników.
+    */
+    template <typename P>
+    static indirect<P> indirectBatch(const P* ptrs) {
+        indirect<P> s;
+        s.ptrs = ptrs;
+        return s;
+    }
+
+    /**
+    * \brief Wykonuje task(first, last) dla porcji partii, równolegle przy dostatecznej pracy.
+    * \param count Liczba macierzy.
+    * \param work Praca przypadająca na jedną macierz.
+    * \param task Funkcja porcji [first, last).
+    */
+    template <typename F>
+    static void forBatch(int count, long long work, const F& task) {
+        thread_pool& pool = thread_pool::instance();
+        const int threads = pool.getThreadCount();
+        if (threads == 1 || count < 2 || static_cast<std::size_t>(work * count) < PARALLEL_WORK) {
+            task(0, count);
+            return;
+        }
+        const int chunks = std::min(count, 4 * threads);
+        pool.parallelFor(chunks, [&](int t) {
+            task(static_cast<int>(static_cast<long long>(count) * t / chunks),
+                 static_cast<int>(static_cast<long long>(count) * (t + 1) / chunks));
+        });
+    }
+
+    /**
+    * \brief Iloczyn macierzy o wymiarach znanych w czasie kompilacji; wiersz wyniku akumulowany jest w rejestrach.
+    */
+    template <typename T, int M, int N, int K>
+    static void fixedKernel(int, int, int, const T* a, int lda, const T* b, int ldb, T* c, int ldc) {
+        for (int i = 0; i < M; ++i) {
+            T row[N] = {};
+            const T* ai = a + static_cast<std::ptrdiff_t>(i) * lda;
+            for (int p = 0; p < K; ++p) {
+                const T x = ai[p];
+                const T* bp = b + static_cast<std::ptrdiff_t>(p) * ldb;
+                for (int j = 0; j < N; ++j) {
+                    row[j] = static_cast<T>(row[j] + x * bp[j]);
+                }
+            }
+            T* ci = c + static_cast<std::ptrdiff_t>(i) * ldc;
+            for (int j = 0; j < N; ++j) {
+                ci[j] = row[j];
+            }
+        }
+    }
+
+    /**
+    * \brief Iloczyn małych macierzy o dowolnych wymiarach, kolejność i-k-j.
+    */
+    template <typename T>
+    static void smallKernel(int m, int n, int k, const T* a, int lda, const T* b, int ldb, T* c, int ldc) {
+        for (int i = 0; i < m; ++i) {
+            const T* ai = a + static_cast<std::ptrdiff_t>(i) * lda;
+            T* ci = c + static_cast<std::ptrdiff_t>(i) * ldc;
+            std::fill(ci, ci + n, T(0));
+            for (int p = 0; p < k; ++p) {
+                const T x = ai[p];
+                const T* bp = b + static_cast<std::ptrdiff_t>(p) * ldb;
+                for (int j = 0; j < n; ++j) {
+                    ci[j] = static_cast<T>(ci[j] + x * bp[j]);
+                }
+            }
+        }
+    }
+
+    /**
+    * \brief Jądro pojedynczego iloczynu (sygnatura jak w gemm).
+    */
+    template <typename T>
+    using productKernel = void (*)(int, int, int, const T*, int, const T*, int, T*, int);
+
+    /**
+    * \brief Wybiera jądro iloczynu dla wymiarów partii.
+    * \return Wskaźnik na jądro.
+    */
+    template <typename T>
+    static productKernel<T> chooseKernel(int m, int n, int k) {
+        if (m == n && n == k) {
+            switch (m) {
+            case 2: return &fixedKernel<T, 2, 2, 2>;
+            case 3: return &fixedKernel<T, 3, 3, 3>;
+            case 4: return &fixedKernel<T, 4, 4, 4>;
+            case 8: return &fixedKernel<T, 8, 8, 8>;
+            case 16: return &fixedKernel<T, 16, 16, 16>;
+            default: break;
+            }
+        }
+        if (static_cast<long long>(m) * n * k >= BLOCKED_WORK) {
+            return &gemm::blocked<T, T>;
+        }
+        return &smallKernel<T>;
+    }
+
+    /**
+    * \brief Wspólna implementacja multiply() dla obu wariantów partii.
+    */
+    template <typename T, typename A, typename B, typename C>
+    static void multiplyBatch(int count, int m, int n, int k, A a, int lda, B b, int ldb, C c, int ldc) {
+        const productKernel<T> kernel = chooseKernel<T>(m, n, k);
+        forBatch(count, static_cast<long long>(m) * n * k, [&](int first, int last) {
+            for (int i = first; i < last; ++i) {
+                kernel(m, n, k, a[i], lda, b[i], ldb, c[i], ldc);
+            }
+        });
+    }
+
+    /**
+    * \brief Wspólna implementacja add() dla obu wariantów partii.
+    */
+    template <typename T, typename A, typename B, typename C>
+    static void addBatch(int count, int m, int n, A a, int lda, B b, int ldb, C c, int ldc) {
+        forBatch(count, static_cast<long long>(m) * n, [&](int first, int last) {
+            for (int i = first; i < last; ++i) {
+                const T* ai = a[i];
+                const T* bi = b[i];
+                T* ci = c[i];
+                for (int r = 0; r < m; ++r) {
+                    const T* x = ai + static_cast<std::ptrdiff_t>(r) * lda;
+                    const T* y = bi + static_cast<std::ptrdiff_t>(r) * ldb;
+                    T* z = ci + static_cast<std::ptrdiff_t>(r) * ldc;
+                    for (int j = 0; j < n; ++j) {
+                        z[j] = static_cast<T>(x[j] + y[j]);
+                    }
+                }
+            }
+        });
+    }
+
+    /**
+    * \brief Stosuje jądro simd wiersz po wierszu do każdej macierzy partii (scale(), shift()).
+    */
+    template <typename T, typename A, typename C>
+    static void mapBatch(int count, int m, int n, simd::binaryKernel<T> kernel, T alpha, A a, int lda, C c, int ldc) {
+        forBatch(count, static_cast<long long>(m) * n, [&](int first, int last) {
+            for (int i = first; i < last; ++i) {
+                const T* ai = a[i];
+                T* ci = c[i];
+                for (int r = 0; r < m; ++r) {
+                    kernel(ci + static_cast<std::ptrdiff_t>(r) * ldc, ai + static_cast<std::ptrdiff_t>(r) * lda, n, alpha);
+                }
+            }
+        });
+    }
+
+    /**
+    * \brief Wspólna implementacja transpose() dla obu wariantów partii.
+    */
+    template <typename T, typename A, typename C>
+    static void transposeBatch(int count, int m, int n, A a, int lda, C c, int ldc) {
+        forBatch(count, static_cast<long long>(m) * n, [&](int first, int last) {
+            for (int i = first; i < last; ++i) {
+                transposition::copy(m, n, a[i], lda, c[i], ldc);
+            }
+        });
+    }
+
+    /**
+    * \brief Czy partia z krokiem zajmuje ciągły obszar bez dopełnień.
+    */
+    static bool contiguous(int m, int n, int ld, std::ptrdiff_t stride) {
+        return ld == n && stride == static_cast<std::ptrdiff_t>(m) * n;
+    }
+
+    /**
+    * \brief Wykonuje task(first, last) dla porcji ciągłej partii traktowanej jako jedna tablica.
+    *
+    * Granice porcji nie muszą pokrywać się z granicami macierzy, więc pętle
+    * wektoryzowane są ponad nimi.
+    * \param total Liczba elementów całej partii.
+    * \param task Funkcja porcji elementów [first, last).
+    */
+    template <typename F>
+    static void forFlat(std::size_t total, const F& task) {
+        const std::size_t threads = static_cast<std::size_t>(thread_pool::instance().getThreadCount());
+        const int chunks = static_cast<int>(std::max<std::size_t>(1, std::min(total / PARALLEL_WORK, 4 * threads)));
+        thread_pool::instance().parallelFor(chunks, [&](int t) {
+            task(total * t / chunks, total * (t + 1) / chunks);
+        });
+    }
+
+    /**
+    * \brief C[i] = A[i] * B[i] dla i = 0..count-1 (A m x k, B k x n, C m x n).
+    */
+    template <typename T>
+    void multiply(int count, int m, int n, int k,
+                  const T* a, int lda, std::ptrdiff_t strideA,
+                  const T* b, int ldb, std::ptrdiff_t strideB,
+                  T* c, int ldc, std::ptrdiff_t strideC) {
+        multiplyBatch<T>(count, m, n, k, stridedBatch(a, strideA), lda, stridedBatch(b, strideB), ldb, stridedBatch(c, strideC), ldc);
+    }
+
+    /**
+    * \brief C[i] = A[i] * B[i] dla macierzy wskazywanych przez tablice wskaźników.
+    */
+    template <typename T>
+    void multiply(int count, int m, int n, int k,
+                  const T* const* a, int lda, const T* const* b, int ldb, T* const* c, int ldc) {
+        multiplyBatch<T>(count, m, n, k, indirectBatch(a), lda, indirectBatch(b), ldb, indirectBatch(c), ldc);
+    }
+
+    /**
+    * \brief C[i] = A[i] + B[i] dla macierzy m x n.
+    */
+    template <typename T>
+    void add(int count, int m, int n,
+             const T* a, int lda, std::ptrdiff_t strideA,
+             const T* b, int ldb, std::ptrdiff_t strideB,
+             T* c, int ldc, std::ptrdiff_t strideC) {
+        if (count > 0 && contiguous(m, n, lda, strideA) && contiguous(m, n, ldb, strideB) && contiguous(m, n, ldc, strideC)) {
+            forFlat(static_cast<std::size_t>(count) * m * n, [&](std::size_t first, std::size_t last) {
+                for (std::size_t i = first; i < last; ++i) {
+                    c[i] = static_cast<T>(a[i] + b[i]);
+                }
+            });
+            return;
+        }
+        addBatch<T>(count, m, n, stridedBatch(a, strideA), lda, stridedBatch(b, strideB), ldb, stridedBatch(c, strideC), ldc);
+    }
+
+    /**
+    * \brief C[i] = A[i] + B[i] dla macierzy wskazywanych przez tablice wskaźników.
+    */
+    template <typename T>
+    void add(int count, int m, int n,
+             const T* const* a, int lda, const T* const* b, int ldb, T* const* c, int ldc) {
+        addBatch<T>(count, m, n, indirectBatch(a), lda, indirectBatch(b), ldb, indirectBatch(c), ldc);
+    }
+
+    /**
+    * \brief C[i] = alpha * A[i] dla macierzy m x n.
+    */
+    template <typename T>
+    void scale(int count, int m, int n, T alpha,
+               const T* a, int lda, std::ptrdiff_t strideA,
+               T* c, int ldc, std::ptrdiff_t strideC) {
+        if (count > 0 && contiguous(m, n, lda, strideA) && contiguous(m, n, ldc, strideC)) {
+            const simd::binaryKernel<T> kernel = simd::active<T>().mul;
+            forFlat(static_cast<std::size_t>(count) * m * n, [&](std::size_t first, std::size_t last) {
+                kernel(c + first, a + first, last - first, alpha);
+            });
+            return;
+        }
+        mapBatch<T>(count, m, n, simd::active<T>().mul, alpha, stridedBatch(a, strideA), lda, stridedBatch(c, strideC), ldc);
+    }
+
+    /**
+    * \brief C[i] = alpha * A[i] dla macierzy wskazywanych przez tablice wskaźników.
+    */
+    template <typename T>
+    void scale(int count, int m, int n, T alpha,
+               const T* const* a, int lda, T* const* c, int ldc) {
+        mapBatch<T>(count, m, n, simd::active<T>().mul, alpha, indirectBatch(a), lda, indirectBatch(c), ldc);
+    }
+
+    /**
+    * \brief C[i] = A[i] + beta dla macierzy m x n.
+    */
+    template <typename T>
+    void shift(int count, int m, int n, T beta,
+               const T* a, int lda, std::ptrdiff_t strideA,
+               T* c, int ldc, std::ptrdiff_t strideC) {
+        if (count > 0 && contiguous(m, n, lda, strideA) && contiguous(m, n, ldc, strideC)) {
+            const simd::binaryKernel<T> kernel = simd::active<T>().add;
+            forFlat(static_cast<std::size_t>(count) * m * n, [&](std::size_t first, std::size_t last) {
+                kernel(c + first, a + first, last - first, beta);
+            });
+            return;
+        }
+        mapBatch<T>(count, m, n, simd::active<T>().add, beta, stridedBatch(a, strideA), lda, stridedBatch(c, strideC), ldc);
+    }
+
+    /**
+    * \brief C[i] = A[i] + beta dla macierzy wskazywanych przez tablice wskaźników.
+    */
+    template <typename T>
+    void shift(int count, int m, int n, T beta,
+               const T* const* a, int lda, T* const* c, int ldc) {
+        mapBatch<T>(count, m, n, simd::active<T>().add, beta, indirectBatch(a), lda, indirectBatch(c), ldc);
+    }
+
+    /**
+    * \brief C[i] = A[i]^T dla macierzy m x n.
+    */
+    template <typename T>
+    void transpose(int count, int m, int n,
+                   const T* a, int lda, std::ptrdiff_t strideA,
+                   T* c, int ldc, std::ptrdiff_t strideC) {
+        transposeBatch<T>(count, m, n, stridedBatch(a, strideA), lda, stridedBatch(c, strideC), ldc);
+    }
+
+    /**
+    * \brief C[i] = A[i]^T dla macierzy wskazywanych przez tablice wskaźników.
+    */
+    template <typename T>
+    void transpose(int count, int m, int n,
+                   const T* const* a, int lda, T* const* c, int ldc) {
+        transposeBatch<T>(count, m, n, indirectBatch(a), lda, indirectBatch(c), ldc);
+    }
+
+#define BATCH_INSTANTIATE(T) \
+    template void multiply<T>(int, int, int, int, const T*, int, std::ptrdiff_t, const T*, int, std::ptrdiff_t, T*, int, std::ptrdiff_t); \
+    template void multiply<T>(int, int, int, int, const T* const*, int, const T* const*, int, T* const*, int); \
+    template void add<T>(int, int, int, const T*, int, std::ptrdiff_t, const T*, int, std::ptrdiff_t, T*, int, std::ptrdiff_t); \
+    template void add<T>(int, int, int, const T* const*, int, const T* const*, int, T* const*, int); \
+    template void scale<T>(int, int, int, T, const T*, int, std::ptrdiff_t, T*, int, std::ptrdiff_t); \
+    template void scale<T>(int, int, int, T, const T* const*, int, T* const*, int); \
+    template void shift<T>(int, int, int, T, const T*, int, std::ptrdiff_t, T*, int, std::ptrdiff_t); \
+    template void shift<T>(int, int, int, T, const T* const*, int, T* const*, int); \
+    template void transpose<T>(int, int, int, const T*, int, std::ptrdiff_t, T*, int, std::ptrdiff_t); \
+    template void transpose<T>(int, int, int, const T* const*, int, T* const*, int);
+
+    BATCH_INSTANTIATE(std::int8_t)
+    BATCH_INSTANTIATE(std::int16_t)
+    BATCH_INSTANTIATE(std::int32_t)
+    BATCH_INSTANTIATE(std::int64_t)
+    BATCH_INSTANTIATE(float)
+    BATCH_INSTANTIATE(double)
+
+#undef BATCH_INSTANTIATE
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+﻿#pragma once
+#include <cstddef>
+
+/**
+ * \namespace batch
+ * \brief Operacje na wielu macierzach o tych samych wymiarach w jednym wywołaniu.
+ *
+ * Każda operacja ma dwa warianty. W wariancie z krokiem (strided) macierz
+ * i zaczyna się pod adresem base + i * stride (stride w elementach). W
+ * wariancie z tablicą wskaźników macierz i zaczyna się pod adresem ptr[i].
+ * Parametry ld* to odstępy między początkami kolejnych wierszy, jak
+ * w jądrach gemm. Partia dzielona jest na porcje wykonywane przez
+ * thread_pool::instance(), a każda macierz liczona jest w całości przez
+ * jeden wątek, więc wynik nie zależy od liczby wątków. Konkretyzowane dla
+ * int8_t, int16_t, int32_t, int64_t, float i double.
+ */
+namespace batch {
+
+    /**
+     * \brief C[i] = A[i] * B[i] dla i = 0..count-1 (A m x k, B k x n, C m x n).
+     *
+     * Dla kwadratowych macierzy 2, 3, 4, 8 i 16 używane są jądra o stałych
+     * wymiarach rozwijane przez kompilator, dla pozostałych małych - pętla
+     * i-k-j, a dla dużych - gemm::blocked(). C[i] nie może pokrywać się
+     * z A[i] ani B[i].
+     */
+    template <typename T>
+    void multiply(int count, int m, int n, int k,
+                  const T* a, int lda, std::ptrdiff_t strideA,
+                  const T* b, int ldb, std::ptrdiff_t strideB,
+                  T* c, int ldc, std::ptrdiff_t strideC);
+
+    /**
+     * \brief C[i] = A[i] * B[i] dla macierzy wskazywanych przez tablice wskaźników.
+     */
+    template <typename T>
+    void multiply(int count, int m, int n, int k,
+                  const T* const* a, int lda, const T* const* b, int ldb, T* const* c, int ldc);
+
+    /**
+     * \brief C[i] = A[i] + B[i] dla macierzy m x n (C[i] może być A[i] lub B[i]).
+     *
+     * Gdy wszystkie trzy partie są ciągłe (ld == n, stride == m * n), cała
+     * partia dodawana jest jedną pętlą wektoryzowaną ponad granicami macierzy.
+     */
+    template <typename T>
+    void add(int count, int m, int n,
+             const T* a, int lda, std::ptrdiff_t strideA,
+             const T* b, int ldb, std::ptrdiff_t strideB,
+             T* c, int ldc, std::ptrdiff_t strideC);
+
+    /**
+     * \brief C[i] = A[i] + B[i] dla macierzy wskazywanych przez tablice wskaźników.
+     */
+    template <typename T>
+    void add(int count, int m, int n,
+             const T* const* a, int lda, const T* const* b, int ldb, T* const* c, int ldc);
+
+    /**
+     * \brief C[i] = alpha * A[i] dla macierzy m x n (C[i] może być A[i]).
+     *
+     * Ciągła partia przetwarzana jest jednym wywołaniem jądra simd::kernels::mul.
+     */
+    template <typename T>
+    void scale(int count, int m, int n, T alpha,
+               const T* a, int lda, std::ptrdiff_t strideA,
+               T* c, int ldc, std::ptrdiff_t strideC);
+
+    /**
+     * \brief C[i] = alpha * A[i] dla macierzy wskazywanych przez tablice wskaźników.
+     */
+    template <typename T>
+    void scale(int count, int m, int n, T alpha,
+               const T* const* a, int lda, T* const* c, int ldc);
+
+    /**
+     * \brief C[i] = A[i] + beta (do każdego elementu) dla macierzy m x n (C[i] może być A[i]).
+     *
+     * Ciągła partia przetwarzana jest jednym wywołaniem jądra simd::kernels::add.
+     */
+    template <typename T>
+    void shift(int count, int m, int n, T beta,
+               const T* a, int lda, std::ptrdiff_t strideA,
+               T* c, int ldc, std::ptrdiff_t strideC);
+
+    /**
+     * \brief C[i] = A[i] + beta dla macierzy wskazywanych przez tablice wskaźników.
+     */
+    template <typename T>
+    void shift(int count, int m, int n, T beta,
+               const T* const* a, int lda, T* const* c, int ldc);
+
+    /**
+     * \brief C[i] = A[i]^T dla macierzy m x n (C[i] ma wymiary n x m i nie może pokrywać się z A[i]).
+     */
+    template <typename T>
+    void transpose(int count, int m, int n,
+                   const T* a, int lda, std::ptrdiff_t strideA,
+                   T* c, int ldc, std::ptrdiff_t strideC);
+
+    /**
+     * \brief C[i] = A[i]^T dla macierzy wskazywanych przez tablice wskaźników.
+     */
+    template <typename T>
+    void transpose(int count, int m, int n,
+                   const T* const* a, int lda, T* const* c, int ldc);
+}
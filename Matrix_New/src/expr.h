@@ -0,0 +1,464 @@
+﻿#pragma once
+#include "matrix.h"
+#include "simd.h"
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * \brief Bazowy typ wyrażeń macierzowych (CRTP).
+ *
+ * Wyrażenie nie przechowuje wyniku. Wartości wyliczane są fragmentami
+ * wierszy dopiero przy przypisaniu do macierzy, jednym przejściem po pamięci.
+ * Węzeł E udostępnia:
+ * - value_type - typ elementów wyniku,
+ * - int getRows() const, int getCols() const - wymiary wyniku,
+ * - const value_type* source(int i, int j, int n, value_type* out) const - n kolejnych
+ *   wartości wiersza i od kolumny j; zwraca wskaźnik na nie (bufor out
+ *   albo bezpośrednio dane macierzy źródłowej).
+ *
+ * Wyrażenia przechowują wskaźniki na macierze źródłowe, więc nie mogą ich
+ * przeżyć (np. w zmiennej auto).
+ */
+template <typename E>
+struct matrix_expr {
+    /**
+     * \brief Zwraca węzeł jako typ pochodny.
+     * \return Referencja do węzła.
+     */
+    const E& self() const { return static_cast<const E&>(*this); }
+};
+
+/**
+ * \class matrix_ref
+ * \brief Liść wyrażenia: odwołanie do istniejącej macierzy.
+ */
+template <typename T>
+class matrix_ref : public matrix_expr<matrix_ref<T>> {
+    private:
+        const T* data; ///< Bufor macierzy.
+        int stride; ///< Odstęp między wierszami.
+        int rows; ///< Liczba wierszy.
+        int cols; ///< Liczba kolumn.
+
+    public:
+        typedef T value_type; ///< Typ elementu.
+
+        /**
+         * \brief Konstruktor.
+         * \param m Macierz źródłowa.
+         */
+        explicit matrix_ref(const basic_matrix<T>& m) : data(m.data), stride(m.stride), rows(m.rows), cols(m.cols) {}
+
+        /**
+         * \brief Zwraca liczbę wierszy.
+         * \return Liczba wierszy.
+         */
+        int getRows() const { return rows; }
+
+        /**
+         * \brief Zwraca liczbę kolumn.
+         * \return Liczba kolumn.
+         */
+        int getCols() const { return cols; }
+
+        /**
+         * \brief Zwraca wskaźnik na fragment wiersza i od kolumny j (bez kopiowania).
+         */
+        const T* source(int i, int j, int, T*) const {
+            return data + static_cast<std::ptrdiff_t>(i) * stride + j;
+        }
+};
+
+/**
+ * \class scalar_expr
+ * \brief Węzeł wyrażenia: działanie element po elemencie z liczbą (jądro simd).
+ */
+template <typename E>
+class scalar_expr : public matrix_expr<scalar_expr<E>> {
+    public:
+        typedef typename E::value_type value_type; ///< Typ elementu.
+
+    private:
+        E operand; ///< Podwyrażenie.
+        simd::binaryKernel<value_type> kernel; ///< Jądro działania.
+        value_type value; ///< Argument skalarny.
+
+    public:
+        /**
+         * \brief Konstruktor.
+         * \param e Podwyrażenie.
+         * \param k Jądro działania.
+         * \param a Argument skalarny.
+         */
+        scalar_expr(const E& e, simd::binaryKernel<value_type> k, value_type a) : operand(e), kernel(k), value(a) {}
+
+        /**
+         * \brief Zwraca liczbę wierszy wyniku.
+         * \return Liczba wierszy.
+         */
+        int getRows() const { return operand.getRows(); }
+
+        /**
+         * \brief Zwraca liczbę kolumn wyniku.
+         * \return Liczba kolumn.
+         */
+        int getCols() const { return operand.getCols(); }
+
+        /**
+         * \brief Wylicza n wartości wiersza i od kolumny j do out.
+         */
+        const value_type* source(int i, int j, int n, value_type* out) const {
+            kernel(out, operand.source(i, j, n, out), n, value);
+            return out;
+        }
+};
+
+/**
+ * \class sum_expr
+ * \brief Węzeł wyrażenia: suma (lub różnica) element po elemencie dwóch wyrażeń.
+ */
+template <typename L, typename R, bool Subtract>
+class sum_expr : public matrix_expr<sum_expr<L, R, Subtract>> {
+    public:
+        typedef typename L::value_type value_type; ///< Typ elementu.
+
+    private:
+        L left; ///< Lewe podwyrażenie.
+        R right; ///< Prawe podwyrażenie.
+
+    public:
+        /**
+         * \brief Konstruktor.
+         * \param l Lewe podwyrażenie.
+         * \param r Prawe podwyrażenie.
+         */
+        sum_expr(const L& l, const R& r) : left(l), right(r) {
+            static_assert(std::is_same<value_type, typename R::value_type>::value, "matrix expression: element type mismatch");
+            if (l.getRows() != r.getRows() || l.getCols() != r.getCols()) {
+                throw std::invalid_argument("matrix expression: shape mismatch");
+            }
+        }
+
+        /**
+         * \brief Zwraca liczbę wierszy wyniku.
+         * \return Liczba wierszy.
+         */
+        int getRows() const { return left.getRows(); }
+
+        /**
+         * \brief Zwraca liczbę kolumn wyniku.
+         * \return Liczba kolumn.
+         */
+        int getCols() const { return left.getCols(); }
+
+        /**
+         * \brief Wylicza n wartości wiersza i od kolumny j do out.
+         *
+         * Prawe podwyrażenie liczone jest jako pierwsze do bufora pomocniczego
+         * (a jeśli wskazuje wprost na dane pokrywające się z out - kopiowane
+         * do niego), dzięki czemu przypisanie typu m = f(m) + m nie czyta
+         * wartości nadpisanych już w out.
+         */
+        const value_type* source(int i, int j, int n, value_type* out) const {
+            value_type scratch[basic_matrix<value_type>::EXPR_BLOCK];
+            const value_type* r = right.source(i, j, n, scratch);
+            std::less<const value_type*> before;
+            if (r != scratch && before(r, out + n) && before(out, r + n)) {
+                std::memcpy(scratch, r, n * sizeof(value_type));
+                r = scratch;
+            }
+            const value_type* l = left.source(i, j, n, out);
+            if (Subtract) {
+                for (int q = 0; q < n; ++q) out[q] = l[q] - r[q];
+            } else {
+                for (int q = 0; q < n; ++q) out[q] = l[q] + r[q];
+            }
+            return out;
+        }
+};
+
+/**
+* \brief Konstruktor wyliczający wyrażenie.
+* \param e Wyrażenie.
+*/
+template <typename T>
+template <typename E>
+basic_matrix<T>::basic_matrix(const matrix_expr<E>& e) : data(nullptr), rows(0), cols(0), stride(0), alloc(&currentAllocator()) {
+    allocate(e.self().getRows(), e.self().getCols());
+    evaluate(e.self());
+}
+
+/**
+* \brief Przypisanie wyrażenia; przy zgodnych wymiarach wynik zapisywany jest w miejscu.
+* \param e Wyrażenie.
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+template <typename E>
+basic_matrix<T>& basic_matrix<T>::operator=(const matrix_expr<E>& e) {
+    if (data == nullptr || rows != e.self().getRows() || cols != e.self().getCols()) {
+        basic_matrix result(e.self().getRows(), e.self().getCols(), *alloc);
+        result.evaluate(e.self());
+        swap(result);
+    } else {
+        evaluate(e.self());
+    }
+    return *this;
+}
+
+/**
+* \brief Wylicza wyrażenie do bufora macierzy fragmentami wierszy.
+* \param e Węzeł wyrażenia o wymiarach równych wymiarom macierzy.
+*/
+template <typename T>
+template <typename E>
+void basic_matrix<T>::evaluate(const E& e) {
+    static_assert(std::is_same<T, typename E::value_type>::value, "matrix expression: element type mismatch");
+    for (int i = 0; i < rows; ++i) {
+        T* r = rowPtr(i);
+        for (int j = 0; j < cols; j += EXPR_BLOCK) {
+            const int n = cols - j < EXPR_BLOCK ? cols - j : EXPR_BLOCK;
+            const T* s = e.source(i, j, n, r + j);
+            if (s != r + j) {
+                std::memmove(r + j, s, n * sizeof(T));
+            }
+        }
+    }
+}
+
+/**
+* \brief Dodaje macierz element po elemencie (w miejscu).
+* \param m Macierz o tych samych wymiarach.
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::operator+=(const basic_matrix& m) {
+    return operator+=(matrix_ref<T>(m));
+}
+
+/**
+* \brief Odejmuje macierz element po elemencie (w miejscu).
+* \param m Macierz o tych samych wymiarach.
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::operator-=(const basic_matrix& m) {
+    return operator-=(matrix_ref<T>(m));
+}
+
+/**
+* \brief Dodaje wyrażenie jednym przejściem, bez macierzy pośrednich.
+* \param e Wyrażenie o wymiarach macierzy.
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+template <typename E>
+basic_matrix<T>& basic_matrix<T>::operator+=(const matrix_expr<E>& e) {
+    evaluate(sum_expr<matrix_ref<T>, E, false>(matrix_ref<T>(*this), e.self()));
+    return *this;
+}
+
+/**
+* \brief Odejmuje wyrażenie jednym przejściem, bez macierzy pośrednich.
+* \param e Wyrażenie o wymiarach macierzy.
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+template <typename E>
+basic_matrix<T>& basic_matrix<T>::operator-=(const matrix_expr<E>& e) {
+    evaluate(sum_expr<matrix_ref<T>, E, true>(matrix_ref<T>(*this), e.self()));
+    return *this;
+}
+
+/**
+* \brief Operator dodawania liczby do macierzy (przyjaciel).
+* \param a Liczba do dodania.
+* \param m Macierz.
+* \return Wyrażenie, wyliczane przy przypisaniu.
+*/
+template <typename T>
+scalar_expr<matrix_ref<T>> operator+(typename basic_matrix<T>::value_type a, const basic_matrix<T>& m) {
+    return scalar_expr<matrix_ref<T>>(matrix_ref<T>(m), simd::active<T>().add, a);
+}
+
+/**
+* \brief Operator mnożenia liczby przez macierz (przyjaciel).
+* \param a Liczba do pomnożenia.
+* \param m Macierz.
+* \return Wyrażenie, wyliczane przy przypisaniu.
+*/
+template <typename T>
+scalar_expr<matrix_ref<T>> operator*(typename basic_matrix<T>::value_type a, const basic_matrix<T>& m) {
+    return scalar_expr<matrix_ref<T>>(matrix_ref<T>(m), simd::active<T>().mul, a);
+}
+
+/**
+* \brief Operator odejmowania macierzy od liczby (przyjaciel).
+* \param a Liczba.
+* \param m Macierz do odjęcia.
+* \return Wyrażenie, wyliczane przy przypisaniu.
+*/
+template <typename T>
+scalar_expr<matrix_ref<T>> operator-(typename basic_matrix<T>::value_type a, const basic_matrix<T>& m) {
+    return scalar_expr<matrix_ref<T>>(matrix_ref<T>(m), simd::active<T>().rsub, a);
+}
+
+/**
+* \brief Operator dodawania liczby do wyrażenia.
+* \param e Wyrażenie.
+* \param a Liczba do dodania.
+* \return Wyrażenie, wyliczane przy przypisaniu.
+*/
+template <typename E>
+scalar_expr<E> operator+(const matrix_expr<E>& e, typename E::value_type a) {
+    return scalar_expr<E>(e.self(), simd::active<typename E::value_type>().add, a);
+}
+
+/**
+* \brief Operator dodawania wyrażenia do liczby.
+* \param a Liczba do dodania.
+* \param e Wyrażenie.
+* \return Wyrażenie, wyliczane przy przypisaniu.
+*/
+template <typename E>
+scalar_expr<E> operator+(typename E::value_type a, const matrix_expr<E>& e) {
+    return scalar_expr<E>(e.self(), simd::active<typename E::value_type>().add, a);
+}
+
+/**
+* \brief Operator odejmowania liczby od wyrażenia.
+* \param e Wyrażenie.
+* \param a Liczba do odjęcia.
+* \return Wyrażenie, wyliczane przy przypisaniu.
+*/
+template <typename E>
+scalar_expr<E> operator-(const matrix_expr<E>& e, typename E::value_type a) {
+    return scalar_expr<E>(e.self(), simd::active<typename E::value_type>().sub, a);
+}
+
+/**
+* \brief Operator odejmowania wyrażenia od liczby.
+* \param a Liczba.
+* \param e Wyrażenie do odjęcia.
+* \return Wyrażenie, wyliczane przy przypisaniu.
+*/
+template <typename E>
+scalar_expr<E> operator-(typename E::value_type a, const matrix_expr<E>& e) {
+    return scalar_expr<E>(e.self(), simd::active<typename E::value_type>().rsub, a);
+}
+
+/**
+* \brief Operator mnożenia wyrażenia przez liczbę.
+* \param e Wyrażenie.
+* \param a Liczba do pomnożenia.
+* \return Wyrażenie, wyliczane przy przypisaniu.
+*/
+template <typename E>
+scalar_expr<E> operator*(const matrix_expr<E>& e, typename E::value_type a) {
+    return scalar_expr<E>(e.self(), simd::active<typename E::value_type>().mul, a);
+}
+
+/**
+* \brief Operator mnożenia liczby przez wyrażenie.
+* \param a Liczba do pomnożenia.
+* \param e Wyrażenie.
+* \return Wyrażenie, wyliczane przy przypisaniu.
+*/
+template <typename E>
+scalar_expr<E> operator*(typename E::value_type a, const matrix_expr<E>& e) {
+    return scalar_expr<E>(e.self(), simd::active<typename E::value_type>().mul, a);
+}
+
+/**
+* \brief Operator dodawania wyrażeń element po elemencie.
+* \param l Lewe wyrażenie.
+* \param r Prawe wyrażenie.
+* \return Wyrażenie, wyliczane przy przypisaniu.
+*/
+template <typename L, typename R>
+sum_expr<L, R, false> operator+(const matrix_expr<L>& l, const matrix_expr<R>& r) {
+    return sum_expr<L, R, false>(l.self(), r.self());
+}
+
+/**
+* \brief Operator odejmowania wyrażeń element po elemencie.
+* \param l Lewe wyrażenie.
+* \param r Prawe wyrażenie.
+* \return Wyrażenie, wyliczane przy przypisaniu.
+*/
+template <typename L, typename R>
+sum_expr<L, R, true> operator-(const matrix_expr<L>& l, const matrix_expr<R>& r) {
+    return sum_expr<L, R, true>(l.self(), r.self());
+}
+
+/**
+* \brief Operator dodawania macierzy do wyrażenia.
+* \param e Wyrażenie.
+* \param m Macierz.
+* \return Wyrażenie, wyliczane przy przypisaniu.
+*/
+template <typename E, typename T>
+sum_expr<E, matrix_ref<T>, false> operator+(const matrix_expr<E>& e, const basic_matrix<T>& m) {
+    return sum_expr<E, matrix_ref<T>, false>(e.self(), matrix_ref<T>(m));
+}
+
+/**
+* \brief Operator dodawania wyrażenia do macierzy (bez modyfikacji m).
+* \param m Macierz.
+* \param e Wyrażenie.
+* \return Wyrażenie, wyliczane przy przypisaniu.
+*/
+template <typename T, typename E>
+sum_expr<matrix_ref<T>, E, false> operator+(const basic_matrix<T>& m, const matrix_expr<E>& e) {
+    return sum_expr<matrix_ref<T>, E, false>(matrix_ref<T>(m), e.self());
+}
+
+/**
+* \brief Operator dodawania wyrażenia do niestałej macierzy (bez modyfikacji m).
+*
+* Dokładne dopasowanie dla niestałego m: bez niego składowy operator+
+* (const basic_matrix&) z konwersją wyrażenia na macierz byłby równie dobry.
+* \param m Macierz.
+* \param e Wyrażenie.
+* \return Wyrażenie, wyliczane przy przypisaniu.
+*/
+template <typename T, typename E>
+sum_expr<matrix_ref<T>, E, false> operator+(basic_matrix<T>& m, const matrix_expr<E>& e) {
+    return sum_expr<matrix_ref<T>, E, false>(matrix_ref<T>(m), e.self());
+}
+
+/**
+* \brief Operator odejmowania macierzy od wyrażenia.
+* \param e Wyrażenie.
+* \param m Macierz do odjęcia.
+* \return Wyrażenie, wyliczane przy przypisaniu.
+*/
+template <typename E, typename T>
+sum_expr<E, matrix_ref<T>, true> operator-(const matrix_expr<E>& e, const basic_matrix<T>& m) {
+    return sum_expr<E, matrix_ref<T>, true>(e.self(), matrix_ref<T>(m));
+}
+
+/**
+* \brief Operator odejmowania wyrażenia od macierzy (bez modyfikacji m).
+* \param m Macierz.
+* \param e Wyrażenie do odjęcia.
+* \return Wyrażenie, wyliczane przy przypisaniu.
+*/
+template <typename T, typename E>
+sum_expr<matrix_ref<T>, E, true> operator-(const basic_matrix<T>& m, const matrix_expr<E>& e) {
+    return sum_expr<matrix_ref<T>, E, true>(matrix_ref<T>(m), e.self());
+}
+
+/**
+* \brief Operator strumieniowy do wyświetlania wyrażenia.
+* \param o Strumień wyjściowy.
+* \param e Wyrażenie do wyliczenia i wyświetlenia.
+* \return Strumień wyjściowy.
+*/
+template <typename E>
+std::ostream& operator<<(std::ostream& o, const matrix_expr<E>& e) {
+    return o << basic_matrix<typename E::value_type>(e);
+}
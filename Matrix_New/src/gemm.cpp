@@ -0,0 +1,523 @@
+﻿#include "gemm.h"
+#include "memory.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace gemm {
+
+    static std::atomic<int> currentAlgorithm(static_cast<int>(algorithm::blocked));
+    static std::atomic<int> blockMC(96);
+    static std::atomic<int> blockKC(256);
+    static std::atomic<int> blockNC(4096);
+    static std::atomic<int> strassenCrossover(256);
+
+    /**
+    * \brief Ustawia algorytm używany przez multiply().
+    * \param a Algorytm.
+    */
+    void setAlgorithm(algorithm a) {
+        currentAlgorithm = static_cast<int>(a);
+    }
+
+    /**
+    * \brief Zwraca algorytm używany przez multiply().
+    * \return Aktualny algorytm.
+    */
+    algorithm getAlgorithm() {
+        return static_cast<algorithm>(currentAlgorithm.load());
+    }
+
+    /**
+    * \brief Ustawia rozmiary bloków algorytmu blokowego.
+    * \param b Rozmiary bloków (mc zaokrąglane do MR, nc do NR).
+    */
+    void setBlocking(blocking b) {
+        blockMC = std::max(MR, (b.mc + MR - 1) / MR * MR);
+        blockKC = std::max(1, b.kc);
+        blockNC = std::max(NR, (b.nc + NR - 1) / NR * NR);
+    }
+
+    /**
+    * \brief Zwraca rozmiary bloków algorytmu blokowego.
+    * \return Rozmiary bloków.
+    */
+    blocking getBlocking() {
+        blocking b;
+        b.mc = blockMC;
+        b.kc = blockKC;
+        b.nc = blockNC;
+        return b;
+    }
+
+    /**
+    * \brief Ustawia próg przejścia algorytmu strassen na mnożenie blokowe.
+    * \param n Próg (co najmniej 16).
+    */
+    void setStrassenCrossover(int n) {
+        strassenCrossover = std::max(16, n);
+    }
+
+    /**
+    * \brief Zwraca próg przejścia algorytmu strassen na mnożenie blokowe.
+    * \return Próg.
+    */
+    int getStrassenCrossover() {
+        return strassenCrossover;
+    }
+
+    /**
+    * \brief Referencyjne mnożenie potrójną pętlą.
+    */
+    template <typename T, typename Acc>
+    void naive(int m, int n, int k, const T* a, int lda, const T* b, int ldb, Acc* c, int ldc) {
+        for (int i = 0; i < m; ++i) {
+            for (int j = 0; j < n; ++j) {
+                Acc sum = 0;
+                for (int p = 0; p < k; ++p) {
+                    sum += static_cast<Acc>(a[static_cast<std::ptrdiff_t>(i) * lda + p]) * static_cast<Acc>(b[static_cast<std::ptrdiff_t>(p) * ldb + j]);
+                }
+                c[static_cast<std::ptrdiff_t>(i) * ldc + j] = sum;
+            }
+        }
+    }
+
+    /**
+    * \brief Pakuje blok A (mc x kc) w mikropanele po MR wierszy.
+    *
+    * Każdy mikropanel zapisany jest kolumnami: dla kolejnych p leży MR
+    * wartości z kolejnych wierszy. Brakujące wiersze są dopełniane zerami.
+    */
+    template <typename T>
+    static void packA(int mc, int kc, const T* a, int lda, T* buffer) {
+        for (int i = 0; i < mc; i += MR) {
+            const int rows = std::min(MR, mc - i);
+            for (int p = 0; p < kc; ++p) {
+                for (int r = 0; r < rows; ++r) {
+                    buffer[r] = a[static_cast<std::ptrdiff_t>(i + r) * lda + p];
+                }
+                for (int r = rows; r < MR; ++r) {
+                    buffer[r] = 0;
+                }
+                buffer += MR;
+            }
+        }
+    }
+
+    /**
+    * \brief Pakuje panel B (kc x nc) w mikropanele po NR kolumn.
+    *
+    * Dla kolejnych p w mikropanelu leży NR sąsiednich wartości wiersza p.
+    * Brakujące kolumny są dopełniane zerami.
+    */
+    template <typename T>
+    static void packB(int kc, int nc, const T* b, int ldb, T* buffer) {
+        for (int j = 0; j < nc; j += NR) {
+            const int cols = std::min(NR, nc - j);
+            for (int p = 0; p < kc; ++p) {
+                const T* src = b + static_cast<std::ptrdiff_t>(p) * ldb + j;
+                for (int q = 0; q < cols; ++q) {
+                    buffer[q] = src[q];
+                }
+                for (int q = cols; q < NR; ++q) {
+                    buffer[q] = 0;
+                }
+                buffer += NR;
+            }
+        }
+    }
+
+    /**
+    * \brief Mikrojądro: dodaje do C (mr x nr) iloczyn mikropaneli A i B.
+    *
+    * Akumulator MR x NR typu Acc trzymany jest w rejestrach; pętla po j ma
+    * stałą długość NR, więc kompilator wektoryzuje ją w całości (z
+    * poszerzeniem elementów T do Acc przy mieszanej precyzji).
+    */
+    template <typename T, typename Acc>
+    static void microKernel(int kc, const T* a, const T* b, Acc* c, int ldc, int mr, int nr) {
+        Acc acc[MR][NR] = {};
+        for (int p = 0; p < kc; ++p) {
+            for (int i = 0; i < MR; ++i) {
+                const Acc ai = a[i];
+                for (int j = 0; j < NR; ++j) {
+                    acc[i][j] += ai * static_cast<Acc>(b[j]);
+                }
+            }
+            a += MR;
+            b += NR;
+        }
+        if (mr == MR && nr == NR) {
+            for (int i = 0; i < MR; ++i) {
+                Acc* ci = c + static_cast<std::ptrdiff_t>(i) * ldc;
+                for (int j = 0; j < NR; ++j) {
+                    ci[j] += acc[i][j];
+                }
+            }
+        } else {
+            for (int i = 0; i < mr; ++i) {
+                Acc* ci = c + static_cast<std::ptrdiff_t>(i) * ldc;
+                for (int j = 0; j < nr; ++j) {
+                    ci[j] += acc[i][j];
+                }
+            }
+        }
+    }
+
+    /**
+    * \brief Mnożenie blokowe z pakowaniem paneli A i B.
+    *
+    * Pętle (od zewnętrznej): jc po panelach B w L3, pc po głębokości,
+    * ic po blokach A w L2, a wewnątrz jr/ir po mikropanelach.
+    */
+    template <typename T, typename Acc>
+    void blocked(int m, int n, int k, const T* a, int lda, const T* b, int ldb, Acc* c, int ldc) {
+        for (int i = 0; i < m; ++i) {
+            std::fill(c + static_cast<std::ptrdiff_t>(i) * ldc, c + static_cast<std::ptrdiff_t>(i) * ldc + n, Acc(0));
+        }
+        if (m == 0 || n == 0 || k == 0) {
+            return;
+        }
+
+        const blocking bs = getBlocking();
+        const int mcMax = std::min(bs.mc, (m + MR - 1) / MR * MR);
+        const int kcMax = std::min(bs.kc, k);
+        const int ncMax = std::min(bs.nc, (n + NR - 1) / NR * NR);
+
+        pool_allocator& pool = pool_allocator::instance();
+        const std::size_t bytesA = sizeof(T) * mcMax * kcMax;
+        const std::size_t bytesB = sizeof(T) * kcMax * ncMax;
+        T* packedA = static_cast<T*>(pool.allocate(bytesA, 64));
+        T* packedB = static_cast<T*>(pool.allocate(bytesB, 64));
+
+        for (int jc = 0; jc < n; jc += ncMax) {
+            const int nc = std::min(ncMax, n - jc);
+            for (int pc = 0; pc < k; pc += kcMax) {
+                const int kc = std::min(kcMax, k - pc);
+                packB(kc, nc, b + static_cast<std::ptrdiff_t>(pc) * ldb + jc, ldb, packedB);
+                for (int ic = 0; ic < m; ic += mcMax) {
+                    const int mc = std::min(mcMax, m - ic);
+                    packA(mc, kc, a + static_cast<std::ptrdiff_t>(ic) * lda + pc, lda, packedA);
+                    for (int jr = 0; jr < nc; jr += NR) {
+                        const int nr = std::min(NR, nc - jr);
+                        const T* bp = packedB + jr * kc;
+                        for (int ir = 0; ir < mc; ir += MR) {
+                            const int mr = std::min(MR, mc - ir);
+                            microKernel(kc, packedA + ir * kc, bp, c + static_cast<std::ptrdiff_t>(ic + ir) * ldc + jc + jr, ldc, mr, nr);
+                        }
+                    }
+                }
+            }
+        }
+
+        pool.deallocate(packedA, bytesA, 64);
+        pool.deallocate(packedB, bytesB, 64);
+    }
+
+    /**
+    * \brief Mnoży jeden kafelek (lub całość) algorytmem wybranym przez setAlgorithm().
+    */
+    template <typename T, typename Acc>
+    static void serial(int m, int n, int k, const T* a, int lda, const T* b, int ldb, Acc* c, int ldc) {
+        switch (getAlgorithm()) {
+        case algorithm::naive:
+            naive(m, n, k, a, lda, b, ldb, c, ldc);
+            break;
+        case algorithm::blocked:
+        case algorithm::strassen:
+        default:
+            blocked(m, n, k, a, lda, b, ldb, c, ldc);
+            break;
+        }
+    }
+
+    /**
+    * \brief Mnożenie równoległe: C dzielona jest na kafelki 2D wykonywane przez thread_pool::instance().
+    *
+    * Kafelki startują od 256 x 512 i są dzielone, dopóki nie ma ich co
+    * najmniej cztery na wątek (nie mniej niż 32 x 64), żeby kradzież zadań
+    * miała co wyrównywać.
+    */
+    template <typename T, typename Acc>
+    void parallel(int m, int n, int k, const T* a, int lda, const T* b, int ldb, Acc* c, int ldc) {
+        thread_pool& pool = thread_pool::instance();
+        const int threads = pool.getThreadCount();
+        int tm = 256;
+        int tn = 512;
+        for (;;) {
+            const long long tiles = static_cast<long long>((m + tm - 1) / tm) * ((n + tn - 1) / tn);
+            if (tiles >= 4LL * threads) break;
+            if (tn > 2 * tm && tn > 64) tn /= 2;
+            else if (tm > 32) tm /= 2;
+            else if (tn > 64) tn /= 2;
+            else break;
+        }
+        const int tilesM = (m + tm - 1) / tm;
+        const int tilesN = (n + tn - 1) / tn;
+        pool.parallelFor(tilesM * tilesN, [=](int t) {
+            const int i0 = (t / tilesN) * tm;
+            const int j0 = (t % tilesN) * tn;
+            serial(std::min(tm, m - i0), std::min(tn, n - j0), k,
+                   a + static_cast<std::ptrdiff_t>(i0) * lda, lda,
+                   b + j0, ldb,
+                   c + static_cast<std::ptrdiff_t>(i0) * ldc + j0, ldc);
+        });
+    }
+
+    /**
+    * \brief Typ, w którym wykonywane są dodawania Strassena: dla typów całkowitych bez znaku
+    * i co najmniej tak szeroki jak int (żeby nie zachodziła promocja do int ze znakiem).
+    *
+    * Arytmetyka bez znaku zawija się modulo 2^bitów bez niezdefiniowanego
+    * zachowania, a wynik rzutowany z powrotem na T jest ten sam co przy
+    * bezpośrednim mnożeniu.
+    */
+    template <typename T>
+    using wrapping = typename std::conditional<std::is_integral<T>::value,
+                                               std::make_unsigned<decltype(T() + T())>,
+                                               std::common_type<T>>::type::type;
+
+    /**
+    * \brief z = x + y lub z = x - y dla bloków rows x cols (z może być x lub y).
+    */
+    template <typename T>
+    static void combine(int rows, int cols, const T* x, int ldx, const T* y, int ldy, T* z, int ldz, bool subtract) {
+        typedef wrapping<T> U;
+        for (int i = 0; i < rows; ++i) {
+            const T* xi = x + static_cast<std::ptrdiff_t>(i) * ldx;
+            const T* yi = y + static_cast<std::ptrdiff_t>(i) * ldy;
+            T* zi = z + static_cast<std::ptrdiff_t>(i) * ldz;
+            if (subtract) {
+                for (int j = 0; j < cols; ++j) {
+                    zi[j] = static_cast<T>(static_cast<U>(xi[j]) - static_cast<U>(yi[j]));
+                }
+            } else {
+                for (int j = 0; j < cols; ++j) {
+                    zi[j] = static_cast<T>(static_cast<U>(xi[j]) + static_cast<U>(yi[j]));
+                }
+            }
+        }
+    }
+
+    /**
+    * \brief Klasyczne mnożenie liścia rekurencji: równolegle kafelkami dla dużych liści, inaczej blokowo.
+    */
+    template <typename T>
+    static void classical(int m, int n, int k, const T* a, int lda, const T* b, int ldb, T* c, int ldc) {
+        const double work = static_cast<double>(m) * n * k;
+        if (work >= 128.0 * 128.0 * 128.0 && thread_pool::instance().getThreadCount() > 1) {
+            parallel(m, n, k, a, lda, b, ldb, c, ldc);
+        } else {
+            blocked(m, n, k, a, lda, b, ldb, c, ldc);
+        }
+    }
+
+    /**
+    * \brief Czy problem jest dość duży, by zejść o poziom rekurencji Strassena.
+    */
+    static bool recurse(int m, int n, int k, int crossover) {
+        return std::min(m, std::min(n, k)) > crossover;
+    }
+
+    /**
+    * \brief Przestrzeń robocza rekurencji od danego poziomu w dół.
+    */
+    static std::size_t workspaceSize(int m, int n, int k, int crossover) {
+        std::size_t total = 0;
+        while (recurse(m, n, k, crossover)) {
+            m /= 2;
+            n /= 2;
+            k /= 2;
+            total += static_cast<std::size_t>(m) * std::max(k, n) + static_cast<std::size_t>(k) * n;
+        }
+        return total;
+    }
+
+    template <typename T>
+    std::size_t strassenWorkspace(int m, int n, int k) {
+        return workspaceSize(m, n, k, getStrassenCrossover());
+    }
+
+    /**
+    * \brief Jeden poziom rekurencji Strassena-Winograda: C = A * B (C nadpisywana).
+    *
+    * Harmonogram Douglasa i in.: X (m/2 x max(k/2, n/2)) i Y (k/2 x n/2)
+    * przechowują kombinacje ćwiartek A i B, a ćwiartki C służą za bufory
+    * iloczynów P1..P7. Reszta przestrzeni roboczej przechodzi na niższe
+    * poziomy.
+    */
+    template <typename T>
+    static void winograd(int m, int n, int k, const T* a, int lda, const T* b, int ldb, T* c, int ldc, T* ws, int crossover) {
+        if (!recurse(m, n, k, crossover)) {
+            classical(m, n, k, a, lda, b, ldb, c, ldc);
+            return;
+        }
+        const int m2 = m / 2;
+        const int n2 = n / 2;
+        const int k2 = k / 2;
+        const T* a11 = a;
+        const T* a12 = a + k2;
+        const T* a21 = a + static_cast<std::ptrdiff_t>(m2) * lda;
+        const T* a22 = a21 + k2;
+        const T* b11 = b;
+        const T* b12 = b + n2;
+        const T* b21 = b + static_cast<std::ptrdiff_t>(k2) * ldb;
+        const T* b22 = b21 + n2;
+        T* c11 = c;
+        T* c12 = c + n2;
+        T* c21 = c + static_cast<std::ptrdiff_t>(m2) * ldc;
+        T* c22 = c21 + n2;
+        const int ldx = std::max(k2, n2);
+        const int ldy = n2;
+        T* x = ws;
+        T* y = x + static_cast<std::ptrdiff_t>(m2) * ldx;
+        T* next = y + static_cast<std::ptrdiff_t>(k2) * ldy;
+
+        combine(m2, k2, a11, lda, a21, lda, x, ldx, true);                  // S3 = A11 - A21
+        combine(k2, n2, b22, ldb, b12, ldb, y, ldy, true);                  // T3 = B22 - B12
+        winograd(m2, n2, k2, x, ldx, y, ldy, c21, ldc, next, crossover);   // P7 = S3 T3
+        combine(m2, k2, a21, lda, a22, lda, x, ldx, false);                 // S1 = A21 + A22
+        combine(k2, n2, b12, ldb, b11, ldb, y, ldy, true);                  // T1 = B12 - B11
+        winograd(m2, n2, k2, x, ldx, y, ldy, c22, ldc, next, crossover);   // P5 = S1 T1
+        combine(m2, k2, x, ldx, a11, lda, x, ldx, true);                    // S2 = S1 - A11
+        combine(k2, n2, b22, ldb, y, ldy, y, ldy, true);                    // T2 = B22 - T1
+        winograd(m2, n2, k2, x, ldx, y, ldy, c12, ldc, next, crossover);   // P6 = S2 T2
+        combine(m2, k2, a12, lda, x, ldx, x, ldx, true);                    // S4 = A12 - S2
+        winograd(m2, n2, k2, x, ldx, b22, ldb, c11, ldc, next, crossover); // P3 = S4 B22
+        winograd(m2, n2, k2, a11, lda, b11, ldb, x, ldx, next, crossover); // P1 = A11 B11
+        combine(m2, n2, x, ldx, c12, ldc, c12, ldc, false);                 // U2 = P1 + P6
+        combine(m2, n2, c12, ldc, c21, ldc, c21, ldc, false);               // U3 = U2 + P7
+        combine(m2, n2, c12, ldc, c22, ldc, c12, ldc, false);               // U4 = U2 + P5
+        combine(m2, n2, c21, ldc, c22, ldc, c22, ldc, false);               // C22 = U3 + P5
+        combine(m2, n2, c12, ldc, c11, ldc, c12, ldc, false);               // C12 = U4 + P3
+        combine(k2, n2, y, ldy, b21, ldb, y, ldy, true);                    // T4 = T2 - B21
+        winograd(m2, n2, k2, a22, lda, y, ldy, c11, ldc, next, crossover); // P4 = A22 T4
+        combine(m2, n2, c21, ldc, c11, ldc, c21, ldc, true);                // C21 = U3 - P4
+        winograd(m2, n2, k2, a12, lda, b21, ldb, c11, ldc, next, crossover); // P2 = A12 B21
+        combine(m2, n2, x, ldx, c11, ldc, c11, ldc, false);                 // C11 = P1 + P2
+
+        const int me = 2 * m2;
+        const int ne = 2 * n2;
+        if (k != 2 * k2) {
+            typedef wrapping<T> U;
+            const T* ak = a + (k - 1);
+            const T* bk = b + static_cast<std::ptrdiff_t>(k - 1) * ldb;
+            for (int i = 0; i < me; ++i) {
+                const U aik = static_cast<U>(ak[static_cast<std::ptrdiff_t>(i) * lda]);
+                T* ci = c + static_cast<std::ptrdiff_t>(i) * ldc;
+                for (int j = 0; j < ne; ++j) {
+                    ci[j] = static_cast<T>(static_cast<U>(ci[j]) + aik * static_cast<U>(bk[j]));
+                }
+            }
+        }
+        if (n != ne) {
+            classical(me, n - ne, k, a, lda, b + ne, ldb, c + ne, ldc);
+        }
+        if (m != me) {
+            classical(m - me, n, k, a + static_cast<std::ptrdiff_t>(me) * lda, lda, b, ldb, c + static_cast<std::ptrdiff_t>(me) * ldc, ldc);
+        }
+    }
+
+    /**
+    * \brief Mnożenie Strassena-Winograda z przestrzenią roboczą dostarczoną przez wywołującego.
+    */
+    template <typename T>
+    void strassen(int m, int n, int k, const T* a, int lda, const T* b, int ldb, T* c, int ldc, T* workspace) {
+        winograd(m, n, k, a, lda, b, ldb, c, ldc, workspace, getStrassenCrossover());
+    }
+
+    /**
+    * \brief Zwraca przestrzeń roboczą bieżącego wątku o co najmniej count elementach.
+    *
+    * Bufor jest zachowywany między wywołaniami, więc powtarzane mnożenia
+    * tego samego rozmiaru nie alokują pamięci.
+    */
+    template <typename T>
+    static T* threadWorkspace(std::size_t count) {
+        struct buffer {
+            T* data = nullptr;
+            std::size_t size = 0;
+            ~buffer() { alignedFree(data); }
+        };
+        static thread_local buffer ws;
+        if (ws.size < count) {
+            alignedFree(ws.data);
+            ws.data = nullptr;
+            ws.size = 0;
+            ws.data = static_cast<T*>(alignedAlloc(count * sizeof(T), 64));
+            ws.size = count;
+        }
+        return ws.data;
+    }
+
+    /**
+    * \brief Mnożenie algorytmem strassen dla Acc == T.
+    * \return true (mnożenie wykonane).
+    */
+    template <typename T>
+    static bool fast(int m, int n, int k, const T* a, int lda, const T* b, int ldb, T* c, int ldc) {
+        const int crossover = getStrassenCrossover();
+        winograd(m, n, k, a, lda, b, ldb, c, ldc, threadWorkspace<T>(workspaceSize(m, n, k, crossover)), crossover);
+        return true;
+    }
+
+    /**
+    * \brief Mieszana precyzja: algorytm strassen nie jest dostępny.
+    * \return false (wywołujący użyje mnożenia blokowego).
+    */
+    template <typename T, typename Acc>
+    static bool fast(int, int, int, const T*, int, const T*, int, Acc*, int) {
+        return false;
+    }
+
+    /**
+    * \brief Mnoży macierze algorytmem wybranym przez setAlgorithm().
+    */
+    template <typename T, typename Acc>
+    void multiply(int m, int n, int k, const T* a, int lda, const T* b, int ldb, Acc* c, int ldc) {
+        if (getAlgorithm() == algorithm::strassen && fast(m, n, k, a, lda, b, ldb, c, ldc)) {
+            return;
+        }
+        const double work = static_cast<double>(m) * n * k;
+        if (work >= 128.0 * 128.0 * 128.0 && thread_pool::instance().getThreadCount() > 1) {
+            parallel(m, n, k, a, lda, b, ldb, c, ldc);
+        } else {
+            serial(m, n, k, a, lda, b, ldb, c, ldc);
+        }
+    }
+
+#define GEMM_INSTANTIATE_STRASSEN(T) \
+    template std::size_t strassenWorkspace<T>(int, int, int); \
+    template void strassen<T>(int, int, int, const T*, int, const T*, int, T*, int, T*);
+
+    GEMM_INSTANTIATE_STRASSEN(std::int8_t)
+    GEMM_INSTANTIATE_STRASSEN(std::int16_t)
+    GEMM_INSTANTIATE_STRASSEN(std::int32_t)
+    GEMM_INSTANTIATE_STRASSEN(std::int64_t)
+    GEMM_INSTANTIATE_STRASSEN(float)
+    GEMM_INSTANTIATE_STRASSEN(double)
+
+#undef GEMM_INSTANTIATE_STRASSEN
+
+#define GEMM_INSTANTIATE(T, Acc) \
+    template void naive<T, Acc>(int, int, int, const T*, int, const T*, int, Acc*, int); \
+    template void blocked<T, Acc>(int, int, int, const T*, int, const T*, int, Acc*, int); \
+    template void parallel<T, Acc>(int, int, int, const T*, int, const T*, int, Acc*, int); \
+    template void multiply<T, Acc>(int, int, int, const T*, int, const T*, int, Acc*, int);
+
+    GEMM_INSTANTIATE(std::int8_t, std::int8_t)
+    GEMM_INSTANTIATE(std::int16_t, std::int16_t)
+    GEMM_INSTANTIATE(std::int32_t, std::int32_t)
+    GEMM_INSTANTIATE(std::int64_t, std::int64_t)
+    GEMM_INSTANTIATE(float, float)
+    GEMM_INSTANTIATE(double, double)
+    GEMM_INSTANTIATE(std::int8_t, std::int32_t)
+    GEMM_INSTANTIATE(std::int16_t, std::int32_t)
+    GEMM_INSTANTIATE(std::int32_t, std::int64_t)
+    GEMM_INSTANTIATE(float, double)
+
+#undef GEMM_INSTANTIATE
+}
\ No newline at end of file
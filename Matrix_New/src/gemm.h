@@ -0,0 +1,136 @@
+﻿#pragma once
+#include <cstddef>
+
+/**
+ * \namespace gemm
+ * \brief Jądra mnożenia macierzy przechowywanych wierszami (C = A * B).
+ *
+ * A ma wymiary m x k, B k x n, C m x n. Parametry ld* to odstępy
+ * (w elementach) między początkami kolejnych wierszy. C nie może
+ * współdzielić pamięci z A ani z B.
+ *
+ * Jądra są szablonami po typie elementów wejścia T i typie akumulatora
+ * i wyniku Acc. Konkretyzowane są dla Acc == T (int8_t, int16_t, int32_t,
+ * int64_t, float, double) oraz dla par mieszanej precyzji int8_t/int16_t
+ * -> int32_t, int32_t -> int64_t i float -> double.
+ */
+namespace gemm {
+
+    /**
+     * \brief Dostępne algorytmy mnożenia.
+     */
+    enum class algorithm {
+        naive,   ///< Referencyjna potrójna pętla i-j-k.
+        blocked, ///< Blokowanie L1/L2/L3, pakowane panele i mikrojądro rejestrowe.
+        strassen ///< Strassen-Winograd (7 mnożeń połówek) z przejściem na blocked poniżej progu.
+    };
+
+    /**
+     * \brief Rozmiary bloków algorytmu blokowego.
+     *
+     * Panel B o wymiarach kc x nc powinien mieścić się w L3, blok A
+     * mc x kc w L2, a mikropanel B (kc x NR) w L1.
+     */
+    struct blocking {
+        int mc; ///< Liczba wierszy A w bloku.
+        int kc; ///< Głębokość bloku (wspólny wymiar).
+        int nc; ///< Liczba kolumn B w panelu.
+    };
+
+    const int MR = 4;  ///< Liczba wierszy mikrojądra.
+    const int NR = 16; ///< Liczba kolumn mikrojądra.
+
+    /**
+     * \brief Ustawia algorytm używany przez multiply().
+     * \param a Algorytm.
+     */
+    void setAlgorithm(algorithm a);
+
+    /**
+     * \brief Zwraca algorytm używany przez multiply().
+     * \return Aktualny algorytm.
+     */
+    algorithm getAlgorithm();
+
+    /**
+     * \brief Ustawia rozmiary bloków algorytmu blokowego.
+     * \param b Rozmiary bloków (mc zaokrąglane do MR, nc do NR).
+     */
+    void setBlocking(blocking b);
+
+    /**
+     * \brief Zwraca rozmiary bloków algorytmu blokowego.
+     * \return Rozmiary bloków.
+     */
+    blocking getBlocking();
+
+    /**
+     * \brief Ustawia próg przejścia algorytmu strassen na mnożenie blokowe.
+     * \param n Rekurencja schodzi niżej tylko, gdy wszystkie wymiary są większe od n (co najmniej 16).
+     */
+    void setStrassenCrossover(int n);
+
+    /**
+     * \brief Zwraca próg przejścia algorytmu strassen na mnożenie blokowe.
+     * \return Próg.
+     */
+    int getStrassenCrossover();
+
+    /**
+     * \brief Referencyjne mnożenie potrójną pętlą.
+     */
+    template <typename T, typename Acc = T>
+    void naive(int m, int n, int k, const T* a, int lda, const T* b, int ldb, Acc* c, int ldc);
+
+    /**
+     * \brief Mnożenie blokowe z pakowaniem paneli A i B.
+     */
+    template <typename T, typename Acc = T>
+    void blocked(int m, int n, int k, const T* a, int lda, const T* b, int ldb, Acc* c, int ldc);
+
+    /**
+     * \brief Liczba elementów przestrzeni roboczej potrzebnej strassen() dla danych wymiarów.
+     *
+     * Zależy od bieżącego progu setStrassenCrossover(); wynosi około
+     * (m * max(k, n) + k * n) / 3.
+     * \return Liczba elementów typu T.
+     */
+    template <typename T>
+    std::size_t strassenWorkspace(int m, int n, int k);
+
+    /**
+     * \brief Mnożenie Strassena-Winograda z przestrzenią roboczą dostarczoną przez wywołującego.
+     *
+     * Na każdym poziomie rekurencji parzysta część problemu liczona jest
+     * siedmioma mnożeniami połówek (harmonogram z dwoma buforami
+     * pomocniczymi), a nieparzyste skrajne wiersze, kolumny i warstwa
+     * wspólnego wymiaru - doliczane klasycznie. Liście rekurencji liczone są
+     * blokowo (równolegle dla dużych liści). Dla typów całkowitych
+     * dodawania wykonywane są modulo 2^bitów, więc wynik jest identyczny
+     * z naive(); dla float/double może różnić się zaokrągleniami.
+     * \param workspace Bufor co najmniej strassenWorkspace<T>(m, n, k) elementów.
+     */
+    template <typename T>
+    void strassen(int m, int n, int k, const T* a, int lda, const T* b, int ldb, T* c, int ldc, T* workspace);
+
+    /**
+     * \brief Mnożenie równoległe: C dzielona jest na kafelki 2D wykonywane przez thread_pool::instance().
+     *
+     * Każdy kafelek liczony jest algorytmem wybranym przez setAlgorithm()
+     * (dla strassen - blokowo), więc wynik jest identyczny z wersją
+     * jednowątkową.
+     */
+    template <typename T, typename Acc = T>
+    void parallel(int m, int n, int k, const T* a, int lda, const T* b, int ldb, Acc* c, int ldc);
+
+    /**
+     * \brief Mnoży macierze algorytmem wybranym przez setAlgorithm().
+     *
+     * Dla dostatecznie dużych problemów i puli z więcej niż jednym wątkiem
+     * używa parallel(). Algorytm strassen (tylko dla Acc == T) korzysta
+     * z przestrzeni roboczej wątku, alokowanej raz i powiększanej w razie
+     * potrzeby; dla mieszanej precyzji używane jest mnożenie blokowe.
+     */
+    template <typename T, typename Acc = T>
+    void multiply(int m, int n, int k, const T* a, int lda, const T* b, int ldb, Acc* c, int ldc);
+}
@@ -0,0 +1,205 @@
+﻿#include "gemv.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstdint>
+
+/// Liczba elementów A, od której praca dzielona jest między wątki.
+static const long long PARALLEL_ELEMENTS = 1LL << 16;
+
+/// Szerokość pasa kolumn w multiplyTransposed() w bajtach.
+static const int STRIP_BYTES = 16 * 1024;
+
+/// Liczba wierszy A przetwarzanych naraz w multiplyBatch().
+static const int BATCH_ROWS = 4;
+
+/**
+* \brief Liczy cztery iloczyny skalarne wierszy a0..a3 z wektorem x.
+*
+* Każdy wiersz sumowany jest w LANES niezależnych torach (jedna linia cache),
+* zsumowanych na końcu; wynik nie zależy od podziału na wątki.
+* \param n Długość wierszy.
+* \param a0, a1, a2, a3 Wiersze.
+* \param x Wektor.
+* \param out Cztery wyniki.
+*/
+template <typename T>
+static void dot4(int n, const T* a0, const T* a1, const T* a2, const T* a3, const T* x, T* out) {
+    const int LANES = static_cast<int>(64 / sizeof(T));
+    T s0[64 / sizeof(T)] = {};
+    T s1[64 / sizeof(T)] = {};
+    T s2[64 / sizeof(T)] = {};
+    T s3[64 / sizeof(T)] = {};
+    int j = 0;
+    for (; j + LANES <= n; j += LANES) {
+        for (int l = 0; l < LANES; ++l) {
+            const T xj = x[j + l];
+            s0[l] = static_cast<T>(s0[l] + a0[j + l] * xj);
+            s1[l] = static_cast<T>(s1[l] + a1[j + l] * xj);
+            s2[l] = static_cast<T>(s2[l] + a2[j + l] * xj);
+            s3[l] = static_cast<T>(s3[l] + a3[j + l] * xj);
+        }
+    }
+    for (int l = 0; j < n; ++j, ++l) {
+        s0[l] = static_cast<T>(s0[l] + a0[j] * x[j]);
+        s1[l] = static_cast<T>(s1[l] + a1[j] * x[j]);
+        s2[l] = static_cast<T>(s2[l] + a2[j] * x[j]);
+        s3[l] = static_cast<T>(s3[l] + a3[j] * x[j]);
+    }
+    T r0 = T(0), r1 = T(0), r2 = T(0), r3 = T(0);
+    for (int l = 0; l < LANES; ++l) {
+        r0 = static_cast<T>(r0 + s0[l]);
+        r1 = static_cast<T>(r1 + s1[l]);
+        r2 = static_cast<T>(r2 + s2[l]);
+        r3 = static_cast<T>(r3 + s3[l]);
+    }
+    out[0] = r0;
+    out[1] = r1;
+    out[2] = r2;
+    out[3] = r3;
+}
+
+/**
+* \brief Liczy iloczyny skalarne wierszy first..last-1 macierzy A z wektorem x.
+*
+* Wiersze poza zakresem w ostatniej czwórce zastępowane są wierszem first
+* (ich wyniki są pomijane), więc każdy wiersz liczony jest tym samym jądrem.
+*/
+template <typename T>
+static void dotRows(int first, int last, int n, const T* a, int lda, const T* x, T* y) {
+    for (int i = first; i < last; i += 4) {
+        const T* r[4];
+        for (int q = 0; q < 4; ++q) {
+            r[q] = a + static_cast<std::ptrdiff_t>(i + q < last ? i + q : first) * lda;
+        }
+        T out[4];
+        dot4(n, r[0], r[1], r[2], r[3], x, out);
+        for (int q = 0; q < 4 && i + q < last; ++q) {
+            y[i + q] = out[q];
+        }
+    }
+}
+
+/**
+* \brief Dzieli count jednostek na porcje wykonywane przez pulę wątków.
+* \param count Liczba jednostek (wierszy lub pasów).
+* \param work Liczba elementów A (decyduje o zrównolegleniu).
+* \param align Porcje (poza ostatnią) są wielokrotnością align.
+* \param task Funkcja (first, last).
+*/
+template <typename F>
+static void forChunks(int count, long long work, int align, const F& task) {
+    thread_pool& pool = thread_pool::instance();
+    const int threads = pool.getThreadCount();
+    if (work < PARALLEL_ELEMENTS || threads == 1 || count <= align) {
+        task(0, count);
+        return;
+    }
+    int chunk = (count + threads * 4 - 1) / (threads * 4);
+    chunk = (chunk + align - 1) / align * align;
+    const int chunks = (count + chunk - 1) / chunk;
+    pool.parallelFor(chunks, [&](int c) {
+        task(c * chunk, std::min(count, (c + 1) * chunk));
+    });
+}
+
+/**
+* \brief Iloczyn y = A * x.
+* \param m Liczba wierszy A.
+* \param n Liczba kolumn A.
+* \param a Macierz A.
+* \param lda Odstęp między wierszami A.
+* \param x Wektor n elementów.
+* \param y Wektor m elementów na wynik.
+*/
+template <typename T>
+void gemv::multiply(int m, int n, const T* a, int lda, const T* x, T* y) {
+    if (m <= 0) {
+        return;
+    }
+    forChunks(m, static_cast<long long>(m) * n, 4, [&](int first, int last) {
+        dotRows(first, last, n, a, lda, x, y);
+    });
+}
+
+/**
+* \brief Iloczyn y = x * A.
+* \param m Liczba wierszy A.
+* \param n Liczba kolumn A.
+* \param a Macierz A.
+* \param lda Odstęp między wierszami A.
+* \param x Wektor m elementów.
+* \param y Wektor n elementów na wynik.
+*/
+template <typename T>
+void gemv::multiplyTransposed(int m, int n, const T* a, int lda, const T* x, T* y) {
+    if (n <= 0) {
+        return;
+    }
+    const int strip = static_cast<int>(STRIP_BYTES / sizeof(T));
+    const int strips = (n + strip - 1) / strip;
+    forChunks(strips, static_cast<long long>(m) * n, 1, [&](int firstStrip, int lastStrip) {
+        for (int s = firstStrip; s < lastStrip; ++s) {
+            const int j0 = s * strip;
+            const int w = std::min(strip, n - j0);
+            T* out = y + j0;
+            std::fill(out, out + w, T(0));
+            int i = 0;
+            for (; i + 4 <= m; i += 4) {
+                const T* a0 = a + static_cast<std::ptrdiff_t>(i) * lda + j0;
+                const T* a1 = a0 + lda;
+                const T* a2 = a1 + lda;
+                const T* a3 = a2 + lda;
+                const T x0 = x[i], x1 = x[i + 1], x2 = x[i + 2], x3 = x[i + 3];
+                for (int j = 0; j < w; ++j) {
+                    out[j] = static_cast<T>(out[j] + a0[j] * x0 + a1[j] * x1 + a2[j] * x2 + a3[j] * x3);
+                }
+            }
+            for (; i < m; ++i) {
+                const T* a0 = a + static_cast<std::ptrdiff_t>(i) * lda + j0;
+                const T x0 = x[i];
+                for (int j = 0; j < w; ++j) {
+                    out[j] = static_cast<T>(out[j] + a0[j] * x0);
+                }
+            }
+        }
+    });
+}
+
+/**
+* \brief Iloczyn dla k wektorów naraz: y_v = A * x_v.
+* \param m Liczba wierszy A.
+* \param n Liczba kolumn A.
+* \param a Macierz A.
+* \param lda Odstęp między wierszami A.
+* \param k Liczba wektorów.
+* \param x Wektory wejściowe (n elementów, odstęp ldx).
+* \param ldx Odstęp między wektorami wejściowymi.
+* \param y Wektory wynikowe (m elementów, odstęp ldy).
+* \param ldy Odstęp między wektorami wynikowymi.
+*/
+template <typename T>
+void gemv::multiplyBatch(int m, int n, const T* a, int lda, int k, const T* x, int ldx, T* y, int ldy) {
+    if (m <= 0 || k <= 0) {
+        return;
+    }
+    forChunks(m, static_cast<long long>(m) * n * k, BATCH_ROWS, [&](int first, int last) {
+        for (int i = first; i < last; i += BATCH_ROWS) {
+            const int rowsEnd = std::min(last, i + BATCH_ROWS);
+            for (int v = 0; v < k; ++v) {
+                dotRows(i, rowsEnd, n, a, lda, x + static_cast<std::ptrdiff_t>(v) * ldx, y + static_cast<std::ptrdiff_t>(v) * ldy);
+            }
+        }
+    });
+}
+
+#define GEMV_INSTANTIATE(T) \
+    template void gemv::multiply<T>(int, int, const T*, int, const T*, T*); \
+    template void gemv::multiplyTransposed<T>(int, int, const T*, int, const T*, T*); \
+    template void gemv::multiplyBatch<T>(int, int, const T*, int, int, const T*, int, T*, int);
+
+GEMV_INSTANTIATE(std::int8_t)
+GEMV_INSTANTIATE(std::int16_t)
+GEMV_INSTANTIATE(std::int32_t)
+GEMV_INSTANTIATE(std::int64_t)
+GEMV_INSTANTIATE(float)
+GEMV_INSTANTIATE(double)
\ No newline at end of file
@@ -0,0 +1,45 @@
+﻿#pragma once
+#include <cstddef>
+
+/**
+ * \namespace gemv
+ * \brief Jądra iloczynu macierz - wektor dla macierzy przechowywanych wierszami.
+ *
+ * A ma wymiary m x n, a lda to odstęp (w elementach) między początkami
+ * kolejnych wierszy. Wektory są ciągłe; wynik nie może współdzielić
+ * pamięci z danymi wejściowymi. Sumy liczone są w typie T w stałej
+ * kolejności (niezależnej od liczby wątków). Dla dużych problemów praca
+ * dzielona jest między wątki thread_pool::instance(). Konkretyzowane dla
+ * int8_t, int16_t, int32_t, int64_t, float i double.
+ */
+namespace gemv {
+
+    /**
+     * \brief Iloczyn y = A * x (x ma n, y - m elementów).
+     *
+     * Cztery wiersze A przetwarzane są naraz z jednym odczytem x, a iloczyny
+     * skalarne sumowane w niezależnych torach długości linii cache, które
+     * kompilator wektoryzuje bez zmiany kolejności działań.
+     */
+    template <typename T>
+    void multiply(int m, int n, const T* a, int lda, const T* x, T* y);
+
+    /**
+     * \brief Iloczyn y = x * A (x ma m, y - n elementów).
+     *
+     * Kolumny dzielone są na pasy mieszczące się w pamięci podręcznej; każdy
+     * pas y aktualizowany jest czterema wierszami A naraz, więc A czytana
+     * jest dokładnie raz.
+     */
+    template <typename T>
+    void multiplyTransposed(int m, int n, const T* a, int lda, const T* x, T* y);
+
+    /**
+     * \brief Iloczyn dla k wektorów naraz: y_v = A * x_v dla v = 0..k-1.
+     *
+     * Wektor x_v zaczyna się w x + v * ldx, a y_v w y + v * ldy. Każdy blok
+     * wierszy A czytany jest raz dla wszystkich wektorów.
+     */
+    template <typename T>
+    void multiplyBatch(int m, int n, const T* a, int lda, int k, const T* x, int ldx, T* y, int ldy);
+}
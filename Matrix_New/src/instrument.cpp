@@ -0,0 +1,366 @@
+﻿#include "instrument.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iterator>
+#include <ostream>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#if defined(MATRIX_INSTRUMENT_ITT)
+#include <ittnotify.h>
+#endif
+
+/// Początek listy zarejestrowanych miejsc pomiaru.
+static std::atomic<instrument::site*> sites(nullptr);
+
+/// Najbardziej wewnętrzny trwający pomiar bieżącego wątku.
+static thread_local instrument::scope* innermost = nullptr;
+
+/// Włączony rodzaj znaczników śledzenia.
+static std::atomic<instrument::trace> tracing(instrument::trace::none);
+
+/// Deskryptor pliku trace_marker (-1, jeśli nie jest otwarty); otwierany raz, zapisywany z wielu wątków.
+static std::atomic<int> markerFile(-1);
+
+/**
+* \brief Zwraca bieżący czas w nanosekundach.
+* \return Czas monotoniczny.
+*/
+static std::uint64_t now() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/**
+* \brief Wyznacza przedział histogramu dla czasu ns.
+*
+* Czasy poniżej 4 ns mają własne przedziały, a każda dalsza potęga dwójki
+* dzielona jest na cztery równe części.
+* \param ns Czas w nanosekundach.
+* \return Numer przedziału.
+*/
+static int bucket(std::uint64_t ns) {
+    if (ns < 4) {
+        return static_cast<int>(ns);
+    }
+    int e = 0;
+    for (int step = 32; step > 0; step /= 2) {
+        if (ns >> (e + step)) {
+            e += step;
+        }
+    }
+    return 4 + (e - 2) * 4 + static_cast<int>((ns >> (e - 2)) & 3);
+}
+
+/**
+* \brief Zwraca środek przedziału histogramu.
+* \param b Numer przedziału.
+* \return Czas w nanosekundach.
+*/
+static double bucketMiddle(int b) {
+    if (b < 4) {
+        return b;
+    }
+    const int e = (b - 4) / 4 + 2;
+    const double width = static_cast<double>(std::uint64_t(1) << (e - 2));
+    return (4 + (b - 4) % 4) * width + width / 2;
+}
+
+/**
+* \brief Wyznacza percentyl z histogramu.
+* \param s Miejsce pomiaru.
+* \param calls Liczba wywołań.
+* \param q Kwantyl z (0, 1].
+* \return Czas w nanosekundach.
+*/
+static double percentile(const instrument::site& s, std::uint64_t calls, double q) {
+    const double target = q * static_cast<double>(calls);
+    std::uint64_t seen = 0;
+    for (int b = 0; b < instrument::BUCKETS; ++b) {
+        seen += s.histogram[b].load(std::memory_order_relaxed);
+        if (seen > 0 && static_cast<double>(seen) >= target) {
+            return bucketMiddle(b);
+        }
+    }
+    return 0;
+}
+
+/**
+* \brief Zapisuje znacznik początku operacji.
+* \param s Miejsce pomiaru.
+*/
+static void traceBegin(instrument::site& s) {
+    switch (tracing.load(std::memory_order_acquire)) {
+        case instrument::trace::ftrace: {
+#if !defined(_WIN32)
+            char line[160];
+            const int n = std::snprintf(line, sizeof(line), "B|%d|%s[%s]", static_cast<int>(getpid()), s.name, s.type);
+            if (n > 0 && ::write(markerFile.load(std::memory_order_relaxed), line, std::min<std::size_t>(n, sizeof(line) - 1)) < 0) {
+                tracing = instrument::trace::none;
+            }
+#endif
+            break;
+        }
+        case instrument::trace::itt: {
+#if defined(MATRIX_INSTRUMENT_ITT)
+            void* handle = s.traceHandle.load();
+            if (handle == nullptr) {
+                const std::string label = std::string(s.name) + "[" + s.type + "]";
+                handle = __itt_string_handle_create(label.c_str());
+                s.traceHandle = handle;
+            }
+            static __itt_domain* domain = __itt_domain_create("matrix");
+            __itt_task_begin(domain, __itt_null, __itt_null, static_cast<__itt_string_handle*>(handle));
+#endif
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+/**
+* \brief Zapisuje znacznik końca operacji.
+*/
+static void traceEnd() {
+    switch (tracing.load(std::memory_order_acquire)) {
+        case instrument::trace::ftrace: {
+#if !defined(_WIN32)
+            char line[32];
+            const int n = std::snprintf(line, sizeof(line), "E|%d", static_cast<int>(getpid()));
+            if (n > 0 && ::write(markerFile.load(std::memory_order_relaxed), line, n) < 0) {
+                tracing = instrument::trace::none;
+            }
+#endif
+            break;
+        }
+        case instrument::trace::itt: {
+#if defined(MATRIX_INSTRUMENT_ITT)
+            static __itt_domain* domain = __itt_domain_create("matrix");
+            __itt_task_end(domain);
+#endif
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+/**
+* \brief Konstruktor; rejestruje miejsce na liście globalnej.
+* \param n Nazwa operacji.
+* \param t Nazwa typu elementu.
+*/
+instrument::site::site(const char* n, const char* t)
+    : name(n), type(t), calls(0), nanoseconds(0), flops(0), bytes(0), allocations(0), allocatedBytes(0), traceHandle(nullptr), next(nullptr) {
+    for (std::atomic<std::uint64_t>& h : histogram) {
+        h.store(0, std::memory_order_relaxed);
+    }
+    site* head = sites.load();
+    do {
+        next = head;
+    } while (!sites.compare_exchange_weak(head, this));
+}
+
+/**
+* \brief Rozpoczyna pomiar.
+* \param s Miejsce pomiaru.
+* \param flops Liczba operacji arytmetycznych wywołania.
+* \param bytes Liczba bajtów czytanych i zapisywanych przez wywołanie.
+*/
+instrument::scope::scope(site& s, double flops, double bytes) : where(s), outer(innermost), start(0) {
+    s.flops.fetch_add(static_cast<std::uint64_t>(flops), std::memory_order_relaxed);
+    s.bytes.fetch_add(static_cast<std::uint64_t>(bytes), std::memory_order_relaxed);
+    innermost = this;
+    traceBegin(s);
+    start = now();
+}
+
+/**
+* \brief Kończy pomiar i dolicza czas.
+*/
+instrument::scope::~scope() {
+    const std::uint64_t ns = now() - start;
+    traceEnd();
+    where.calls.fetch_add(1, std::memory_order_relaxed);
+    where.nanoseconds.fetch_add(ns, std::memory_order_relaxed);
+    where.histogram[bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+    innermost = outer;
+}
+
+/**
+* \brief Dolicza alokację do tego pomiaru i wszystkich obejmujących.
+* \param bytes Rozmiar alokacji.
+*/
+void instrument::scope::allocated(std::size_t bytes) {
+    for (scope* s = this; s != nullptr; s = s->outer) {
+        s->where.allocations.fetch_add(1, std::memory_order_relaxed);
+        s->where.allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+}
+
+/**
+* \brief Zwraca najbardziej wewnętrzny trwający pomiar bieżącego wątku.
+* \return Pomiar lub nullptr.
+*/
+instrument::scope* instrument::scope::current() {
+    return innermost;
+}
+
+/**
+* \brief Rejestruje alokację bufora macierzy.
+* \param s Miejsce alokacji.
+* \param bytes Rozmiar alokacji.
+*/
+void instrument::allocation(site& s, std::size_t bytes) {
+    s.calls.fetch_add(1, std::memory_order_relaxed);
+    s.allocations.fetch_add(1, std::memory_order_relaxed);
+    s.allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    if (innermost != nullptr) {
+        innermost->allocated(bytes);
+    }
+}
+
+/**
+* \brief Zwraca migawkę wszystkich miejsc, które były wywołane.
+* \return Migawki posortowane malejąco po łącznym czasie.
+*/
+std::vector<instrument::record> instrument::snapshot() {
+    std::vector<record> out;
+    for (site* s = sites.load(); s != nullptr; s = s->next) {
+        const std::uint64_t calls = s->calls.load();
+        if (calls == 0) {
+            continue;
+        }
+        record r;
+        r.name = s->name;
+        r.type = s->type;
+        r.calls = calls;
+        r.nanoseconds = s->nanoseconds.load();
+        r.flops = s->flops.load();
+        r.bytes = s->bytes.load();
+        r.allocations = s->allocations.load();
+        r.allocatedBytes = s->allocatedBytes.load();
+        r.timed = std::any_of(std::begin(s->histogram), std::end(s->histogram), [](const std::atomic<std::uint64_t>& h) {
+            return h.load(std::memory_order_relaxed) != 0;
+        });
+        r.p50 = percentile(*s, calls, 0.50);
+        r.p90 = percentile(*s, calls, 0.90);
+        r.p99 = percentile(*s, calls, 0.99);
+        out.push_back(r);
+    }
+    std::sort(out.begin(), out.end(), [](const record& a, const record& b) {
+        return a.nanoseconds != b.nanoseconds ? a.nanoseconds > b.nanoseconds : a.name < b.name;
+    });
+    return out;
+}
+
+/**
+* \brief Zeruje liczniki wszystkich miejsc pomiaru.
+*/
+void instrument::reset() {
+    for (site* s = sites.load(); s != nullptr; s = s->next) {
+        s->calls = 0;
+        s->nanoseconds = 0;
+        s->flops = 0;
+        s->bytes = 0;
+        s->allocations = 0;
+        s->allocatedBytes = 0;
+        for (std::atomic<std::uint64_t>& h : s->histogram) {
+            h.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+/**
+* \brief Wypisuje migawkę jako tabelę tekstową.
+* \param o Strumień.
+*/
+void instrument::writeText(std::ostream& o) {
+    char line[256];
+    std::snprintf(line, sizeof(line), "%-20s %-7s %10s %12s %10s %10s %10s %10s %9s %9s %9s %12s\n",
+        "operation", "type", "calls", "total ms", "mean us", "p50 us", "p90 us", "p99 us", "GFLOP/s", "GB/s", "allocs", "alloc bytes");
+    o << line;
+    for (const record& r : snapshot()) {
+        const double ns = static_cast<double>(r.nanoseconds);
+        // Miejsca alokacji nie mierzą czasu: kolumny czasów pozostają puste.
+        char times[48];
+        if (r.timed) {
+            std::snprintf(times, sizeof(times), "%10.3f %10.3f %10.3f %10.3f", ns * 1e-3 / r.calls, r.p50 * 1e-3, r.p90 * 1e-3, r.p99 * 1e-3);
+        } else {
+            std::snprintf(times, sizeof(times), "%10s %10s %10s %10s", "-", "-", "-", "-");
+        }
+        std::snprintf(line, sizeof(line), "%-20s %-7s %10llu %12.3f %43s %9.3f %9.3f %9llu %12llu\n",
+            r.name.c_str(), r.type.c_str(), static_cast<unsigned long long>(r.calls), ns * 1e-6,
+            times, ns > 0 ? r.flops / ns : 0.0, ns > 0 ? r.bytes / ns : 0.0,
+            static_cast<unsigned long long>(r.allocations), static_cast<unsigned long long>(r.allocatedBytes));
+        o << line;
+    }
+}
+
+/**
+* \brief Wypisuje migawkę w formacie JSON.
+* \param o Strumień.
+*/
+void instrument::writeJson(std::ostream& o) {
+    const std::vector<record> records = snapshot();
+    o << "{\"operations\": [";
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        const record& r = records[i];
+        o << (i ? ",\n  " : "\n  ") << "{\"name\": \"" << r.name << "\", \"type\": \"" << r.type
+            << "\", \"calls\": " << r.calls << ", \"total_ns\": " << r.nanoseconds;
+        if (r.timed) {
+            o << ", \"p50_ns\": " << r.p50 << ", \"p90_ns\": " << r.p90 << ", \"p99_ns\": " << r.p99;
+        } else {
+            o << ", \"p50_ns\": null, \"p90_ns\": null, \"p99_ns\": null";
+        }
+        o << ", \"flops\": " << r.flops << ", \"bytes\": " << r.bytes
+            << ", \"allocations\": " << r.allocations << ", \"allocated_bytes\": " << r.allocatedBytes << "}";
+    }
+    o << "\n]}\n";
+}
+
+/**
+* \brief Włącza lub wyłącza znaczniki śledzenia.
+* \param t Rodzaj znaczników.
+* \return false, jeśli rodzaj jest niedostępny.
+*/
+bool instrument::setTrace(trace t) {
+    tracing = trace::none;
+#if !defined(_WIN32)
+    if (t == trace::ftrace && markerFile.load() < 0) {
+        int fd = ::open("/sys/kernel/tracing/trace_marker", O_WRONLY | O_CLOEXEC);
+        if (fd < 0) {
+            fd = ::open("/sys/kernel/debug/tracing/trace_marker", O_WRONLY | O_CLOEXEC);
+        }
+        // Przy równoległych wywołaniach zostaje deskryptor otwarty jako pierwszy.
+        int expected = -1;
+        if (fd >= 0 && !markerFile.compare_exchange_strong(expected, fd)) {
+            ::close(fd);
+        }
+    }
+    if (t == trace::ftrace && markerFile.load() < 0) {
+        return false;
+    }
+#else
+    if (t == trace::ftrace) {
+        return false;
+    }
+#endif
+#if !defined(MATRIX_INSTRUMENT_ITT)
+    if (t == trace::itt) {
+        return false;
+    }
+#endif
+    tracing = t;
+    return true;
+}
+
+/**
+* \brief Zwraca włączony rodzaj znaczników śledzenia.
+* \return Rodzaj znaczników.
+*/
+instrument::trace instrument::getTrace() {
+    return tracing;
+}
\ No newline at end of file
@@ -0,0 +1,212 @@
+﻿#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * \namespace instrument
+ * \brief Liczniki, czasy i alokacje operacji macierzy, włączane w czasie kompilacji.
+ *
+ * Punkty pomiarowe wstawiane są makrami MATRIX_SCOPE i MATRIX_ALLOCATION,
+ * które bez zdefiniowanego MATRIX_INSTRUMENT rozwijają się do pustej
+ * instrukcji (argumenty nie są obliczane). Po zdefiniowaniu MATRIX_INSTRUMENT
+ * (np. -DMATRIX_INSTRUMENT) każde miejsce pomiaru zlicza wywołania, łączny
+ * czas z histogramem opóźnień, operacje arytmetyczne, przetworzone bajty
+ * oraz alokacje wykonane wewnątrz (łącznie z zagnieżdżonymi operacjami).
+ * Dodatkowo setTrace() włącza znaczniki początku i końca operacji dla
+ * zewnętrznych narzędzi: ftrace (trace_marker, czytany przez perf,
+ * trace-cmd i Perfetto) lub ITT (VTune; wymaga MATRIX_INSTRUMENT_ITT
+ * i ittnotify.h).
+ */
+namespace instrument {
+
+    const int BUCKETS = 252; ///< Liczba przedziałów histogramu (cztery na każdą potęgę dwójki nanosekund).
+
+    /**
+     * \class site
+     * \brief Miejsce pomiaru: jedna operacja dla jednego typu elementu.
+     *
+     * Obiekty tworzone są jako statyczne zmienne lokalne przez MATRIX_SCOPE
+     * i rejestrują się na globalnej liście; nie są nigdy niszczone przed
+     * końcem programu.
+     */
+    class site {
+        public:
+            const char* name;  ///< Nazwa operacji.
+            const char* type;  ///< Nazwa typu elementu.
+            std::atomic<std::uint64_t> calls;          ///< Liczba wywołań.
+            std::atomic<std::uint64_t> nanoseconds;    ///< Łączny czas.
+            std::atomic<std::uint64_t> flops;          ///< Łączna liczba operacji arytmetycznych.
+            std::atomic<std::uint64_t> bytes;          ///< Łączna liczba przetworzonych bajtów.
+            std::atomic<std::uint64_t> allocations;    ///< Liczba alokacji buforów macierzy wewnątrz operacji.
+            std::atomic<std::uint64_t> allocatedBytes; ///< Łączny rozmiar tych alokacji.
+            std::atomic<std::uint64_t> histogram[BUCKETS]; ///< Liczba wywołań w przedziałach czasu.
+            std::atomic<void*> traceHandle;            ///< Uchwyt nazwy dla ITT (tworzony przy pierwszym użyciu).
+            site* next;                                ///< Następne miejsce na liście globalnej.
+
+            /**
+             * \brief Konstruktor; rejestruje miejsce na liście globalnej.
+             * \param n Nazwa operacji (literał).
+             * \param t Nazwa typu elementu (literał).
+             */
+            site(const char* n, const char* t);
+
+            site(const site&) = delete;
+            site& operator=(const site&) = delete;
+    };
+
+    /**
+     * \class scope
+     * \brief Pomiar jednego wywołania operacji (RAII).
+     */
+    class scope {
+        private:
+            site& where;         ///< Miejsce pomiaru.
+            scope* outer;        ///< Pomiar obejmujący (w tym samym wątku).
+            std::uint64_t start; ///< Czas rozpoczęcia w nanosekundach.
+
+        public:
+            /**
+             * \brief Rozpoczyna pomiar.
+             * \param s Miejsce pomiaru.
+             * \param flops Liczba operacji arytmetycznych wywołania.
+             * \param bytes Liczba bajtów czytanych i zapisywanych przez wywołanie.
+             */
+            scope(site& s, double flops, double bytes);
+
+            /**
+             * \brief Kończy pomiar i dolicza czas.
+             */
+            ~scope();
+
+            scope(const scope&) = delete;
+            scope& operator=(const scope&) = delete;
+
+            /**
+             * \brief Dolicza alokację do tego pomiaru i wszystkich obejmujących.
+             * \param bytes Rozmiar alokacji.
+             */
+            void allocated(std::size_t bytes);
+
+            /**
+             * \brief Zwraca najbardziej wewnętrzny trwający pomiar bieżącego wątku.
+             * \return Pomiar lub nullptr.
+             */
+            static scope* current();
+    };
+
+    /**
+     * \brief Migawka jednego miejsca pomiaru.
+     */
+    struct record {
+        std::string name;             ///< Nazwa operacji.
+        std::string type;             ///< Nazwa typu elementu.
+        std::uint64_t calls;          ///< Liczba wywołań.
+        std::uint64_t nanoseconds;    ///< Łączny czas.
+        std::uint64_t flops;          ///< Łączna liczba operacji arytmetycznych.
+        std::uint64_t bytes;          ///< Łączna liczba przetworzonych bajtów.
+        std::uint64_t allocations;    ///< Liczba alokacji.
+        std::uint64_t allocatedBytes; ///< Łączny rozmiar alokacji.
+        bool timed;                   ///< Czy wywołania mają zmierzony czas (false dla miejsc alokacji; wtedy percentyle są nieokreślone).
+        double p50;                   ///< Mediana czasu wywołania w nanosekundach (z dokładnością przedziału histogramu).
+        double p90;                   ///< 90. percentyl czasu.
+        double p99;                   ///< 99. percentyl czasu.
+    };
+
+    /**
+     * \brief Rejestruje alokację bufora macierzy.
+     *
+     * Alokacja zliczana jest w miejscu s (jako wywołanie bez pomiaru czasu,
+     * więc raporty nie podają dla niego percentyli) oraz we wszystkich
+     * trwających pomiarach bieżącego wątku.
+     * \param s Miejsce alokacji.
+     * \param bytes Rozmiar alokacji.
+     */
+    void allocation(site& s, std::size_t bytes);
+
+    /**
+     * \brief Zwraca migawkę wszystkich miejsc, które były wywołane.
+     * \return Migawki posortowane malejąco po łącznym czasie.
+     */
+    std::vector<record> snapshot();
+
+    /**
+     * \brief Zeruje liczniki wszystkich miejsc pomiaru.
+     */
+    void reset();
+
+    /**
+     * \brief Wypisuje migawkę jako tabelę tekstową.
+     * \param o Strumień.
+     */
+    void writeText(std::ostream& o);
+
+    /**
+     * \brief Wypisuje migawkę w formacie JSON.
+     * \param o Strumień.
+     */
+    void writeJson(std::ostream& o);
+
+    /**
+     * \brief Rodzaje znaczników śledzenia.
+     */
+    enum class trace {
+        none,   ///< Bez znaczników.
+        ftrace, ///< Zapisy "B|pid|nazwa" i "E|pid" do trace_marker (Linux).
+        itt     ///< Zadania __itt_task_begin/__itt_task_end (wymaga MATRIX_INSTRUMENT_ITT).
+    };
+
+    /**
+     * \brief Włącza lub wyłącza znaczniki śledzenia.
+     * \param t Rodzaj znaczników.
+     * \return false, jeśli rodzaj jest niedostępny (wtedy znaczniki są wyłączane).
+     */
+    bool setTrace(trace t);
+
+    /**
+     * \brief Zwraca włączony rodzaj znaczników śledzenia.
+     * \return Rodzaj znaczników.
+     */
+    trace getTrace();
+
+    /**
+     * \brief Zwraca nazwę typu elementu używaną w raportach.
+     * \return Nazwa.
+     */
+    template <typename T>
+    const char* typeName() {
+        if (std::is_same<T, std::int8_t>::value) return "int8";
+        if (std::is_same<T, std::int16_t>::value) return "int16";
+        if (std::is_same<T, std::int32_t>::value) return "int32";
+        if (std::is_same<T, std::int64_t>::value) return "int64";
+        if (std::is_same<T, float>::value) return "float";
+        if (std::is_same<T, double>::value) return "double";
+        return "other";
+    }
+}
+
+#define MATRIX_INSTRUMENT_CONCAT2(a, b) a##b
+#define MATRIX_INSTRUMENT_CONCAT(a, b) MATRIX_INSTRUMENT_CONCAT2(a, b)
+
+#if defined(MATRIX_INSTRUMENT)
+/**
+ * \brief Mierzy resztę bieżącego bloku jako wywołanie operacji name na elementach typu T.
+ */
+#define MATRIX_SCOPE(name, T, flops, bytes) \
+    static instrument::site MATRIX_INSTRUMENT_CONCAT(matrixSite, __LINE__)(name, instrument::typeName<T>()); \
+    instrument::scope MATRIX_INSTRUMENT_CONCAT(matrixScope, __LINE__)(MATRIX_INSTRUMENT_CONCAT(matrixSite, __LINE__), static_cast<double>(flops), static_cast<double>(bytes))
+
+/**
+ * \brief Rejestruje alokację bufora macierzy o rozmiarze bytes dla elementów typu T.
+ */
+#define MATRIX_ALLOCATION(T, bytes) \
+    static instrument::site MATRIX_INSTRUMENT_CONCAT(matrixSite, __LINE__)("allocateMemory", instrument::typeName<T>()); \
+    instrument::allocation(MATRIX_INSTRUMENT_CONCAT(matrixSite, __LINE__), (bytes))
+#else
+#define MATRIX_SCOPE(name, T, flops, bytes) ((void)0)
+#define MATRIX_ALLOCATION(T, bytes) ((void)0)
+#endif
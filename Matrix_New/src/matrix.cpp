@@ -1,93 +1,399 @@
 ﻿#include "matrix.h"
+#include "matrix_text.h"
+#include "gemm.h"
+#include "instrument.h"
+#include "simd.h"
+#include "transpose.h"
+#include <algorithm>
 #include <iostream>
-#include <cstdlib>
-#include <ctime>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 /**
-* \brief Alokuje pamięć dla macierzy o rozmiarze n.
-* \param n Rozmiar macierzy.
+* \brief Wyznacza wiodący wymiar bufora dla wierszy o długości n.
+*
+* Wiersze są dopełniane do wielokrotności linii cache, a gdy odstęp między
+* wierszami wypada na wielokrotność 4 KiB, dokładana jest jeszcze jedna linia,
+* żeby kolejne wiersze nie trafiały w ten sam zbiór cache.
+* \param n Liczba kolumn macierzy.
+* \param l Sposób ułożenia wierszy w buforze.
+* \return Odstęp między wierszami w elementach.
 */
-void matrix::allocateMemory(int n) {
-    data = new int*[n];
-    for (int i = 0; i < n; ++i) {
-        data[i] = new int[n]();
+template <typename T>
+static int leadingDimension(int n, typename basic_matrix<T>::layout l) {
+    const int lane = static_cast<int>(basic_matrix<T>::ALIGNMENT / sizeof(T));
+    if (l == basic_matrix<T>::layout::packed || n < lane) {
+        return n;
     }
+    int ld = (n + lane - 1) / lane * lane;
+    if ((static_cast<std::size_t>(ld) * sizeof(T)) % 4096 == 0) {
+        ld += lane;
+    }
+    return ld;
+}
+
+/**
+* \brief Alokuje pamięć dla macierzy r x c.
+* \param r Liczba wierszy.
+* \param c Liczba kolumn.
+* \param l Sposób ułożenia wierszy w buforze.
+*/
+template <typename T>
+void basic_matrix<T>::allocateMemory(int r, int c, layout l) {
+    stride = leadingDimension<T>(c, l);
+    std::size_t bytes = static_cast<std::size_t>(r) * stride * sizeof(T);
+    MATRIX_ALLOCATION(T, bytes);
+    data = static_cast<T*>(alloc->allocate(bytes, ALIGNMENT));
+    std::memset(data, 0, bytes);
 }
 
 /**
  * \brief Zwalnia pamięć zajmowaną przez macierz.
  */
-void matrix::deallocateMemory() {
-    for (int i = 0; i < size; ++i) {
-        delete[] data[i];
+template <typename T>
+void basic_matrix<T>::deallocateMemory() {
+    if (external) {
+        external.reset();
+    } else {
+        alloc->deallocate(data, static_cast<std::size_t>(rows) * stride * sizeof(T), ALIGNMENT);
+    }
+    data = nullptr;
+}
+
+/**
+* \brief Wypełnia macierz wartościami: this[i][j] = kernel(src[i][j], a).
+* \param kernel Jądro element po elemencie (simd::binaryKernel).
+* \param src Macierz źródłowa o tych samych wymiarach (może być *this).
+* \param a Argument skalarny jądra.
+*/
+template <typename T>
+void basic_matrix<T>::apply(simd::binaryKernel<T> kernel, const basic_matrix<T>& src, T a) {
+    if (stride == cols && src.stride == src.cols) {
+        kernel(data, src.data, static_cast<std::size_t>(rows) * cols, a);
+        return;
+    }
+    for (int i = 0; i < rows; ++i) {
+        kernel(rowPtr(i), src.rowPtr(i), cols, a);
     }
-    delete[] data;
 }
 
 /**
  * \brief Konstruktor domyślny.
  */
-matrix::matrix() : data(nullptr), size(0) {}
+template <typename T>
+basic_matrix<T>::basic_matrix() : data(nullptr), rows(0), cols(0), stride(0), alloc(&currentAllocator()) {}
 
 /**
-* \brief Konstruktor tworzący macierz o rozmiarze n.
+* \brief Konstruktor tworzący macierz kwadratową o rozmiarze n.
 * \param n Rozmiar macierzy.
 */
-matrix::matrix(int n) : size(n) {
-    allocateMemory(n);
-}
+template <typename T>
+basic_matrix<T>::basic_matrix(int n) : basic_matrix(n, n) {}
 
 /**
-* \brief Konstruktor tworzący macierz o rozmiarze n i inicjalizujący ją wartościami z tablicy t.
+* \brief Konstruktor tworzący macierz kwadratową o rozmiarze n i zadanym ułożeniu wierszy.
 * \param n Rozmiar macierzy.
-* \param t Tablica wartości do inicjalizacji macierzy.
+* \param l Sposób ułożenia wierszy w buforze.
 */
-matrix::matrix(int n, int* t) : size(n) {
-    allocateMemory(n);
-    for (int i = 0; i < n; ++i) {
-        for (int j = 0; j < n; ++j) {
-            data[i][j] = t[i * n + j];
-        }
+template <typename T>
+basic_matrix<T>::basic_matrix(int n, layout l) : basic_matrix(n, n, l) {}
+
+/**
+* \brief Konstruktor tworzący macierz kwadratową o rozmiarze n i inicjalizujący ją wartościami z tablicy t.
+* \param n Rozmiar macierzy.
+* \param t Tablica n * n wartości (wierszami) do inicjalizacji macierzy.
+*/
+template <typename T>
+basic_matrix<T>::basic_matrix(int n, const T* t) : basic_matrix(n, n, t) {}
+
+/**
+* \brief Konstruktor tworzący macierz r x c.
+* \param r Liczba wierszy.
+* \param c Liczba kolumn.
+*/
+template <typename T>
+basic_matrix<T>::basic_matrix(int r, int c) : rows(r), cols(c), alloc(&currentAllocator()) {
+    allocateMemory(r, c);
+}
+
+/**
+* \brief Konstruktor tworzący macierz r x c o zadanym ułożeniu wierszy.
+* \param r Liczba wierszy.
+* \param c Liczba kolumn.
+* \param l Sposób ułożenia wierszy w buforze.
+*/
+template <typename T>
+basic_matrix<T>::basic_matrix(int r, int c, layout l) : rows(r), cols(c), alloc(&currentAllocator()) {
+    allocateMemory(r, c, l);
+}
+
+/**
+* \brief Konstruktor tworzący macierz r x c i inicjalizujący ją wartościami z tablicy t.
+* \param r Liczba wierszy.
+* \param c Liczba kolumn.
+* \param t Tablica r * c wartości (wierszami) do inicjalizacji macierzy.
+*/
+template <typename T>
+basic_matrix<T>::basic_matrix(int r, int c, const T* t) : rows(r), cols(c), alloc(&currentAllocator()) {
+    allocateMemory(r, c);
+    for (int i = 0; i < r; ++i) {
+        std::memcpy(rowPtr(i), t + static_cast<std::ptrdiff_t>(i) * c, c * sizeof(T));
+    }
+}
+
+/**
+* \brief Konstruktor tworzący macierz r x c w pamięci z podanego alokatora.
+* \param r Liczba wierszy.
+* \param c Liczba kolumn.
+* \param a Alokator bufora; musi przeżyć macierz.
+*/
+template <typename T>
+basic_matrix<T>::basic_matrix(int r, int c, allocator& a) : rows(r), cols(c), alloc(&a) {
+    allocateMemory(r, c);
+}
+
+/**
+* \brief Konstruktor przejmujący bufor zewnętrzny (bez kopiowania i bez alokacji).
+* \param buffer Bufor r wierszy po ld elementów.
+* \param r Liczba wierszy.
+* \param c Liczba kolumn.
+* \param ld Odstęp między wierszami bufora w elementach (>= c).
+* \param owner Obiekt, którego zniszczenie zwalnia bufor.
+*/
+template <typename T>
+basic_matrix<T>::basic_matrix(T* buffer, int r, int c, int ld, std::shared_ptr<void> owner)
+    : data(buffer), rows(r), cols(c), stride(ld), alloc(&currentAllocator()), external(std::move(owner)) {}
+
+/**
+* \brief Sprawdza opis bufora zewnętrznego i zwraca odstęp między wierszami.
+* \param buffer Bufor.
+* \param r Liczba wierszy.
+* \param c Liczba kolumn.
+* \param ld Odstęp między wierszami (0 - równy c).
+* \return Odstęp między wierszami.
+*/
+static int externalStride(const void* buffer, int r, int c, int ld) {
+    if (ld == 0) {
+        ld = c;
+    }
+    if (r < 0 || c < 0 || ld < c || (buffer == nullptr && r > 0 && c > 0)) {
+        throw std::invalid_argument("matrix: invalid external buffer");
+    }
+    return ld;
+}
+
+/**
+* \brief Właściciel bufora z alokatora macierzy, tworzony przez shareData().
+*/
+template <typename T>
+struct shared_buffer {
+    allocator* alloc; ///< Alokator bufora.
+    T* data; ///< Bufor.
+    std::size_t bytes; ///< Rozmiar bufora w bajtach.
+
+    /**
+     * \brief Destruktor zwalniający bufor.
+     */
+    ~shared_buffer() {
+        alloc->deallocate(data, bytes, basic_matrix<T>::ALIGNMENT);
+    }
+};
+
+/**
+* \brief Tworzy macierz na buforze wywołującego bez kopiowania; bufor nie jest zwalniany.
+* \param buffer Bufor r wierszy po ld elementów.
+* \param r Liczba wierszy.
+* \param c Liczba kolumn.
+* \param ld Odstęp między wierszami bufora w elementach (0 - równy c).
+* \return Macierz operująca na buforze.
+*/
+template <typename T>
+basic_matrix<T> basic_matrix<T>::wrap(T* buffer, int r, int c, int ld) {
+    ld = externalStride(buffer, r, c, ld);
+    // Pusty właściciel ze wskaźnikiem na bufor: oznacza bufor zewnętrzny, nic nie zwalnia.
+    return basic_matrix(buffer, r, c, ld, std::shared_ptr<void>(std::shared_ptr<void>(), buffer));
+}
+
+/**
+* \brief Tworzy macierz przejmującą bufor wywołującego bez kopiowania.
+* \param buffer Bufor r wierszy po ld elementów.
+* \param r Liczba wierszy.
+* \param c Liczba kolumn.
+* \param ld Odstęp między wierszami bufora w elementach (0 - równy c).
+* \param deleter Funkcja zwalniająca bufor.
+* \return Macierz będąca właścicielem bufora.
+*/
+template <typename T>
+basic_matrix<T> basic_matrix<T>::adopt(T* buffer, int r, int c, int ld, std::function<void(T*)> deleter) {
+    ld = externalStride(buffer, r, c, ld);
+    return basic_matrix(buffer, r, c, ld, std::shared_ptr<T>(buffer, std::move(deleter)));
+}
+
+/**
+* \brief Tworzy macierz współdzielącą bufor z innymi właścicielami bez kopiowania.
+* \param buffer Współdzielony bufor r wierszy po ld elementów.
+* \param r Liczba wierszy.
+* \param c Liczba kolumn.
+* \param ld Odstęp między wierszami bufora w elementach (0 - równy c).
+* \return Macierz współwłaściciel bufora.
+*/
+template <typename T>
+basic_matrix<T> basic_matrix<T>::adopt(std::shared_ptr<T> buffer, int r, int c, int ld) {
+    ld = externalStride(buffer.get(), r, c, ld);
+    T* p = buffer.get();
+    return basic_matrix(p, r, c, ld, std::move(buffer));
+}
+
+/**
+* \brief Udostępnia bufor macierzy ze współdzieloną własnością, bez kopiowania.
+*
+* Bufor z alokatora przekazywany jest przy pierwszym wywołaniu obiektowi
+* shared_buffer; od tej pory macierz zwalnia go tak jak bufor zewnętrzny.
+* \return Wskaźnik na element (0, 0).
+*/
+template <typename T>
+std::shared_ptr<T> basic_matrix<T>::shareData() {
+    if (data == nullptr) {
+        return std::shared_ptr<T>();
+    }
+    if (!external) {
+        std::shared_ptr<shared_buffer<T>> owner = std::make_shared<shared_buffer<T>>();
+        owner->alloc = alloc;
+        owner->data = data;
+        owner->bytes = static_cast<std::size_t>(rows) * stride * sizeof(T);
+        external = std::move(owner);
     }
+    return std::shared_ptr<T>(external, data);
 }
 
 /**
 * \brief Konstruktor kopiujący.
+*
+* Kopia alokowana jest przez currentAllocator(), niezależnie od alokatora m.
 * \param m Obiekt macierzy do skopiowania.
 */
-matrix::matrix(const matrix& m) : size(m.size) {
-    allocateMemory(size);
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            data[i][j] = m.data[i][j];
+template <typename T>
+basic_matrix<T>::basic_matrix(const basic_matrix& m) : data(nullptr), rows(m.rows), cols(m.cols), stride(0), alloc(&currentAllocator()) {
+    if (m.data == nullptr) {
+        return;
+    }
+    MATRIX_SCOPE("copy", T, 0, 2.0 * rows * cols * sizeof(T));
+    allocateMemory(rows, cols, m.stride == m.cols ? layout::packed : layout::padded);
+    for (int i = 0; i < rows; ++i) {
+        std::memcpy(rowPtr(i), m.rowPtr(i), cols * sizeof(T));
+    }
+}
+
+/**
+* \brief Konstruktor przenoszący.
+* \param m Obiekt macierzy, którego bufor zostanie przejęty.
+*/
+template <typename T>
+basic_matrix<T>::basic_matrix(basic_matrix&& m) noexcept
+    : data(m.data), rows(m.rows), cols(m.cols), stride(m.stride), alloc(m.alloc), external(std::move(m.external)) {
+    m.data = nullptr;
+    m.rows = 0;
+    m.cols = 0;
+    m.stride = 0;
+}
+
+/**
+* \brief Kopiujący operator przypisania.
+*
+* Gdy wymiary są zgodne, dane są kopiowane do istniejącego bufora bez
+* nowej alokacji.
+* \param m Obiekt macierzy do skopiowania.
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::operator=(const basic_matrix<T>& m) {
+    if (this == &m) {
+        return *this;
+    }
+    MATRIX_SCOPE("copy assignment", T, 0, 2.0 * m.rows * m.cols * sizeof(T));
+    if (data != nullptr && m.data != nullptr && rows == m.rows && cols == m.cols) {
+        for (int i = 0; i < rows; ++i) {
+            std::memcpy(rowPtr(i), m.rowPtr(i), cols * sizeof(T));
         }
+        return *this;
     }
+    basic_matrix copy(m);
+    swap(copy);
+    return *this;
+}
+
+/**
+* \brief Przenoszący operator przypisania.
+* \param m Obiekt macierzy, którego bufor zostanie przejęty.
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::operator=(basic_matrix<T>&& m) noexcept {
+    if (this != &m) {
+        basic_matrix moved(std::move(m));
+        swap(moved);
+    }
+    return *this;
+}
+
+/**
+* \brief Zamienia zawartość dwóch macierzy bez kopiowania danych.
+* \param m Macierz do zamiany.
+*/
+template <typename T>
+void basic_matrix<T>::swap(basic_matrix<T>& m) noexcept {
+    std::swap(data, m.data);
+    std::swap(rows, m.rows);
+    std::swap(cols, m.cols);
+    std::swap(stride, m.stride);
+    std::swap(alloc, m.alloc);
+    external.swap(m.external);
 }
 
 /**
 * \brief Destruktor.
 */
-matrix::~matrix() {
+template <typename T>
+basic_matrix<T>::~basic_matrix() {
     if (data) {
         deallocateMemory();
     }
 }
 
 /**
-* \brief Alokuje pamięć dla macierzy o rozmiarze n.
+* \brief Alokuje pamięć dla macierzy kwadratowej o rozmiarze n.
 * \param n Rozmiar macierzy.
 * \return Referencja do obiektu macierzy.
 */
-matrix& matrix::allocate(int n) {
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::allocate(int n) {
+    return allocate(n, n);
+}
+
+/**
+* \brief Alokuje pamięć dla macierzy r x c; przy zgodnych wymiarach zachowuje bufor.
+* \param r Liczba wierszy.
+* \param c Liczba kolumn.
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::allocate(int r, int c) {
     if (data != nullptr) {
-        if (size != n) {
+        if (rows != r || cols != c) {
             deallocateMemory();
-            size = n;
-            allocateMemory(n);
+            rows = r;
+            cols = c;
+            allocateMemory(r, c);
         }
     } else {
-        size = n;
-        allocateMemory(n);
+        rows = r;
+        cols = c;
+        allocateMemory(r, c);
     }
     return *this;
 }
@@ -99,10 +405,11 @@ matrix& matrix::allocate(int n) {
 * \param value Wartość do wstawienia.
 * \return Referencja do obiektu macierzy.
 */
-matrix& matrix::insert(int x, int y, int value) {
-    if (x >= 0 && x < size && y >= 0 && y < size)
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::insert(int x, int y, T value) {
+    if (x >= 0 && x < rows && y >= 0 && y < cols)
     {
-        data[x][y] = value; 
+        rowPtr(x)[y] = value;
     }
     return *this;
 }
@@ -113,38 +420,74 @@ matrix& matrix::insert(int x, int y, int value) {
 * \param y Kolumna.
 * \return Wartość z macierzy.
 */
-int matrix::show(int x, int y) const {
-    if (x >= 0 && x < size && y >= 0 && y < size)
+template <typename T>
+T basic_matrix<T>::show(int x, int y) const {
+    if (x >= 0 && x < rows && y >= 0 && y < cols)
     {
-        return data[x][y];
+        return rowPtr(x)[y];
     }
     return 0;
 }
 
 /**
-* \brief Transponuje macierz.
+* \brief Transponuje macierz (kwadratową w miejscu, prostokątną do nowego bufora).
 * \return Referencja do obiektu macierzy.
 */
-matrix& matrix::transpose() {
-    matrix result(size);
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            result.data[i][j] = data[j][i];
-        }
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::transpose() {
+    MATRIX_SCOPE("transpose", T, 0, 2.0 * rows * cols * sizeof(T));
+    if (rows == cols) {
+        transposition::inPlace(rows, data, stride);
+        return *this;
     }
-    *this = result;
+    basic_matrix result(cols, rows, *alloc);
+    transposition::copy(rows, cols, data, stride, result.data, result.stride);
+    swap(result);
     return *this;
 }
 
+/**
+* \brief Zapisuje transpozycję macierzy do out; alokuje tylko przy niezgodnych wymiarach.
+* \param out Macierz docelowa (różna od *this).
+* \return Referencja do out.
+*/
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::transposeInto(basic_matrix<T>& out) const {
+    if (&out == this) {
+        return out.transpose();
+    }
+    MATRIX_SCOPE("transposeInto", T, 0, 2.0 * rows * cols * sizeof(T));
+    out.allocate(cols, rows);
+    transposition::copy(rows, cols, data, stride, out.data, out.stride);
+    return out;
+}
+
+/**
+* \brief Zapisuje transpozycję macierzy do bufora dostarczonego przez wywołującego.
+* \param out Bufor na cols wierszy po ld elementów (nie może pokrywać się z danymi macierzy).
+* \param ld Odstęp między wierszami bufora w elementach (>= rows).
+*/
+template <typename T>
+void basic_matrix<T>::transposeInto(T* out, int ld) const {
+    MATRIX_SCOPE("transposeInto", T, 0, 2.0 * rows * cols * sizeof(T));
+    transposition::copy(rows, cols, data, stride, out, ld);
+}
+
 /**
 * \brief Losowo wypełnia macierz wartościami od 0 do 9.
 * \return Referencja do obiektu macierzy.
 */
-matrix& matrix::randomize() {
-    srand(time(0));
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            data[i][j] = rand() % 10;
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::randomize() {
+    if (std::is_integral<T>::value) {
+        return randomize(rng::options::uniform(0, 9));
+    }
+    // Dla typów zmiennoprzecinkowych również losowane są liczby całkowite.
+    randomize(rng::options::uniform(0, 10));
+    for (int i = 0; i < rows; ++i) {
+        T* r = rowPtr(i);
+        for (int j = 0; j < cols; ++j) {
+            r[j] = std::floor(r[j]);
         }
     }
     return *this;
@@ -155,25 +498,55 @@ matrix& matrix::randomize() {
 * \param x Liczba elementów do wypełnienia.
 * \return Referencja do obiektu macierzy.
 */
-matrix& matrix::randomize(int x) {
-    srand(time(0));
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::randomize(int x) {
+    if (rows == 0 || cols == 0) {
+        return *this;
+    }
+    rng::xoshiro256 gen(rng::streamKey(rng::getSeed(), rng::nextStream()));
     for (int i = 0; i < x; ++i) {
-        int row = rand() % size;
-        int col = rand() % size;
-        data[row][col] = rand() % 10;
+        const int row = static_cast<int>(gen.below(rows));
+        const int col = static_cast<int>(gen.below(cols));
+        rowPtr(row)[col] = static_cast<T>(gen.below(10));
     }
     return *this;
 }
 
+/**
+* \brief Wypełnia macierz wartościami o zadanym rozkładzie (globalne ziarno, kolejny strumień).
+* \param o Rozkład i generator.
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::randomize(const rng::options& o) {
+    return randomize(o, rng::getSeed(), rng::nextStream());
+}
+
+/**
+* \brief Wypełnia macierz powtarzalnie: wynik zależy tylko od o, seed i stream.
+* \param o Rozkład i generator.
+* \param seed Ziarno.
+* \param stream Numer strumienia.
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::randomize(const rng::options& o, std::uint64_t seed, std::uint64_t stream) {
+    MATRIX_SCOPE("randomize", T, 0, 1.0 * rows * cols * sizeof(T));
+    rng::fill(data, rows, cols, stride, o, seed, stream);
+    return *this;
+}
+
 /**
 * \brief Ustawia wartości na przekątnej macierzy.
 * \param t Tablica wartości do ustawienia na przekątnej.
 * \return Referencja do obiektu macierzy.
 */
-matrix& matrix::diagonal(int* t) {
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::diagonal(const T* t) {
     writeZeros();
-    for (int i = 0; i < size; ++i) {
-        data[i][i] = t[i];
+    const int n = rows < cols ? rows : cols;
+    for (int i = 0; i < n; ++i) {
+        rowPtr(i)[i] = t[i];
     }
     return *this;
 }
@@ -184,15 +557,16 @@ matrix& matrix::diagonal(int* t) {
 * \param t Tablica wartości do ustawienia na przekątnej.
 * \return Referencja do obiektu macierzy.
 */
-matrix& matrix::diagonal_k(int k, int* t) {
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::diagonal_k(int k, const T* t) {
     writeZeros();
     if (k > 0) {
-        for (int i = 0; i < size - k; ++i) {
-            data[i][i + k] = t[i];
+        for (int i = 0; i < rows && i + k < cols; ++i) {
+            rowPtr(i)[i + k] = t[i];
         }
     } else {
-        for (int i = 0; i < size + k; ++i) {
-            data[i - k][i] = t[i];
+        for (int i = 0; i - k < rows && i < cols; ++i) {
+            rowPtr(i - k)[i] = t[i];
         }
     }
     return *this;
@@ -201,12 +575,13 @@ matrix& matrix::diagonal_k(int k, int* t) {
 /**
 * \brief Ustawia wartości w kolumnie x.
 * \param x Numer kolumny.
-* \param t Tablica wartości do ustawienia w kolumnie.
+* \param t Tablica rows wartości do ustawienia w kolumnie.
 * \return Referencja do obiektu macierzy.
 */
-matrix& matrix::column(int x, int* t) {
-    for (int i = 0; i < size; ++i) {
-        data[i][x] = t[i];
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::column(int x, const T* t) {
+    for (int i = 0; i < rows; ++i) {
+        rowPtr(i)[x] = t[i];
     }
     return *this;
 }
@@ -214,13 +589,12 @@ matrix& matrix::column(int x, int* t) {
 /**
 * \brief Ustawia wartości w wierszu y.
 * \param y Numer wiersza.
-* \param t Tablica wartości do ustawienia w wierszu.
+* \param t Tablica cols wartości do ustawienia w wierszu.
 * \return Referencja do obiektu macierzy.
 */
-matrix& matrix::row(int y, int* t) {
-    for (int i = 0; i < size; ++i) {
-        data[y][i] = t[i];
-    }
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::row(int y, const T* t) {
+    std::memcpy(rowPtr(y), t, cols * sizeof(T));
     return *this;
 }
 
@@ -228,10 +602,12 @@ matrix& matrix::row(int y, int* t) {
 * \brief Ustawia wartości na głównej przekątnej macierzy na 1.
 * \return Referencja do obiektu macierzy.
 */
-matrix& matrix::diagonal() {
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::diagonal() {
     writeZeros();
-    for (int i = 0; i < size; ++i) {
-        data[i][i] = 1;
+    const int n = rows < cols ? rows : cols;
+    for (int i = 0; i < n; ++i) {
+        rowPtr(i)[i] = 1;
     }
     return *this;
 }
@@ -240,11 +616,13 @@ matrix& matrix::diagonal() {
 * \brief Ustawia wartości na podprzekątnej macierzy na 1.
 * \return Referencja do obiektu macierzy.
 */
-matrix& matrix::sub_diagonal() {
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::sub_diagonal() {
     writeZeros();
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j <= i; ++j) {
-            data[i][j] = 1;
+    for (int i = 0; i < rows; ++i) {
+        T* r = rowPtr(i);
+        for (int j = 0; j <= i && j < cols; ++j) {
+            r[j] = 1;
         }
     }
     return *this;
@@ -254,11 +632,13 @@ matrix& matrix::sub_diagonal() {
 * \brief Ustawia wartości na nadprzekątnej macierzy na 1.
 * \return Referencja do obiektu macierzy.
 */
-matrix& matrix::super_diagonal() {
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::super_diagonal() {
     writeZeros();
-    for (int i = 0; i < size; ++i) {
-        for (int j = i; j < size; ++j) {
-            data[i][j] = 1;
+    for (int i = 0; i < rows; ++i) {
+        T* r = rowPtr(i);
+        for (int j = i; j < cols; ++j) {
+            r[j] = 1;
         }
     }
     return *this;
@@ -268,150 +648,327 @@ matrix& matrix::super_diagonal() {
 * \brief Wypełnia macierz wzorem szachownicy.
 * \return Referencja do obiektu macierzy.
 */
-matrix& matrix::checkerboard() {
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            data[i][j] = (i + j) % 2;
-        }
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::checkerboard() {
+    const simd::kernels<T>& k = simd::active<T>();
+    for (int i = 0; i < rows; ++i) {
+        k.alternate(rowPtr(i), cols, i % 2);
     }
     return *this;
 }
 
 /**
 * \brief Operator dodawania macierzy.
-* \param m Macierz do dodania.
+* \param m Macierz do dodania (o tych samych wymiarach).
 * \return Referencja do obiektu macierzy.
 */
-matrix& matrix::operator+(const matrix& m) {
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            data[i][j] += m.data[i][j];
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::operator+(const basic_matrix<T>& m) {
+    if (rows != m.rows || cols != m.cols) {
+        throw std::invalid_argument("matrix addition: shape mismatch");
+    }
+    MATRIX_SCOPE("operator+", T, 1.0 * rows * cols, 3.0 * rows * cols * sizeof(T));
+    for (int i = 0; i < rows; ++i) {
+        T* r = rowPtr(i);
+        const T* s = m.rowPtr(i);
+        for (int j = 0; j < cols; ++j) {
+            r[j] += s[j];
         }
     }
     return *this;
 }
 
 /**
-* \brief Operator mnożenia macierzy.
+* \brief Operator mnożenia macierzy (M x K) * (K x N); wynik M x N zastępuje *this.
 * \param m Macierz do pomnożenia.
 * \return Referencja do obiektu macierzy.
 */
-matrix& matrix::operator*(const matrix& m) {
-    if (size == m.size)
-    {
-        matrix result(size);
-        for (int i = 0; i < size; ++i) {
-            for (int j = 0; j < size; ++j) {
-                for (int k = 0; k < size; ++k) {
-                    result.data[i][j] += data[i][k] * m.data[k][j];
-                }
-            }
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::operator*(const basic_matrix<T>& m) {
+    if (cols != m.rows) {
+        throw std::invalid_argument("matrix multiplication: inner dimensions differ");
+    }
+    MATRIX_SCOPE("operator*", T, 2.0 * rows * cols * m.cols, (1.0 * rows * cols + 1.0 * m.rows * m.cols + 1.0 * rows * m.cols) * sizeof(T));
+    basic_matrix result(rows, m.cols, *alloc);
+    gemm::multiply(rows, m.cols, cols, data, stride, m.data, m.stride, result.data, result.stride);
+    if (external && result.cols == cols) {
+        // Bufor zewnętrzny (wrap, adopt, map) zostaje przy macierzy, gdy wymiary się nie zmieniają.
+        for (int i = 0; i < rows; ++i) {
+            std::memcpy(rowPtr(i), result.rowPtr(i), cols * sizeof(T));
         }
-        *this = result;
+    } else {
+        swap(result);
     }
     return *this;
 }
 
 /**
-* \brief Operator dodawania liczby do macierzy.
-* \param a Liczba do dodania.
-* \return Referencja do obiektu macierzy.
+* \brief Iloczyn macierzy z akumulacją w typie Acc (np. int8_t -> int32_t).
+* \param m Macierz do pomnożenia.
+* \return Nowa macierz *this * m o elementach typu Acc.
 */
-matrix& matrix::operator+(int a) {
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            data[i][j] += a;
+template <typename T>
+template <typename Acc>
+basic_matrix<Acc> basic_matrix<T>::product(const basic_matrix<T>& m) const {
+    if (cols != m.rows) {
+        throw std::invalid_argument("matrix multiplication: inner dimensions differ");
+    }
+    MATRIX_SCOPE("product", T, 2.0 * rows * cols * m.cols, (1.0 * rows * cols + 1.0 * m.rows * m.cols) * sizeof(T) + 1.0 * rows * m.cols * sizeof(Acc));
+    basic_matrix<Acc> result(rows, m.cols);
+    gemm::multiply<T, Acc>(rows, m.cols, cols, data, stride, m.data, m.stride, result.data, result.stride);
+    return result;
+}
+
+/**
+* \brief Liczba mnożeń wykonywanych przy potęgowaniu do wykładnika k.
+* \param k Wykładnik.
+* \return Liczba podniesień do kwadratu i mnożeń wyniku.
+*/
+#if defined(MATRIX_INSTRUMENT)
+static int powerSteps(unsigned long long k) {
+    int steps = -1;
+    for (unsigned long long b = k; b > 0; b >>= 1) {
+        steps += 1 + static_cast<int>(b & 1);
+    }
+    return k == 0 ? 0 : steps - 1;
+}
+#endif
+
+/**
+* \brief Podnosi macierz do potęgi: wynik w result, base niszczona.
+*
+* Używa jedynie buforów base, result i tmp, zamienianych miejscami po
+* każdym mnożeniu.
+* \param k Wykładnik (> 0).
+* \param base Podstawa.
+* \param result Bufor wyniku.
+* \param tmp Bufor pomocniczy.
+* \param multiply Mnożenie c = a * b (c różne od a i b).
+* \param copy Kopiowanie dst = src.
+*/
+template <typename M, typename Multiply, typename Copy>
+static void power(unsigned long long k, M& base, M& result, M& tmp, Multiply multiply, Copy copy) {
+    bool started = false;
+    for (;;) {
+        if (k & 1) {
+            if (started) {
+                multiply(result, base, tmp);
+                std::swap(result, tmp);
+            } else {
+                copy(result, base);
+                started = true;
+            }
         }
+        k >>= 1;
+        if (k == 0) {
+            break;
+        }
+        multiply(base, base, tmp);
+        std::swap(base, tmp);
     }
-    return *this;
 }
 
 /**
-* \brief Operator mnożenia macierzy przez liczbę.
-* \param a Liczba do pomnożenia.
+* \brief Mnoży kwadratowe macierze int64_t o elementach z [0, p): c = a * b mod p.
+*
+* Gdy n * (p - 1)^2 mieści się w int64_t, wystarcza jedno mnożenie. W
+* przeciwnym razie b dzielone jest na części 16-bitowe (b = hi * 2^16 + lo),
+* a wspólny wymiar - na odcinki, w których sumy iloczynów nie przekraczają
+* zakresu.
+* \param n Rozmiar.
+* \param a Lewy czynnik (n x n, odstęp n).
+* \param b Prawy czynnik.
+* \param c Wynik (różny od a i b).
+* \param scratch Bufor 4 * n * n elementów.
+* \param p Moduł.
+*/
+static void multiplyModulo(int n, const std::int64_t* a, const std::int64_t* b, std::int64_t* c, std::int64_t* scratch, std::int64_t p) {
+    const std::size_t size = static_cast<std::size_t>(n) * n;
+    const std::uint64_t m = static_cast<std::uint64_t>(p - 1);
+    if (m == 0 || m * m <= static_cast<std::uint64_t>(INT64_MAX) / n) {
+        gemm::multiply<std::int64_t>(n, n, n, a, n, b, n, c, n);
+        for (std::size_t i = 0; i < size; ++i) {
+            c[i] %= p;
+        }
+        return;
+    }
+    std::int64_t* lo = scratch;
+    std::int64_t* hi = lo + size;
+    std::int64_t* part = hi + size;
+    std::int64_t* high = part + size;
+    for (std::size_t i = 0; i < size; ++i) {
+        lo[i] = b[i] & 0xFFFF;
+        hi[i] = b[i] >> 16;
+        c[i] = 0;
+        high[i] = 0;
+    }
+    const int kc = static_cast<int>(std::min<std::uint64_t>(n, static_cast<std::uint64_t>(INT64_MAX) / (m * 0xFFFF)));
+    for (int k0 = 0; k0 < n; k0 += kc) {
+        const int kd = std::min(kc, n - k0);
+        gemm::multiply<std::int64_t>(n, n, kd, a + k0, n, lo + static_cast<std::size_t>(k0) * n, n, part, n);
+        for (std::size_t i = 0; i < size; ++i) {
+            c[i] = (c[i] + part[i] % p) % p;
+        }
+        gemm::multiply<std::int64_t>(n, n, kd, a + k0, n, hi + static_cast<std::size_t>(k0) * n, n, part, n);
+        for (std::size_t i = 0; i < size; ++i) {
+            high[i] = (high[i] + part[i] % p) % p;
+        }
+    }
+    for (std::size_t i = 0; i < size; ++i) {
+        c[i] = ((high[i] << 16) + c[i]) % p;
+    }
+}
+
+/**
+* \brief Podnosi macierz kwadratową do potęgi k (potęgowanie przez podnoszenie do kwadratu).
+* \param k Wykładnik.
 * \return Referencja do obiektu macierzy.
 */
-matrix& matrix::operator*(int a) {
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            data[i][j] *= a;
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::pow(unsigned long long k) {
+    if (rows != cols) {
+        throw std::invalid_argument("matrix power: matrix is not square");
+    }
+    if (rows == 0) {
+        return *this;
+    }
+    MATRIX_SCOPE("pow", T, 2.0 * rows * rows * rows * powerSteps(k), 3.0 * rows * rows * sizeof(T) * powerSteps(k));
+    if (k == 0) {
+        return diagonal();
+    }
+    if (k == 1) {
+        return *this;
+    }
+    const int n = rows;
+    auto copy = [n](basic_matrix& dst, const basic_matrix& src) {
+        for (int i = 0; i < n; ++i) {
+            std::memcpy(dst.rowPtr(i), src.rowPtr(i), n * sizeof(T));
         }
+    };
+    basic_matrix result(rows, cols, *alloc);
+    basic_matrix tmp(rows, cols, *alloc);
+    // Bufor zewnętrzny (wrap, adopt, map) zostaje przy macierzy: potęgowana jest kopia, a wynik wraca do bufora.
+    const bool attached = static_cast<bool>(external);
+    basic_matrix base(attached ? basic_matrix(rows, cols, *alloc) : std::move(*this));
+    if (attached) {
+        copy(base, *this);
+    }
+    power(k, base, result, tmp,
+        [n](const basic_matrix& x, const basic_matrix& y, basic_matrix& z) {
+            gemm::multiply(n, n, n, x.data, x.stride, y.data, y.stride, z.data, z.stride);
+        },
+        copy);
+    if (attached) {
+        copy(*this, result);
+    } else {
+        swap(result);
     }
     return *this;
 }
 
 /**
-* \brief Operator odejmowania liczby od macierzy.
-* \param a Liczba do odjęcia.
+* \brief Podnosi macierz kwadratową do potęgi k modulo p (tylko typy całkowite).
+* \param k Wykładnik.
+* \param p Moduł (1 <= p <= 2^31).
 * \return Referencja do obiektu macierzy.
 */
-matrix& matrix::operator-(int a) {
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            data[i][j] -= a;
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::pow(unsigned long long k, T p) {
+    if (!std::is_integral<T>::value) {
+        throw std::invalid_argument("matrix power: modulus requires an integer element type");
+    }
+    if (rows != cols) {
+        throw std::invalid_argument("matrix power: matrix is not square");
+    }
+    if (!(p >= 1) || static_cast<double>(p) > 2147483648.0) {
+        throw std::invalid_argument("matrix power: modulus out of range");
+    }
+    if (rows == 0) {
+        return *this;
+    }
+    MATRIX_SCOPE("pow mod", T, 2.0 * rows * rows * rows * powerSteps(k), 3.0 * rows * rows * sizeof(std::int64_t) * powerSteps(k));
+    const int n = rows;
+    const std::int64_t modulus = static_cast<std::int64_t>(p);
+    const std::size_t size = static_cast<std::size_t>(n) * n;
+    // Trzy bufory potęgowania i cztery bufory multiplyModulo().
+    std::vector<std::int64_t> workspace(7 * size);
+    std::int64_t* base = workspace.data();
+    std::int64_t* result = base + size;
+    std::int64_t* tmp = result + size;
+    std::int64_t* scratch = tmp + size;
+    if (k == 0) {
+        for (int i = 0; i < n; ++i) {
+            result[static_cast<std::size_t>(i) * n + i] = 1 % modulus;
+        }
+    } else {
+        for (int i = 0; i < n; ++i) {
+            const T* r = rowPtr(i);
+            for (int j = 0; j < n; ++j) {
+                const std::int64_t v = static_cast<std::int64_t>(r[j]) % modulus;
+                base[static_cast<std::size_t>(i) * n + j] = v < 0 ? v + modulus : v;
+            }
+        }
+        power(k, base, result, tmp,
+            [n, scratch, modulus](const std::int64_t* x, const std::int64_t* y, std::int64_t* z) {
+                multiplyModulo(n, x, y, z, scratch, modulus);
+            },
+            [size](std::int64_t* dst, const std::int64_t* src) {
+                std::memcpy(dst, src, size * sizeof(std::int64_t));
+            });
+    }
+    for (int i = 0; i < n; ++i) {
+        T* r = rowPtr(i);
+        for (int j = 0; j < n; ++j) {
+            r[j] = static_cast<T>(result[static_cast<std::size_t>(i) * n + j]);
         }
     }
     return *this;
 }
 
 /**
-* \brief Operator dodawania liczby do macierzy (przyjaciel).
+* \brief Operator dodawania liczby do macierzy.
 * \param a Liczba do dodania.
-* \param m Macierz.
-* \return Nowa macierz będąca wynikiem dodania.
-*/
-matrix operator+(int a, const matrix& m) {
-    matrix result(m.size);
-    for (int i = 0; i < m.size; ++i) {
-        for (int j = 0; j < m.size; ++j) {
-            result.data[i][j] = a + m.data[i][j];
-        }
-    }
-    return result;
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::operator+(T a) {
+    MATRIX_SCOPE("operator+(scalar)", T, 1.0 * rows * cols, 2.0 * rows * cols * sizeof(T));
+    apply(simd::active<T>().add, *this, a);
+    return *this;
 }
 
 /**
-* \brief Operator mnożenia liczby przez macierz (przyjaciel).
+* \brief Operator mnożenia macierzy przez liczbę.
 * \param a Liczba do pomnożenia.
-* \param m Macierz.
-* \return Nowa macierz będąca wynikiem mnożenia.
-*/
-matrix operator*(int a, const matrix& m) {
-    matrix result(m.size);
-    for (int i = 0; i < m.size; ++i) {
-        for (int j = 0; j < m.size; ++j) {
-            result.data[i][j] = a * m.data[i][j];
-        }
-    }
-    return result;
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::operator*(T a) {
+    MATRIX_SCOPE("operator*(scalar)", T, 1.0 * rows * cols, 2.0 * rows * cols * sizeof(T));
+    apply(simd::active<T>().mul, *this, a);
+    return *this;
 }
 
 /**
-* \brief Operator odejmowania liczby od macierzy (przyjaciel).
+* \brief Operator odejmowania liczby od macierzy.
 * \param a Liczba do odjęcia.
-* \param m Macierz.
-* \return Nowa macierz będąca wynikiem odejmowania.
-*/
-matrix operator-(int a, const matrix& m) {
-    matrix result(m.size);
-    for (int i = 0; i < m.size; ++i) {
-        for (int j = 0; j < m.size; ++j) {
-            result.data[i][j] = a - m.data[i][j];
-        }
-    }
-    return result;
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::operator-(T a) {
+    MATRIX_SCOPE("operator-(scalar)", T, 1.0 * rows * cols, 2.0 * rows * cols * sizeof(T));
+    apply(simd::active<T>().sub, *this, a);
+    return *this;
 }
 
 /**
 * \brief Operator inkrementacji macierzy.
 * \return Referencja do obiektu macierzy.
 */
-matrix& matrix::operator++(int) {
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            ++data[i][j];
-        }
-    }
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::operator++(int) {
+    MATRIX_SCOPE("operator++", T, 1.0 * rows * cols, 2.0 * rows * cols * sizeof(T));
+    apply(simd::active<T>().add, *this, 1);
     return *this;
 }
 
@@ -419,12 +976,10 @@ matrix& matrix::operator++(int) {
 * \brief Operator dekrementacji macierzy.
 * \return Referencja do obiektu macierzy.
 */
-matrix& matrix::operator--(int) {
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            --data[i][j];
-        }
-    }
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::operator--(int) {
+    MATRIX_SCOPE("operator--", T, 1.0 * rows * cols, 2.0 * rows * cols * sizeof(T));
+    apply(simd::active<T>().sub, *this, 1);
     return *this;
 }
 
@@ -433,9 +988,9 @@ matrix& matrix::operator--(int) {
 * \param a Liczba do dodania.
 * \return Referencja do obiektu macierzy.
 */
-matrix& matrix::operator+=(int a) {
-    *this = *this + a;
-    return *this;
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::operator+=(T a) {
+    return operator+(a);
 }
 
 /**
@@ -443,9 +998,9 @@ matrix& matrix::operator+=(int a) {
 * \param a Liczba do odjęcia.
 * \return Referencja do obiektu macierzy.
 */
-matrix& matrix::operator-=(int a) {
-    *this = *this - a;
-    return *this;
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::operator-=(T a) {
+    return operator-(a);
 }
 
 /**
@@ -453,9 +1008,9 @@ matrix& matrix::operator-=(int a) {
 * \param a Liczba do pomnożenia.
 * \return Referencja do obiektu macierzy.
 */
-matrix& matrix::operator*=(int a) {
-    *this = *this * a;
-    return *this;
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::operator*=(T a) {
+    return operator*(a);
 }
 
 /**
@@ -463,13 +1018,10 @@ matrix& matrix::operator*=(int a) {
 * \param value Wartość do dodania.
 * \return Referencja do obiektu macierzy.
 */
-matrix& matrix::operator()(double value) {
-    int intPart = static_cast<int>(value);
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            data[i][j] += intPart;
-        }
-    }
+template <typename T>
+basic_matrix<T>& basic_matrix<T>::operator()(double value) {
+    MATRIX_SCOPE("operator()", T, 1.0 * rows * cols, 2.0 * rows * cols * sizeof(T));
+    apply(simd::active<T>().add, *this, static_cast<T>(value));
     return *this;
 }
 
@@ -479,13 +1031,10 @@ matrix& matrix::operator()(double value) {
 * \param m Macierz do wyświetlenia.
 * \return Strumień wyjściowy.
 */
-std::ostream& operator<<(std::ostream& o, const matrix& m) {
-    for (int i = 0; i < m.size; ++i) {
-        for (int j = 0; j < m.size; ++j) {
-            o << m.data[i][j] << ' ';
-        }
-        o << std::endl;
-    }
+template <typename T>
+std::ostream& operator<<(std::ostream& o, const basic_matrix<T>& m) {
+    MATRIX_SCOPE("operator<<", T, 0, 1.0 * m.getRows() * m.getCols() * sizeof(T));
+    matrix_text<T>::write(m, o);
     return o;
 }
 
@@ -494,12 +1043,12 @@ std::ostream& operator<<(std::ostream& o, const matrix& m) {
 * \param m Macierz do porównania.
 * \return true jeśli macierze są równe, false w przeciwnym razie.
 */
-bool matrix::operator==(const matrix& m) const {
-    if (size != m.size) return false;
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            if (data[i][j] != m.data[i][j]) return false;
-        }
+template <typename T>
+bool basic_matrix<T>::operator==(const basic_matrix<T>& m) const {
+    if (rows != m.rows || cols != m.cols) return false;
+    MATRIX_SCOPE("operator==", T, 0, 2.0 * rows * cols * sizeof(T));
+    for (int i = 0; i < rows; ++i) {
+        if (std::memcmp(rowPtr(i), m.rowPtr(i), cols * sizeof(T)) != 0) return false;
     }
     return true;
 }
@@ -509,11 +1058,15 @@ bool matrix::operator==(const matrix& m) const {
 * \param m Macierz do porównania.
 * \return true jeśli macierz jest większa, false w przeciwnym razie.
 */
-bool matrix::operator>(const matrix& m) const {
-    if (size != m.size) return false;
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            if (data[i][j] <= m.data[i][j]) return false;
+template <typename T>
+bool basic_matrix<T>::operator>(const basic_matrix<T>& m) const {
+    if (rows != m.rows || cols != m.cols) return false;
+    MATRIX_SCOPE("operator>", T, 0, 2.0 * rows * cols * sizeof(T));
+    for (int i = 0; i < rows; ++i) {
+        const T* r = rowPtr(i);
+        const T* s = m.rowPtr(i);
+        for (int j = 0; j < cols; ++j) {
+            if (r[j] <= s[j]) return false;
         }
     }
     return true;
@@ -524,11 +1077,15 @@ bool matrix::operator>(const matrix& m) const {
 * \param m Macierz do porównania.
 * \return true jeśli macierz jest mniejsza, false w przeciwnym razie.
 */
-bool matrix::operator<(const matrix& m) const {
-    if (size != m.size) return false;
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            if (data[i][j] >= m.data[i][j]) return false;
+template <typename T>
+bool basic_matrix<T>::operator<(const basic_matrix<T>& m) const {
+    if (rows != m.rows || cols != m.cols) return false;
+    MATRIX_SCOPE("operator<", T, 0, 2.0 * rows * cols * sizeof(T));
+    for (int i = 0; i < rows; ++i) {
+        const T* r = rowPtr(i);
+        const T* s = m.rowPtr(i);
+        for (int j = 0; j < cols; ++j) {
+            if (r[j] >= s[j]) return false;
         }
     }
     return true;
@@ -537,10 +1094,39 @@ bool matrix::operator<(const matrix& m) const {
 /**
 * \brief Wypełnia macierz zerami.
 */
-void matrix::writeZeros() {
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            data[i][j] = 0;
-        }
+template <typename T>
+void basic_matrix<T>::writeZeros() {
+    const simd::kernels<T>& k = simd::active<T>();
+    if (stride == cols) {
+        k.fill(data, static_cast<std::size_t>(rows) * cols, 0);
+        return;
+    }
+    for (int i = 0; i < rows; ++i) {
+        k.fill(rowPtr(i), cols, 0);
     }
-}
\ No newline at end of file
+}
+
+template class basic_matrix<std::int8_t>;
+template class basic_matrix<std::int16_t>;
+template class basic_matrix<std::int32_t>;
+template class basic_matrix<std::int64_t>;
+template class basic_matrix<float>;
+template class basic_matrix<double>;
+
+template std::ostream& operator<<(std::ostream&, const basic_matrix<std::int8_t>&);
+template std::ostream& operator<<(std::ostream&, const basic_matrix<std::int16_t>&);
+template std::ostream& operator<<(std::ostream&, const basic_matrix<std::int32_t>&);
+template std::ostream& operator<<(std::ostream&, const basic_matrix<std::int64_t>&);
+template std::ostream& operator<<(std::ostream&, const basic_matrix<float>&);
+template std::ostream& operator<<(std::ostream&, const basic_matrix<double>&);
+
+template basic_matrix<std::int8_t> basic_matrix<std::int8_t>::product<std::int8_t>(const basic_matrix<std::int8_t>&) const;
+template basic_matrix<std::int16_t> basic_matrix<std::int16_t>::product<std::int16_t>(const basic_matrix<std::int16_t>&) const;
+template basic_matrix<std::int32_t> basic_matrix<std::int32_t>::product<std::int32_t>(const basic_matrix<std::int32_t>&) const;
+template basic_matrix<std::int64_t> basic_matrix<std::int64_t>::product<std::int64_t>(const basic_matrix<std::int64_t>&) const;
+template basic_matrix<float> basic_matrix<float>::product<float>(const basic_matrix<float>&) const;
+template basic_matrix<double> basic_matrix<double>::product<double>(const basic_matrix<double>&) const;
+template basic_matrix<std::int32_t> basic_matrix<std::int8_t>::product<std::int32_t>(const basic_matrix<std::int8_t>&) const;
+template basic_matrix<std::int32_t> basic_matrix<std::int16_t>::product<std::int32_t>(const basic_matrix<std::int16_t>&) const;
+template basic_matrix<std::int64_t> basic_matrix<std::int32_t>::product<std::int64_t>(const basic_matrix<std::int32_t>&) const;
+template basic_matrix<double> basic_matrix<float>::product<double>(const basic_matrix<float>&) const;
\ No newline at end of file
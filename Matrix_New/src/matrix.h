@@ -1,20 +1,115 @@
 ﻿#pragma once
 #include <iostream>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include "memory.h"
+#include "rng.h"
+#include "simd.h"
+
+template <typename E> struct matrix_expr;
+template <typename T> class matrix_ref;
+template <typename T> class sparse_matrix;
+template <typename T> class band_matrix;
+template <typename T> class triangular_matrix;
+template <typename T> class matrix_file;
+template <typename T> class matrix_text;
+template <typename T> class tiled_matrix;
+template <typename T> class basic_vector;
+template <typename T> class matrix_view;
 
 /**
- * \class matrix
- * \brief Klasa reprezentująca macierz.
+ * \class basic_matrix
+ * \brief Klasa reprezentująca macierz rows x cols o elementach typu T.
+ *
+ * Jawnie konkretyzowana dla int8_t, int16_t, int32_t, int64_t, float
+ * i double; matrix to basic_matrix<int>.
  */
-class matrix {
+template <typename T>
+class basic_matrix {
+    public:
+        typedef T value_type; ///< Typ elementu.
+
+        /**
+         * \brief Sposób ułożenia wierszy w buforze.
+         */
+        enum class layout {
+            packed, ///< Wiersze ułożone jeden za drugim (stride == cols).
+            padded  ///< Wiersze wyrównane do linii cache (stride >= cols).
+        };
+
+        static const std::size_t ALIGNMENT = 64; ///< Wyrównanie bufora w bajtach (linia cache / AVX-512).
+        static const int EXPR_BLOCK = 256; ///< Długość fragmentu wiersza wyliczanego naraz przez wyrażenia.
+
     private:
-        int** data;  ///< Wskaźnik na dane macierzy.
-        int size; ///< Rozmiar macierzy.
+        T* data;  ///< Wskaźnik na ciągły, wyrównany bufor danych macierzy (wierszami).
+        int rows; ///< Liczba wierszy.
+        int cols; ///< Liczba kolumn.
+        int stride; ///< Odstęp (w elementach) między początkami kolejnych wierszy.
+        allocator* alloc; ///< Alokator bufora (przy tworzeniu macierzy - currentAllocator(); nowe bufory operacji w miejscu też pochodzą z niego).
+        std::shared_ptr<void> external; ///< Właściciel bufora spoza alloc (np. odwzorowanego pliku); zwalnia go przy usunięciu.
 
         /**
-        * \brief Alokuje pamięć dla macierzy o rozmiarze n.
-        * \param n Rozmiar macierzy.
+         * \brief Konstruktor przejmujący bufor zewnętrzny (bez kopiowania i bez alokacji).
+         * \param buffer Bufor r wierszy po ld elementów.
+         * \param r Liczba wierszy.
+         * \param c Liczba kolumn.
+         * \param ld Odstęp między wierszami bufora w elementach (>= c).
+         * \param owner Obiekt, którego zniszczenie zwalnia bufor.
+         */
+        basic_matrix(T* buffer, int r, int c, int ld, std::shared_ptr<void> owner);
+
+        /**
+        * \brief Alokuje pamięć dla macierzy r x c.
+        * \param r Liczba wierszy.
+        * \param c Liczba kolumn.
+        * \param l Sposób ułożenia wierszy w buforze.
         */
-        void allocateMemory(int n);
+        void allocateMemory(int r, int c, layout l = layout::padded);
+
+        /**
+         * \brief Zwraca wskaźnik na początek wiersza i.
+         * \param i Numer wiersza.
+         * \return Wskaźnik na pierwszy element wiersza.
+         */
+        T* rowPtr(int i) { return data + static_cast<std::ptrdiff_t>(i) * stride; }
+
+        /**
+         * \brief Zwraca wskaźnik na początek wiersza i.
+         * \param i Numer wiersza.
+         * \return Wskaźnik na pierwszy element wiersza.
+         */
+        const T* rowPtr(int i) const { return data + static_cast<std::ptrdiff_t>(i) * stride; }
+
+        /**
+         * \brief Wypełnia macierz wartościami: this[i][j] = kernel(src[i][j], a).
+         *
+         * Gdy obie macierze nie mają dopełnienia wierszy, jądro wywoływane jest
+         * raz dla całego bufora, w przeciwnym razie wiersz po wierszu.
+         * \param kernel Jądro element po elemencie (simd::binaryKernel).
+         * \param src Macierz źródłowa o tych samych wymiarach (może być *this).
+         * \param a Argument skalarny jądra.
+         */
+        void apply(simd::binaryKernel<T> kernel, const basic_matrix& src, T a);
+
+        /**
+         * \brief Wylicza wyrażenie do bufora macierzy fragmentami wierszy.
+         * \param e Węzeł wyrażenia o wymiarach równych wymiarom macierzy.
+         */
+        template <typename E>
+        void evaluate(const E& e);
+
+        template <typename U> friend class matrix_ref;
+        template <typename U> friend class basic_matrix;
+        template <typename U> friend class sparse_matrix;
+        template <typename U> friend class band_matrix;
+        template <typename U> friend class triangular_matrix;
+        template <typename U> friend class matrix_file;
+        template <typename U> friend class matrix_text;
+        template <typename U> friend class tiled_matrix;
+        template <typename U> friend class basic_vector;
+        template <typename U> friend class matrix_view;
     
         /**
          * \brief Zwalnia pamięć zajmowaną przez macierz.
@@ -25,38 +120,253 @@ class matrix {
         /**
          * \brief Konstruktor domyślny.
          */
-        matrix();
+        basic_matrix();
     
         /**
-         * \brief Konstruktor tworzący macierz o rozmiarze n.
+         * \brief Konstruktor tworzący macierz kwadratową o rozmiarze n.
+         * \param n Rozmiar macierzy.
+         */
+        basic_matrix(int n);
+
+        /**
+         * \brief Konstruktor tworzący macierz kwadratową o rozmiarze n i zadanym ułożeniu wierszy.
          * \param n Rozmiar macierzy.
+         * \param l Sposób ułożenia wierszy w buforze.
          */
-        matrix(int n);
+        basic_matrix(int n, layout l);
     
         /**
-         * \brief Konstruktor tworzący macierz o rozmiarze n i inicjalizujący ją wartościami z tablicy t.
+         * \brief Konstruktor tworzący macierz kwadratową o rozmiarze n i inicjalizujący ją wartościami z tablicy t.
          * \param n Rozmiar macierzy.
-         * \param t Tablica wartości do inicjalizacji macierzy.
+         * \param t Tablica n * n wartości (wierszami) do inicjalizacji macierzy.
+         */
+        basic_matrix(int n, const T* t);
+
+        /**
+         * \brief Konstruktor tworzący macierz r x c.
+         * \param r Liczba wierszy.
+         * \param c Liczba kolumn.
+         */
+        basic_matrix(int r, int c);
+
+        /**
+         * \brief Konstruktor tworzący macierz r x c o zadanym ułożeniu wierszy.
+         * \param r Liczba wierszy.
+         * \param c Liczba kolumn.
+         * \param l Sposób ułożenia wierszy w buforze.
+         */
+        basic_matrix(int r, int c, layout l);
+
+        /**
+         * \brief Konstruktor tworzący macierz r x c i inicjalizujący ją wartościami z tablicy t.
+         * \param r Liczba wierszy.
+         * \param c Liczba kolumn.
+         * \param t Tablica r * c wartości (wierszami) do inicjalizacji macierzy.
+         */
+        basic_matrix(int r, int c, const T* t);
+
+        /**
+         * \brief Konstruktor tworzący macierz r x c w pamięci z podanego alokatora.
+         * \param r Liczba wierszy.
+         * \param c Liczba kolumn.
+         * \param a Alokator bufora; musi przeżyć macierz.
+         */
+        basic_matrix(int r, int c, allocator& a);
+
+        /**
+         * \brief Tworzy macierz na buforze wywołującego bez kopiowania; bufor nie jest zwalniany.
+         *
+         * Wywołujący odpowiada za to, żeby bufor przeżył macierz. Operacje
+         * w miejscu zapisują wyniki w buforze, a zmiana wymiarów (allocate,
+         * transpose macierzy prostokątnej, przypisanie macierzy o innych
+         * wymiarach) odłącza macierz od bufora.
+         * \param buffer Bufor r wierszy po ld elementów.
+         * \param r Liczba wierszy.
+         * \param c Liczba kolumn.
+         * \param ld Odstęp między wierszami bufora w elementach (0 - równy c).
+         * \return Macierz operująca na buforze.
+         * \throw std::invalid_argument Przy ujemnych wymiarach, ld < c lub pustym wskaźniku dla niepustej macierzy.
+         */
+        static basic_matrix wrap(T* buffer, int r, int c, int ld = 0);
+
+        /**
+         * \brief Tworzy macierz przejmującą bufor wywołującego bez kopiowania.
+         *
+         * Bufor zwalniany jest funkcją deleter, gdy przestanie go używać
+         * macierz oraz wszystkie wskaźniki zwrócone przez shareData().
+         * \param buffer Bufor r wierszy po ld elementów.
+         * \param r Liczba wierszy.
+         * \param c Liczba kolumn.
+         * \param ld Odstęp między wierszami bufora w elementach (0 - równy c).
+         * \param deleter Funkcja zwalniająca bufor (domyślnie delete[]).
+         * \return Macierz będąca właścicielem bufora.
+         * \throw std::invalid_argument Przy ujemnych wymiarach, ld < c lub pustym wskaźniku dla niepustej macierzy.
+         */
+        static basic_matrix adopt(T* buffer, int r, int c, int ld = 0, std::function<void(T*)> deleter = std::default_delete<T[]>());
+
+        /**
+         * \brief Tworzy macierz współdzielącą bufor z innymi właścicielami bez kopiowania.
+         * \param buffer Współdzielony bufor r wierszy po ld elementów.
+         * \param r Liczba wierszy.
+         * \param c Liczba kolumn.
+         * \param ld Odstęp między wierszami bufora w elementach (0 - równy c).
+         * \return Macierz współwłaściciel bufora.
+         * \throw std::invalid_argument Przy ujemnych wymiarach, ld < c lub pustym wskaźniku dla niepustej macierzy.
          */
-        matrix(int n, int* t);
+        static basic_matrix adopt(std::shared_ptr<T> buffer, int r, int c, int ld = 0);
 
         /**
          * \brief Konstruktor kopiujący.
          * \param m Obiekt macierzy do skopiowania.
          */
-        matrix(const matrix& m);
+        basic_matrix(const basic_matrix& m);
+
+        /**
+         * \brief Konstruktor przenoszący.
+         * \param m Obiekt macierzy, którego bufor zostanie przejęty.
+         */
+        basic_matrix(basic_matrix&& m) noexcept;
+
+        /**
+         * \brief Kopiujący operator przypisania.
+         * \param m Obiekt macierzy do skopiowania.
+         * \return Referencja do obiektu macierzy.
+         */
+        basic_matrix& operator=(const basic_matrix& m);
+
+        /**
+         * \brief Przenoszący operator przypisania.
+         * \param m Obiekt macierzy, którego bufor zostanie przejęty.
+         * \return Referencja do obiektu macierzy.
+         */
+        basic_matrix& operator=(basic_matrix&& m) noexcept;
+
+        /**
+         * \brief Zamienia zawartość dwóch macierzy bez kopiowania danych.
+         * \param m Macierz do zamiany.
+         */
+        void swap(basic_matrix& m) noexcept;
+
+        /**
+         * \brief Konstruktor wyliczający wyrażenie (jednym przejściem, bez macierzy pośrednich).
+         * \param e Wyrażenie.
+         */
+        template <typename E>
+        basic_matrix(const matrix_expr<E>& e);
+
+        /**
+         * \brief Przypisanie wyrażenia; przy zgodnych wymiarach wynik zapisywany jest w miejscu.
+         * \param e Wyrażenie.
+         * \return Referencja do obiektu macierzy.
+         */
+        template <typename E>
+        basic_matrix& operator=(const matrix_expr<E>& e);
     
         /**
          * \brief Destruktor.
          */
-        ~matrix();
+        ~basic_matrix();
 
         /**
-         * \brief Alokuje pamięć dla macierzy o rozmiarze n.
+         * \brief Alokuje pamięć dla macierzy kwadratowej o rozmiarze n.
          * \param n Rozmiar macierzy.
          * \return Referencja do obiektu macierzy.
          */
-        matrix& allocate(int n);
+        basic_matrix& allocate(int n);
+
+        /**
+         * \brief Alokuje pamięć dla macierzy r x c; przy zgodnych wymiarach zachowuje bufor.
+         * \param r Liczba wierszy.
+         * \param c Liczba kolumn.
+         * \return Referencja do obiektu macierzy.
+         */
+        basic_matrix& allocate(int r, int c);
+
+        /**
+         * \brief Zwraca rozmiar macierzy kwadratowej (liczbę wierszy).
+         * \return Rozmiar macierzy.
+         */
+        int getSize() const { return rows; }
+
+        /**
+         * \brief Zwraca liczbę wierszy.
+         * \return Liczba wierszy.
+         */
+        int getRows() const { return rows; }
+
+        /**
+         * \brief Zwraca liczbę kolumn.
+         * \return Liczba kolumn.
+         */
+        int getCols() const { return cols; }
+
+        /**
+         * \brief Zwraca wiodący wymiar bufora (odstęp między wierszami w elementach).
+         * \return Wiodący wymiar bufora.
+         */
+        int getStride() const { return stride; }
+
+        /**
+         * \brief Zwraca wskaźnik na bufor macierzy (wiersze co getStride() elementów), bez kopiowania.
+         * \return Wskaźnik na element (0, 0); ważny do zmiany wymiarów lub zniszczenia macierzy.
+         */
+        T* getData() { return data; }
+
+        /**
+         * \brief Zwraca wskaźnik na bufor macierzy (wiersze co getStride() elementów), bez kopiowania.
+         * \return Wskaźnik na element (0, 0); ważny do zmiany wymiarów lub zniszczenia macierzy.
+         */
+        const T* getData() const { return data; }
+
+        /**
+         * \brief Udostępnia bufor macierzy ze współdzieloną własnością, bez kopiowania.
+         *
+         * Bufor pozostaje ważny, dopóki istnieje macierz lub którykolwiek
+         * zwrócony wskaźnik, także po zmianie wymiarów macierzy. Dla macierzy
+         * utworzonej przez wrap() wskaźnik nie przedłuża życia bufora.
+         * \return Wskaźnik na element (0, 0) (pusty dla macierzy bez bufora).
+         */
+        std::shared_ptr<T> shareData();
+
+        /**
+         * \brief Zwraca alokator bufora macierzy.
+         * \return Referencja do alokatora.
+         */
+        allocator& getAllocator() const { return *alloc; }
+
+        /**
+         * \brief Zwraca widok całej macierzy (bez kopiowania).
+         * \return Widok rows x cols.
+         */
+        matrix_view<T> view();
+
+        /**
+         * \brief Zwraca widok całej macierzy tylko do odczytu (bez kopiowania).
+         * \return Widok rows x cols.
+         */
+        matrix_view<const T> view() const;
+
+        /**
+         * \brief Zwraca widok bloku r x c zaczynającego się w (r0, c0) (bez kopiowania).
+         * \param r0 Pierwszy wiersz.
+         * \param c0 Pierwsza kolumna.
+         * \param r Liczba wierszy.
+         * \param c Liczba kolumn.
+         * \return Widok bloku.
+         * \throw std::out_of_range Gdy blok wychodzi poza macierz.
+         */
+        matrix_view<T> block(int r0, int c0, int r, int c);
+
+        /**
+         * \brief Zwraca widok bloku r x c tylko do odczytu (bez kopiowania).
+         * \param r0 Pierwszy wiersz.
+         * \param c0 Pierwsza kolumna.
+         * \param r Liczba wierszy.
+         * \param c Liczba kolumn.
+         * \return Widok bloku.
+         * \throw std::out_of_range Gdy blok wychodzi poza macierz.
+         */
+        matrix_view<const T> block(int r0, int c0, int r, int c) const;
 
         /**
          * \brief Wstawia wartość do macierzy na pozycję (x, y).
@@ -65,7 +375,7 @@ class matrix {
          * \param value Wartość do wstawienia.
          * \return Referencja do obiektu macierzy.
          */
-        matrix& insert(int x, int y, int value);
+        basic_matrix& insert(int x, int y, T value);
 
         /**
          * \brief Zwraca wartość z macierzy na pozycji (x, y).
@@ -73,33 +383,72 @@ class matrix {
          * \param y Kolumna.
          * \return Wartość z macierzy.
          */
-        int show(int x, int y) const;
+        T show(int x, int y) const;
 
         /**
          * \brief Transponuje macierz.
+         *
+         * Macierz kwadratowa transponowana jest w miejscu (blokowo, bez
+         * dodatkowej pamięci), prostokątna - do nowego bufora c x r.
          * \return Referencja do obiektu macierzy.
          */
-        matrix& transpose();
+        basic_matrix& transpose();
+
+        /**
+         * \brief Zapisuje transpozycję macierzy do out; alokuje tylko przy niezgodnych wymiarach.
+         * \param out Macierz docelowa (różna od *this).
+         * \return Referencja do out.
+         */
+        basic_matrix& transposeInto(basic_matrix& out) const;
+
+        /**
+         * \brief Zapisuje transpozycję macierzy do bufora dostarczonego przez wywołującego.
+         * \param out Bufor na cols wierszy po ld elementów (nie może pokrywać się z danymi macierzy).
+         * \param ld Odstęp między wierszami bufora w elementach (>= rows).
+         */
+        void transposeInto(T* out, int ld) const;
 
         /**
          * \brief Losowo wypełnia macierz wartościami od 0 do 9.
+         *
+         * Używa globalnego ziarna rng::getSeed() i kolejnego strumienia
+         * rng::nextStream(), więc kolejne wywołania dają różne macierze,
+         * a po rng::setSeed() - powtarzalny ciąg.
          * \return Referencja do obiektu macierzy.
          */
-        matrix& randomize();
+        basic_matrix& randomize();
 
         /**
          * \brief Losowo wypełnia x elementów macierzy wartościami od 0 do 9.
          * \param x Liczba elementów do wypełnienia.
          * \return Referencja do obiektu macierzy.
          */
-        matrix& randomize(int x);
+        basic_matrix& randomize(int x);
+
+        /**
+         * \brief Wypełnia macierz wartościami o zadanym rozkładzie (globalne ziarno, kolejny strumień).
+         * \param o Rozkład i generator.
+         * \return Referencja do obiektu macierzy.
+         * \throw std::invalid_argument Przy pustym przedziale lub ujemnym odchyleniu.
+         */
+        basic_matrix& randomize(const rng::options& o);
+
+        /**
+         * \brief Wypełnia macierz powtarzalnie: wynik zależy tylko od o, seed i stream (nie od liczby wątków).
+         * \param o Rozkład i generator.
+         * \param seed Ziarno.
+         * \param stream Numer strumienia.
+         * \return Referencja do obiektu macierzy.
+         * \throw std::invalid_argument Przy pustym przedziale lub ujemnym odchyleniu.
+         */
+        basic_matrix& randomize(const rng::options& o, std::uint64_t seed, std::uint64_t stream = 0);
 
         /**
          * \brief Ustawia wartości na przekątnej macierzy.
          * \param t Tablica wartości do ustawienia na przekątnej.
          * \return Referencja do obiektu macierzy.
          */
-        matrix& diagonal(int* t);
+        basic_matrix& diagonal(const T* t);
 
         /**
          * \brief Ustawia wartości na k-tej przekątnej macierzy.
@@ -107,147 +456,257 @@ class matrix {
          * \param t Tablica wartości do ustawienia na przekątnej.
          * \return Referencja do obiektu macierzy.
          */
-        matrix& diagonal_k(int k, int* t);
+        basic_matrix& diagonal_k(int k, const T* t);
 
         /**
          * \brief Ustawia wartości w kolumnie x.
          * \param x Numer kolumny.
-         * \param t Tablica wartości do ustawienia w kolumnie.
+         * \param t Tablica rows wartości do ustawienia w kolumnie.
          * \return Referencja do obiektu macierzy.
          */
-        matrix& column(int x, int* t);
+        basic_matrix& column(int x, const T* t);
 
         /**
          * \brief Ustawia wartości w wierszu y.
          * \param y Numer wiersza.
-         * \param t Tablica wartości do ustawienia w wierszu.
+         * \param t Tablica cols wartości do ustawienia w wierszu.
          * \return Referencja do obiektu macierzy.
          */
-        matrix& row(int y, int* t);
+        basic_matrix& row(int y, const T* t);
     
         /**
          * \brief Ustawia wartości na głównej przekątnej macierzy na 1.
          * \return Referencja do obiektu macierzy.
          */
-        matrix& diagonal();
+        basic_matrix& diagonal();
     
         /**
          * \brief Ustawia wartości na podprzekątnej macierzy na 1.
          * \return Referencja do obiektu macierzy.
          */
-        matrix& sub_diagonal();
+        basic_matrix& sub_diagonal();
 
         /**
         * \brief Ustawia wartości na nadprzekątnej macierzy na 1.
         * \return Referencja do obiektu macierzy.
         */
-        matrix& super_diagonal();
+        basic_matrix& super_diagonal();
+
+        /**
+         * \brief Tworzy k-tą przekątną r x c od razu w przechowywaniu wstęgowym (definicja w band.h).
+         *
+         * Odpowiednik basic_matrix(r, c).diagonal_k(k, t) bez alokacji pełnej
+         * macierzy: zajmuje O(r) pamięci.
+         * \param r Liczba wierszy.
+         * \param c Liczba kolumn.
+         * \param k Numer przekątnej.
+         * \param t Tablica wartości do ustawienia na przekątnej.
+         * \return Macierz wstęgowa szerokości 1.
+         */
+        static band_matrix<T> diagonal_k(int r, int c, int k, const T* t);
+
+        /**
+         * \brief Tworzy dolny trójkąt jedynek n x n w upakowanym formacie (definicja w triangular.h).
+         *
+         * Odpowiednik basic_matrix(n, n).sub_diagonal() w n(n+1)/2 elementach.
+         * \param n Rozmiar macierzy.
+         * \return Macierz trójkątna dolna.
+         */
+        static triangular_matrix<T> sub_diagonal(int n);
+
+        /**
+         * \brief Tworzy górny trójkąt jedynek n x n w upakowanym formacie (definicja w triangular.h).
+         *
+         * Odpowiednik basic_matrix(n, n).super_diagonal() w n(n+1)/2 elementach.
+         * \param n Rozmiar macierzy.
+         * \return Macierz trójkątna górna.
+         */
+        static triangular_matrix<T> super_diagonal(int n);
 
         /**
          * \brief Wypełnia macierz wzorem szachownicy.
          * \return Referencja do obiektu macierzy.
          */
-        matrix& checkerboard();
+        basic_matrix& checkerboard();
 
     
         /**
          * \brief Operator dodawania macierzy.
-         * \param m Macierz do dodania.
+         * \param m Macierz do dodania (o tych samych wymiarach).
          * \return Referencja do obiektu macierzy.
+         * \throw std::invalid_argument Przy niezgodnych wymiarach.
          */
-        matrix& operator+(const matrix& m);
+        basic_matrix& operator+(const basic_matrix& m);
 
         /**
          * \brief Operator mnożenia macierzy.
+         *
+         * Dla macierzy M x K i K x N wynikiem jest macierz M x N. Używa
+         * algorytmu wybranego przez gemm::setAlgorithm() (domyślnie blokowego).
+         * Macierz na buforze zewnętrznym (wrap, adopt, map) zapisuje wynik
+         * o niezmienionych wymiarach w tym buforze.
          * \param m Macierz do pomnożenia.
          * \return Referencja do obiektu macierzy.
+         * \throw std::invalid_argument Gdy liczba kolumn *this różni się od liczby wierszy m.
+         */
+        basic_matrix& operator*(const basic_matrix& m);
+
+        /**
+         * \brief Iloczyn macierzy z akumulacją w typie Acc (np. int8_t -> int32_t).
+         *
+         * Konkretyzowany dla Acc == T oraz par int8_t/int16_t -> int32_t,
+         * int32_t -> int64_t i float -> double.
+         * \param m Macierz do pomnożenia.
+         * \return Nowa macierz *this * m o elementach typu Acc.
+         * \throw std::invalid_argument Gdy liczba kolumn *this różni się od liczby wierszy m.
+         */
+        template <typename Acc>
+        basic_matrix<Acc> product(const basic_matrix& m) const;
+
+        /**
+         * \brief Podnosi macierz kwadratową do potęgi k (potęgowanie przez podnoszenie do kwadratu).
+         *
+         * Wykonuje O(log k) mnożeń gemm::multiply() na dwóch buforach
+         * roboczych alokowanych raz na całe wywołanie; kolejne kroki nie
+         * alokują. Dla k = 0 wynikiem jest macierz jednostkowa.
+         * \param k Wykładnik.
+         * \return Referencja do obiektu macierzy (zastąpionego przez A^k).
+         * \throw std::invalid_argument Gdy macierz nie jest kwadratowa.
+         */
+        basic_matrix& pow(unsigned long long k);
+
+        /**
+         * \brief Podnosi macierz kwadratową do potęgi k modulo p (tylko typy całkowite).
+         *
+         * Elementy sprowadzane są do [0, p), a iloczyny liczone w int64_t;
+         * gdy sumy iloczynów mogłyby przekroczyć zakres, czynnik prawy
+         * dzielony jest na części 16-bitowe, więc wynik jest dokładny dla
+         * każdego p <= 2^31.
+         * \param k Wykładnik.
+         * \param p Moduł (1 <= p <= 2^31).
+         * \return Referencja do obiektu macierzy (zastąpionego przez A^k mod p).
+         * \throw std::invalid_argument Gdy macierz nie jest kwadratowa, p jest spoza zakresu lub typ elementów nie jest całkowity.
          */
-        matrix& operator*(const matrix& m);
+        basic_matrix& pow(unsigned long long k, T p);
 
         /**
          * \brief Operator dodawania liczby do macierzy.
          * \param a Liczba do dodania.
          * \return Referencja do obiektu macierzy.
          */
-        matrix& operator+(int a);
+        basic_matrix& operator+(T a);
 
         /**
          * \brief Operator mnożenia macierzy przez liczbę.
          * \param a Liczba do pomnożenia.
          * \return Referencja do obiektu macierzy.
          */
-        matrix& operator*(int a);
+        basic_matrix& operator*(T a);
     
         /**
          * \brief Operator odejmowania liczby od macierzy.
          * \param a Liczba do odjęcia.
          * \return Referencja do obiektu macierzy.
          */
-        matrix& operator-(int a);
+        basic_matrix& operator-(T a);
 
         /**
-         * \brief Operator dodawania liczby do macierzy (przyjaciel).
+         * \brief Operator inkrementacji macierzy.
+         * \return Referencja do obiektu macierzy.
+         */
+        basic_matrix& operator++(int);
+    
+        /**
+         * \brief Operator dekrementacji macierzy.
+         * \return Referencja do obiektu macierzy.
+         */
+        basic_matrix& operator--(int);
+
+        /**
+         * \brief Operator dodawania liczby do macierzy.
          * \param a Liczba do dodania.
-         * \param m Macierz.
-         * \return Nowa macierz będąca wynikiem dodania.
+         * \return Referencja do obiektu macierzy.
+         */
+        basic_matrix& operator+=(T a);
+
+        /**
+         * \brief Operator odejmowania liczby od macierzy.
+         * \param a Liczba do odjęcia.
+         * \return Referencja do obiektu macierzy.
          */
-        friend matrix operator+(int a, const matrix& m);
+        basic_matrix& operator-=(T a);
 
         /**
-         * \brief Operator mnożenia liczby przez macierz (przyjaciel).
+         * \brief Operator mnożenia macierzy przez liczbę.
          * \param a Liczba do pomnożenia.
-         * \param m Macierz.
-         * \return Nowa macierz będąca wynikiem mnożenia.
+         * \return Referencja do obiektu macierzy.
          */
-        friend matrix operator*(int a, const matrix& m);
+        basic_matrix& operator*=(T a);
 
         /**
-         * \brief Operator odejmowania liczby od macierzy (przyjaciel).
-         * \param a Liczba do odjęcia.
-         * \param m Macierz.
-         * \return Nowa macierz będąca wynikiem odejmowania.
+         * \brief Dodaje macierz element po elemencie (w miejscu).
+         * \param m Macierz o tych samych wymiarach (może być *this).
+         * \return Referencja do obiektu macierzy.
+         * \throw std::invalid_argument Przy niezgodnych wymiarach.
          */
-        friend matrix operator-(int a, const matrix& m);
+        basic_matrix& operator+=(const basic_matrix& m);
 
         /**
-         * \brief Operator inkrementacji macierzy.
+         * \brief Odejmuje macierz element po elemencie (w miejscu).
+         * \param m Macierz o tych samych wymiarach (może być *this).
          * \return Referencja do obiektu macierzy.
+         * \throw std::invalid_argument Przy niezgodnych wymiarach.
          */
-        matrix& operator++(int);
-    
+        basic_matrix& operator-=(const basic_matrix& m);
+
         /**
-         * \brief Operator dekrementacji macierzy.
+         * \brief Dodaje wyrażenie jednym przejściem, bez macierzy pośrednich.
+         *
+         * Wyrażenie może czytać *this tylko na tych samych pozycjach
+         * (np. m += 2 * m); widoki innych części *this przekazuje się jako
+         * matrix_view.
+         * \param e Wyrażenie o wymiarach macierzy.
          * \return Referencja do obiektu macierzy.
+         * \throw std::invalid_argument Przy niezgodnych wymiarach.
          */
-        matrix& operator--(int);
+        template <typename E>
+        basic_matrix& operator+=(const matrix_expr<E>& e);
 
         /**
-         * \brief Operator dodawania liczby do macierzy.
-         * \param a Liczba do dodania.
+         * \brief Odejmuje wyrażenie jednym przejściem, bez macierzy pośrednich.
+         * \param e Wyrażenie o wymiarach macierzy (czytające *this tylko na tych samych pozycjach).
          * \return Referencja do obiektu macierzy.
+         * \throw std::invalid_argument Przy niezgodnych wymiarach.
          */
-        matrix& operator+=(int a);
+        template <typename E>
+        basic_matrix& operator-=(const matrix_expr<E>& e);
 
         /**
-         * \brief Operator odejmowania liczby od macierzy.
-         * \param a Liczba do odjęcia.
+         * \brief Dodaje elementy widoku; widok może pokrywać się z macierzą (np. m += m.block(...)).
+         * \param v Widok o wymiarach macierzy.
          * \return Referencja do obiektu macierzy.
+         * \throw std::invalid_argument Przy niezgodnych wymiarach.
          */
-        matrix& operator-=(int a);
+        template <typename U>
+        basic_matrix& operator+=(const matrix_view<U>& v);
 
         /**
-         * \brief Operator mnożenia macierzy przez liczbę.
-         * \param a Liczba do pomnożenia.
+         * \brief Odejmuje elementy widoku; widok może pokrywać się z macierzą.
+         * \param v Widok o wymiarach macierzy.
          * \return Referencja do obiektu macierzy.
+         * \throw std::invalid_argument Przy niezgodnych wymiarach.
          */
-        matrix& operator*=(int a);
+        template <typename U>
+        basic_matrix& operator-=(const matrix_view<U>& v);
 
         /**
          * \brief Operator dodawania wartości do wszystkich elementów macierzy.
+         *
+         * Dla typów całkowitych dodawana jest część całkowita wartości.
          * \param value Wartość do dodania.
          * \return Referencja do obiektu macierzy.
          */
-        matrix& operator()(double);
+        basic_matrix& operator()(double);
 
         /**
          * \brief Operator strumieniowy do wyświetlania macierzy.
@@ -255,31 +714,46 @@ class matrix {
          * \param m Macierz do wyświetlenia.
          * \return Strumień wyjściowy.
          */
-        friend std::ostream& operator<<(std::ostream& o, const matrix& m);
+        template <typename U>
+        friend std::ostream& operator<<(std::ostream& o, const basic_matrix<U>& m);
 
         /**
          * \brief Operator porównania macierzy.
          * \param m Macierz do porównania.
          * \return true jeśli macierze są równe, false w przeciwnym razie.
          */
-        bool operator==(const matrix& m) const;
+        bool operator==(const basic_matrix& m) const;
 
         /**
          * \brief Operator porównania macierzy.
          * \param m Macierz do porównania.
          * \return true jeśli macierz jest większa, false w przeciwnym razie.
          */
-        bool operator>(const matrix& m) const;
+        bool operator>(const basic_matrix& m) const;
 
         /**
          * \brief Operator porównania macierzy.
          * \param m Macierz do porównania.
          * \return true jeśli macierz jest mniejsza, false w przeciwnym razie.
          */
-        bool operator<(const matrix& m) const;
+        bool operator<(const basic_matrix& m) const;
 
         /**
          * \brief Wypełnia macierz zerami.
          */
         void writeZeros();
 };
+
+/**
+ * \brief Macierz liczb całkowitych (dotychczasowy typ macierzy).
+ */
+typedef basic_matrix<int> matrix;
+
+template <typename T>
+const std::size_t basic_matrix<T>::ALIGNMENT;
+
+template <typename T>
+const int basic_matrix<T>::EXPR_BLOCK;
+
+#include "expr.h"
+#include "view.h"
@@ -0,0 +1,259 @@
+﻿#include "matrix_file.h"
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/// Sygnatura pliku.
+static const char MAGIC[8] = { 'M', 'T', 'R', 'X', 'B', 'I', 'N', '\0' };
+
+/// Znacznik kolejności bajtów.
+static const std::uint32_t ENDIAN_MARK = 0x01020304u;
+
+template <typename T>
+const std::uint32_t matrix_file<T>::VERSION;
+
+template <typename T>
+const std::uint32_t matrix_file<T>::HEADER_SIZE;
+
+/**
+* \brief Kod typu elementu zapisywany w nagłówku (zgodny z matrix_file::element).
+*/
+template <typename T> struct element_code;
+template <> struct element_code<std::int8_t> { static const std::uint32_t value = 1; };
+template <> struct element_code<std::int16_t> { static const std::uint32_t value = 2; };
+template <> struct element_code<std::int32_t> { static const std::uint32_t value = 3; };
+template <> struct element_code<std::int64_t> { static const std::uint32_t value = 4; };
+template <> struct element_code<float> { static const std::uint32_t value = 5; };
+template <> struct element_code<double> { static const std::uint32_t value = 6; };
+
+/**
+* \brief Zwraca kod typu elementu T.
+* \return Kod typu.
+*/
+template <typename T>
+typename matrix_file<T>::element matrix_file<T>::elementType() {
+    return static_cast<element>(element_code<T>::value);
+}
+
+/**
+* \brief Sprawdza nagłówek i zwraca rozmiar danych w bajtach.
+* \param h Nagłówek.
+* \return Rozmiar danych (rows * stride elementów).
+* \throw std::runtime_error Gdy nagłówek jest błędny lub opisuje inny typ elementu.
+*/
+template <typename T>
+static std::uint64_t validate(const typename matrix_file<T>::header& h) {
+    if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error("matrix file: not a matrix file");
+    }
+    if (h.byteOrder != ENDIAN_MARK) {
+        throw std::runtime_error("matrix file: byte order mismatch");
+    }
+    if (h.version == 0 || h.version > matrix_file<T>::VERSION || h.headerSize < matrix_file<T>::HEADER_SIZE || h.headerSize % basic_matrix<T>::ALIGNMENT != 0) {
+        throw std::runtime_error("matrix file: unsupported version");
+    }
+    if (h.type != static_cast<std::uint32_t>(matrix_file<T>::elementType()) || h.typeSize != sizeof(T)) {
+        throw std::runtime_error("matrix file: element type mismatch");
+    }
+    const std::uint64_t limit = static_cast<std::uint64_t>(std::numeric_limits<int>::max());
+    if (h.rows > limit || h.cols > limit || h.stride > limit || h.stride < h.cols) {
+        throw std::runtime_error("matrix file: invalid dimensions");
+    }
+    // Sprawdzenie przed mnożeniem: spreparowany nagłówek nie może przekręcić rozmiaru danych.
+    if (h.stride != 0 && h.rows > (std::numeric_limits<std::uint64_t>::max() - h.headerSize) / sizeof(T) / h.stride) {
+        throw std::runtime_error("matrix file: invalid dimensions");
+    }
+    return h.rows * h.stride * sizeof(T);
+}
+
+/**
+* \brief Zapisuje macierz do strumienia binarnego.
+* \param m Macierz.
+* \param out Strumień otwarty w trybie binarnym.
+*/
+template <typename T>
+void matrix_file<T>::save(const basic_matrix<T>& m, std::ostream& out) {
+    static_assert(sizeof(header) == HEADER_SIZE, "matrix file: header must be 64 bytes");
+    header h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.headerSize = HEADER_SIZE;
+    h.type = static_cast<std::uint32_t>(elementType());
+    h.typeSize = sizeof(T);
+    h.rows = static_cast<std::uint64_t>(m.rows);
+    h.cols = static_cast<std::uint64_t>(m.cols);
+    h.stride = static_cast<std::uint64_t>(m.data != nullptr ? m.stride : m.cols);
+    h.byteOrder = ENDIAN_MARK;
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    if (m.data != nullptr) {
+        out.write(reinterpret_cast<const char*>(m.data), static_cast<std::streamsize>(static_cast<std::size_t>(m.rows) * m.stride * sizeof(T)));
+    }
+    if (!out) {
+        throw std::runtime_error("matrix file: write failed");
+    }
+}
+
+/**
+* \brief Zapisuje macierz do pliku.
+* \param m Macierz.
+* \param path Ścieżka pliku (nadpisywanego).
+*/
+template <typename T>
+void matrix_file<T>::save(const basic_matrix<T>& m, const std::string& path) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("matrix file: cannot create " + path);
+    }
+    save(m, out);
+    out.close();
+    if (!out) {
+        throw std::runtime_error("matrix file: write failed");
+    }
+}
+
+/**
+* \brief Odczytuje i sprawdza nagłówek pliku.
+* \param path Ścieżka pliku.
+* \return Nagłówek.
+*/
+template <typename T>
+typename matrix_file<T>::header matrix_file<T>::inspect(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("matrix file: cannot open " + path);
+    }
+    header h;
+    if (!in.read(reinterpret_cast<char*>(&h), sizeof(h))) {
+        throw std::runtime_error("matrix file: truncated header");
+    }
+    validate<T>(h);
+    return h;
+}
+
+/**
+* \brief Wczytuje macierz ze strumienia binarnego do nowego bufora.
+*
+* Gdy odstęp wierszy w pliku jest równy odstępowi nowej macierzy, dane
+* czytane są jednym wywołaniem, w przeciwnym razie wiersz po wierszu.
+* \param in Strumień otwarty w trybie binarnym.
+* \return Macierz.
+*/
+template <typename T>
+basic_matrix<T> matrix_file<T>::load(std::istream& in) {
+    header h;
+    if (!in.read(reinterpret_cast<char*>(&h), sizeof(h))) {
+        throw std::runtime_error("matrix file: truncated header");
+    }
+    validate<T>(h);
+    in.ignore(static_cast<std::streamsize>(h.headerSize - sizeof(h)));
+    const int r = static_cast<int>(h.rows);
+    const int c = static_cast<int>(h.cols);
+    const int ld = static_cast<int>(h.stride);
+    basic_matrix<T> m(r, c, ld == c ? basic_matrix<T>::layout::packed : basic_matrix<T>::layout::padded);
+    if (m.stride == ld) {
+        in.read(reinterpret_cast<char*>(m.data), static_cast<std::streamsize>(static_cast<std::size_t>(r) * ld * sizeof(T)));
+    } else {
+        for (int i = 0; i < r && in; ++i) {
+            in.read(reinterpret_cast<char*>(m.rowPtr(i)), static_cast<std::streamsize>(c * sizeof(T)));
+            in.ignore(static_cast<std::streamsize>((ld - c) * sizeof(T)));
+        }
+    }
+    if (!in) {
+        throw std::runtime_error("matrix file: truncated data");
+    }
+    return m;
+}
+
+/**
+* \brief Wczytuje macierz z pliku do nowego bufora.
+* \param path Ścieżka pliku.
+* \return Macierz.
+*/
+template <typename T>
+basic_matrix<T> matrix_file<T>::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("matrix file: cannot open " + path);
+    }
+    return load(in);
+}
+
+/**
+* \brief Odwzorowuje plik w pamięci i zwraca macierz korzystającą bezpośrednio z jego danych.
+* \param path Ścieżka pliku.
+* \param mode Sposób odwzorowania.
+* \return Macierz o buforze w odwzorowanym pliku.
+*/
+template <typename T>
+basic_matrix<T> matrix_file<T>::map(const std::string& path, mapping mode) {
+    const header h = inspect(path);
+    const std::uint64_t payload = validate<T>(h);
+    const std::uint64_t total = h.headerSize + payload;
+    if (total > static_cast<std::uint64_t>(std::numeric_limits<std::size_t>::max())) {
+        throw std::runtime_error("matrix file: file too large to map");
+    }
+    const std::size_t size = static_cast<std::size_t>(total);
+    const bool shared = mode == mapping::shared;
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), shared ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("matrix file: cannot open " + path);
+    }
+    LARGE_INTEGER length;
+    if (!GetFileSizeEx(file, &length) || static_cast<std::uint64_t>(length.QuadPart) < total) {
+        CloseHandle(file);
+        throw std::runtime_error("matrix file: truncated data");
+    }
+    HANDLE section = CreateFileMappingA(file, nullptr, shared ? PAGE_READWRITE : PAGE_WRITECOPY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (section == nullptr) {
+        throw std::runtime_error("matrix file: cannot map " + path);
+    }
+    void* base = MapViewOfFile(section, shared ? FILE_MAP_WRITE : FILE_MAP_COPY, 0, 0, size);
+    CloseHandle(section);
+    if (base == nullptr) {
+        throw std::runtime_error("matrix file: cannot map " + path);
+    }
+    std::shared_ptr<void> owner(base, [](void* p) { UnmapViewOfFile(p); });
+#else
+    const int fd = ::open(path.c_str(), shared ? O_RDWR : O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("matrix file: cannot open " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<std::uint64_t>(st.st_size) < total) {
+        ::close(fd);
+        throw std::runtime_error("matrix file: truncated data");
+    }
+    void* base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, shared ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        throw std::runtime_error("matrix file: cannot map " + path);
+    }
+    std::shared_ptr<void> owner(base, [size](void* p) { ::munmap(p, size); });
+#endif
+    T* buffer = reinterpret_cast<T*>(static_cast<char*>(base) + h.headerSize);
+    return basic_matrix<T>(buffer, static_cast<int>(h.rows), static_cast<int>(h.cols), static_cast<int>(h.stride), owner);
+}
+
+template class matrix_file<std::int8_t>;
+template class matrix_file<std::int16_t>;
+template class matrix_file<std::int32_t>;
+template class matrix_file<std::int64_t>;
+template class matrix_file<float>;
+template class matrix_file<double>;
\ No newline at end of file
@@ -0,0 +1,118 @@
+﻿#pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include "matrix.h"
+
+/**
+ * \class matrix_file
+ * \brief Binarny format plikowy macierzy: zapis, odczyt i odwzorowanie pliku w pamięci.
+ *
+ * Plik zaczyna się 64-bajtowym nagłówkiem (header), po którym następuje
+ * bufor macierzy: rows wierszy po stride elementów, w kolejności bajtów
+ * komputera zapisującego. Dane zaczynają się na granicy 64 bajtów, więc
+ * po odwzorowaniu pliku (map()) są wyrównane tak jak bufor basic_matrix
+ * i mogą być używane bezpośrednio, bez kopiowania.
+ */
+template <typename T>
+class matrix_file {
+    public:
+        static const std::uint32_t VERSION = 1; ///< Wersja formatu zapisywana przez save().
+        static const std::uint32_t HEADER_SIZE = 64; ///< Rozmiar nagłówka i przesunięcie danych w bajtach.
+
+        /**
+         * \brief Kody typów elementów zapisywane w nagłówku.
+         */
+        enum class element : std::uint32_t {
+            int8 = 1,
+            int16 = 2,
+            int32 = 3,
+            int64 = 4,
+            float32 = 5,
+            float64 = 6
+        };
+
+        /**
+         * \brief Nagłówek pliku (64 bajty).
+         */
+        struct header {
+            char magic[8];            ///< "MTRXBIN" zakończone zerem.
+            std::uint32_t version;    ///< Wersja formatu.
+            std::uint32_t headerSize; ///< Przesunięcie danych od początku pliku w bajtach.
+            std::uint32_t type;       ///< Typ elementu (element).
+            std::uint32_t typeSize;   ///< Rozmiar elementu w bajtach.
+            std::uint64_t rows;       ///< Liczba wierszy.
+            std::uint64_t cols;       ///< Liczba kolumn.
+            std::uint64_t stride;     ///< Odstęp między wierszami danych w elementach (>= cols).
+            std::uint32_t byteOrder;  ///< 0x01020304 zapisane w kolejności bajtów pliku.
+            std::uint32_t flags;      ///< Zarezerwowane (0).
+            std::uint8_t reserved[8]; ///< Dopełnienie do 64 bajtów (zera).
+        };
+
+        /**
+         * \brief Sposób odwzorowania pliku przez map().
+         */
+        enum class mapping {
+            copy_on_write, ///< Zmiany macierzy są prywatne i nie trafiają do pliku.
+            shared         ///< Zmiany macierzy zapisywane są do pliku.
+        };
+
+        /**
+         * \brief Zwraca kod typu elementu T.
+         * \return Kod typu.
+         */
+        static element elementType();
+
+        /**
+         * \brief Zapisuje macierz do strumienia binarnego.
+         * \param m Macierz.
+         * \param out Strumień otwarty w trybie binarnym.
+         * \throw std::runtime_error Przy błędzie zapisu.
+         */
+        static void save(const basic_matrix<T>& m, std::ostream& out);
+
+        /**
+         * \brief Zapisuje macierz do pliku.
+         * \param m Macierz.
+         * \param path Ścieżka pliku (nadpisywanego).
+         * \throw std::runtime_error Gdy pliku nie da się utworzyć lub zapisać.
+         */
+        static void save(const basic_matrix<T>& m, const std::string& path);
+
+        /**
+         * \brief Odczytuje i sprawdza nagłówek pliku.
+         * \param path Ścieżka pliku.
+         * \return Nagłówek.
+         * \throw std::runtime_error Gdy plik nie istnieje lub nie jest w tym formacie.
+         */
+        static header inspect(const std::string& path);
+
+        /**
+         * \brief Wczytuje macierz ze strumienia binarnego do nowego bufora.
+         * \param in Strumień otwarty w trybie binarnym.
+         * \return Macierz.
+         * \throw std::runtime_error Przy błędnym nagłówku, innym typie elementu lub błędzie odczytu.
+         */
+        static basic_matrix<T> load(std::istream& in);
+
+        /**
+         * \brief Wczytuje macierz z pliku do nowego bufora.
+         * \param path Ścieżka pliku.
+         * \return Macierz.
+         * \throw std::runtime_error Przy błędnym nagłówku, innym typie elementu lub błędzie odczytu.
+         */
+        static basic_matrix<T> load(const std::string& path);
+
+        /**
+         * \brief Odwzorowuje plik w pamięci i zwraca macierz korzystającą bezpośrednio z jego danych.
+         *
+         * Dane nie są czytane ani kopiowane; strony wczytywane są przez system
+         * przy pierwszym dostępie. Odwzorowanie zwalniane jest razem
+         * z buforem macierzy (także po przeniesieniu jej do innego obiektu).
+         * \param path Ścieżka pliku.
+         * \param mode Sposób odwzorowania.
+         * \return Macierz o buforze w odwzorowanym pliku.
+         * \throw std::runtime_error Przy błędnym nagłówku, innym typie elementu lub niepowodzeniu odwzorowania.
+         */
+        static basic_matrix<T> map(const std::string& path, mapping mode = mapping::copy_on_write);
+};
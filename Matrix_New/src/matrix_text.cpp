@@ -0,0 +1,529 @@
+﻿#include "matrix_text.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/// Docelowy rozmiar bufora wyjściowego jednej porcji w bajtach.
+static const std::size_t OUTPUT_CHUNK = 1 << 20;
+
+/// Najmniejsza porcja tekstu parsowana przez osobne zadanie, w bajtach.
+static const std::size_t INPUT_CHUNK = 1 << 16;
+
+/// Górne ograniczenie długości zapisu jednej wartości razem z separatorem.
+static const std::size_t MAX_FIELD = 32;
+
+/**
+* \brief Czy znak jest odstępem wewnątrz linii.
+*/
+static bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/**
+* \brief Pomija odstępy wewnątrz linii.
+* \return Pierwszy znak różny od odstępu lub e.
+*/
+static const char* skipBlank(const char* p, const char* e) {
+    while (p != e && isBlank(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+/**
+* \brief Zwraca koniec linii zaczynającej się w p (pozycję '\n' lub e).
+*/
+static const char* lineEnd(const char* p, const char* e) {
+    const void* q = std::memchr(p, '\n', static_cast<std::size_t>(e - p));
+    return q != nullptr ? static_cast<const char*>(q) : e;
+}
+
+/**
+* \brief Zwraca początek linii następującej po linii kończącej się w e.
+*/
+static const char* nextLine(const char* e, const char* last) {
+    return e == last ? last : e + 1;
+}
+
+/**
+* \brief Parsuje jedną wartość (dopuszcza wiodący znak '+').
+* \return Pozycja za wartością lub nullptr przy błędzie.
+*/
+template <typename T>
+static const char* parseValue(const char* p, const char* e, T& v) {
+    if (p != e && *p == '+') {
+        ++p;
+    }
+    const std::from_chars_result r = std::from_chars(p, e, v);
+    return r.ec == std::errc() ? r.ptr : nullptr;
+}
+
+/**
+* \brief Dzieli tekst na porcje zaczynające się na początkach linii.
+* \param parallel Czy dzielić na więcej niż jedną porcję.
+* \return Granice porcji (liczba porcji + 1 wskaźników).
+*/
+static std::vector<const char*> splitChunks(const char* first, const char* last, bool parallel) {
+    std::size_t chunks = 1;
+    if (parallel) {
+        const std::size_t threads = static_cast<std::size_t>(thread_pool::instance().getThreadCount());
+        chunks = std::max<std::size_t>(1, std::min(static_cast<std::size_t>(last - first) / INPUT_CHUNK, 4 * threads));
+    }
+    std::vector<const char*> bounds(chunks + 1, last);
+    bounds[0] = first;
+    for (std::size_t k = 1; k < chunks; ++k) {
+        const char* p = std::max(bounds[k - 1], first + (last - first) * static_cast<std::ptrdiff_t>(k) / static_cast<std::ptrdiff_t>(chunks));
+        bounds[k] = nextLine(lineEnd(p, last), last);
+    }
+    return bounds;
+}
+
+/**
+* \brief Zamienia liczby rekordów porcji (na pozycjach 1..n) na indeksy ich pierwszych rekordów.
+* \return Łączna liczba rekordów.
+*/
+static long long prefixSum(std::vector<long long>& counts) {
+    for (std::size_t k = 1; k < counts.size(); ++k) {
+        counts[k] += counts[k - 1];
+    }
+    return counts.back();
+}
+
+/**
+* \brief Liczy wartości w linii.
+* \param delim ',' dla CSV, ' ' dla wartości oddzielonych odstępami.
+*/
+static int countFields(const char* p, const char* e, char delim) {
+    int n = 0;
+    if (delim != ' ') {
+        n = 1;
+        for (; p != e; ++p) {
+            n += *p == delim;
+        }
+        return n;
+    }
+    while ((p = skipBlank(p, e)) != e) {
+        ++n;
+        while (p != e && !isBlank(*p)) {
+            ++p;
+        }
+    }
+    return n;
+}
+
+/**
+* \brief Parsuje linię zawierającą dokładnie cols wartości.
+* \return false przy błędzie składni lub innej liczbie wartości.
+*/
+template <typename T>
+static bool parseRow(const char* p, const char* e, char delim, T* out, int cols) {
+    for (int j = 0; j < cols; ++j) {
+        p = skipBlank(p, e);
+        if (j > 0 && delim != ' ') {
+            if (p == e || *p != delim) {
+                return false;
+            }
+            p = skipBlank(p + 1, e);
+        }
+        p = parseValue(p, e, out[j]);
+        if (p == nullptr || (p != e && !isBlank(*p) && *p != delim)) {
+            return false;
+        }
+    }
+    return skipBlank(p, e) == e;
+}
+
+/**
+* \brief Parsuje formaty whitespace i csv.
+* \param delim ',' dla CSV, ' ' dla wartości oddzielonych odstępami.
+*/
+template <typename T>
+basic_matrix<T> matrix_text<T>::parseDense(const char* first, const char* last, char delim, bool parallel) {
+    int cols = 0;
+    while (first != last) {
+        const char* e = lineEnd(first, last);
+        if (skipBlank(first, e) != e) {
+            cols = countFields(first, e, delim);
+            break;
+        }
+        first = nextLine(e, last);
+    }
+    if (cols == 0) {
+        return basic_matrix<T>();
+    }
+
+    const std::vector<const char*> bounds = splitChunks(first, last, parallel);
+    const int chunks = static_cast<int>(bounds.size()) - 1;
+    std::vector<long long> rowStart(chunks + 1, 0);
+    thread_pool::instance().parallelFor(chunks, [&](int k) {
+        long long n = 0;
+        for (const char* p = bounds[k]; p != bounds[k + 1]; ) {
+            const char* e = lineEnd(p, bounds[k + 1]);
+            n += skipBlank(p, e) != e;
+            p = nextLine(e, bounds[k + 1]);
+        }
+        rowStart[k + 1] = n;
+    });
+    const long long rows = prefixSum(rowStart);
+    if (rows > INT_MAX) {
+        throw std::runtime_error("matrix text: too many rows");
+    }
+
+    basic_matrix<T> m = basic_matrix<T>(static_cast<int>(rows), cols);
+    thread_pool::instance().parallelFor(chunks, [&](int k) {
+        long long r = rowStart[k];
+        for (const char* p = bounds[k]; p != bounds[k + 1]; ) {
+            const char* e = lineEnd(p, bounds[k + 1]);
+            if (skipBlank(p, e) != e) {
+                if (!parseRow(p, e, delim, m.rowPtr(static_cast<int>(r)), cols)) {
+                    throw std::runtime_error("matrix text: parse error in row " + std::to_string(r + 1));
+                }
+                ++r;
+            }
+            p = nextLine(e, bounds[k + 1]);
+        }
+    });
+    return m;
+}
+
+/**
+* \brief Dzieli linię na słowa zamienione na małe litery.
+*/
+static std::vector<std::string> lowerWords(const char* p, const char* e) {
+    std::vector<std::string> words;
+    while ((p = skipBlank(p, e)) != e) {
+        std::string w;
+        for (; p != e && !isBlank(*p); ++p) {
+            w += static_cast<char>(std::tolower(static_cast<unsigned char>(*p)));
+        }
+        words.push_back(w);
+    }
+    return words;
+}
+
+/**
+* \brief Parsuje format Matrix Market (array lub coordinate; general lub symmetric).
+*/
+template <typename T>
+basic_matrix<T> matrix_text<T>::parseMarket(const char* first, const char* last, bool parallel) {
+    const char* e = lineEnd(first, last);
+    const std::vector<std::string> banner = lowerWords(first, e);
+    if (banner.size() < 5 || banner[0] != "%%matrixmarket" || banner[1] != "matrix") {
+        throw std::runtime_error("matrix text: missing Matrix Market banner");
+    }
+    const bool coordinate = banner[2] == "coordinate";
+    const bool pattern = banner[3] == "pattern";
+    const bool symmetric = banner[4] == "symmetric";
+    if ((!coordinate && banner[2] != "array") || (pattern && !coordinate)
+        || (!pattern && banner[3] != "integer" && banner[3] != "real" && banner[3] != "double")
+        || (!symmetric && banner[4] != "general")) {
+        throw std::runtime_error("matrix text: unsupported Matrix Market type");
+    }
+
+    const char* p = nextLine(e, last);
+    for (; p != last; p = nextLine(e, last)) {
+        e = lineEnd(p, last);
+        const char* q = skipBlank(p, e);
+        if (q != e && *q != '%') {
+            break;
+        }
+    }
+    long long size[3] = { 0, 0, 0 };
+    const int fields = coordinate ? 3 : 2;
+    const char* q = p;
+    for (int i = 0; i < fields; ++i) {
+        q = q == nullptr ? nullptr : parseValue(skipBlank(q, e), e, size[i]);
+    }
+    if (p == last || q == nullptr || skipBlank(q, e) != e || size[0] < 0 || size[1] < 0 || size[2] < 0 || size[0] > INT_MAX || size[1] > INT_MAX) {
+        throw std::runtime_error("matrix text: invalid Matrix Market size line");
+    }
+    const int rows = static_cast<int>(size[0]);
+    const int cols = static_cast<int>(size[1]);
+    if (symmetric && rows != cols) {
+        throw std::runtime_error("matrix text: symmetric matrix must be square");
+    }
+    basic_matrix<T> m = basic_matrix<T>(rows, cols);
+
+    const std::vector<const char*> bounds = splitChunks(nextLine(e, last), last, parallel);
+    const int chunks = static_cast<int>(bounds.size()) - 1;
+    std::vector<long long> start(chunks + 1, 0);
+    thread_pool::instance().parallelFor(chunks, [&](int k) {
+        long long n = 0;
+        for (const char* s = bounds[k]; s != bounds[k + 1]; ) {
+            const char* t = lineEnd(s, bounds[k + 1]);
+            if (coordinate) {
+                const char* v = skipBlank(s, t);
+                n += v != t && *v != '%';
+            } else {
+                n += countFields(s, t, ' ');
+            }
+            s = nextLine(t, bounds[k + 1]);
+        }
+        start[k + 1] = n;
+    });
+    const long long total = prefixSum(start);
+    const long long expected = coordinate ? size[2] : symmetric ? static_cast<long long>(rows) * (rows + 1) / 2 : static_cast<long long>(rows) * cols;
+    if (total != expected) {
+        throw std::runtime_error("matrix text: expected " + std::to_string(expected) + " values, found " + std::to_string(total));
+    }
+
+    if (!coordinate) {
+        thread_pool::instance().parallelFor(chunks, [&](int k) {
+            long long t = start[k];
+            int i = 0;
+            int j = 0;
+            if (symmetric) {
+                long long offset = 0;
+                while (t >= offset + (rows - j)) {
+                    offset += rows - j;
+                    ++j;
+                }
+                i = j + static_cast<int>(t - offset);
+            } else if (rows > 0) {
+                i = static_cast<int>(t % rows);
+                j = static_cast<int>(t / rows);
+            }
+            for (const char* s = bounds[k]; s != bounds[k + 1]; ) {
+                const char* end = lineEnd(s, bounds[k + 1]);
+                while ((s = skipBlank(s, end)) != end) {
+                    T v = T();
+                    s = parseValue(s, end, v);
+                    if (s == nullptr || (s != end && !isBlank(*s))) {
+                        throw std::runtime_error("matrix text: parse error in value " + std::to_string(t + 1));
+                    }
+                    m.rowPtr(i)[j] = v;
+                    if (symmetric) {
+                        m.rowPtr(j)[i] = v;
+                    }
+                    ++t;
+                    if (++i == rows) {
+                        ++j;
+                        i = symmetric ? j : 0;
+                    }
+                }
+                s = nextLine(end, bounds[k + 1]);
+            }
+        });
+        return m;
+    }
+
+    // Wpisy formatu coordinate zbierane są w porcjach i nanoszone po kolei,
+    // żeby powtórzone pozycje nie były zapisywane równolegle.
+    struct entry {
+        int i;
+        int j;
+        T v;
+    };
+    std::vector<std::vector<entry>> entries(chunks);
+    thread_pool::instance().parallelFor(chunks, [&](int k) {
+        std::vector<entry>& out = entries[k];
+        out.reserve(static_cast<std::size_t>(start[k + 1] - start[k]));
+        for (const char* s = bounds[k]; s != bounds[k + 1]; ) {
+            const char* end = lineEnd(s, bounds[k + 1]);
+            const char* v = skipBlank(s, end);
+            if (v != end && *v != '%') {
+                long long i = 0;
+                long long j = 0;
+                entry x;
+                x.v = T(1);
+                v = parseValue(v, end, i);
+                v = v == nullptr ? nullptr : parseValue(skipBlank(v, end), end, j);
+                if (!pattern) {
+                    v = v == nullptr ? nullptr : parseValue(skipBlank(v, end), end, x.v);
+                }
+                if (v == nullptr || skipBlank(v, end) != end || i < 1 || i > rows || j < 1 || j > cols) {
+                    throw std::runtime_error("matrix text: invalid entry " + std::to_string(start[k] + out.size() + 1));
+                }
+                x.i = static_cast<int>(i - 1);
+                x.j = static_cast<int>(j - 1);
+                out.push_back(x);
+            }
+            s = nextLine(end, bounds[k + 1]);
+        }
+    });
+    for (const std::vector<entry>& part : entries) {
+        for (const entry& x : part) {
+            m.rowPtr(x.i)[x.j] = x.v;
+            if (symmetric) {
+                m.rowPtr(x.j)[x.i] = x.v;
+            }
+        }
+    }
+    return m;
+}
+
+/**
+* \brief Zapisuje wartość przez std::to_chars.
+* \return Pozycja za zapisaną wartością.
+*/
+template <typename T>
+static char* formatValue(char* p, T v) {
+    return std::to_chars(p, p + MAX_FIELD, v).ptr;
+}
+
+/**
+* \brief Zapisuje macierz do strumienia.
+*
+* Rekordy (wiersze, a dla Matrix Market - kolumny) formatowane są
+* porcjami do buforów około 1 MiB, po jednej porcji na wątek, i zapisywane
+* do strumienia po kolei. Błędy zapisu sygnalizowane są stanem strumienia.
+* \param m Macierz.
+* \param out Strumień wyjściowy.
+* \param f Format.
+* \param parallel Czy formatować porcje wierszy równolegle.
+*/
+template <typename T>
+void matrix_text<T>::write(const basic_matrix<T>& m, std::ostream& out, format f, bool parallel) {
+    const bool market = f == format::matrix_market;
+    if (market) {
+        out << "%%MatrixMarket matrix array " << (std::is_integral<T>::value ? "integer" : "real") << " general\n"
+            << m.rows << ' ' << m.cols << '\n';
+    }
+    const int records = market ? m.cols : m.rows;
+    const int width = market ? m.rows : m.cols;
+    if (records == 0 || width == 0 || m.data == nullptr) {
+        return;
+    }
+    const char sep = f == format::csv ? ',' : ' ';
+    const std::size_t recordBytes = static_cast<std::size_t>(width) * MAX_FIELD + 1;
+    const int perChunk = static_cast<int>(std::min<std::size_t>(records, std::max<std::size_t>(1, OUTPUT_CHUNK / recordBytes)));
+    const int slots = parallel ? thread_pool::instance().getThreadCount() : 1;
+    std::vector<std::vector<char>> buffers(slots, std::vector<char>(perChunk * recordBytes));
+    std::vector<std::size_t> used(slots, 0);
+
+    for (int first = 0; first < records; first += perChunk * slots) {
+        const int chunks = std::min(slots, (records - first + perChunk - 1) / perChunk);
+        thread_pool::instance().parallelFor(chunks, [&](int c) {
+            char* p = buffers[c].data();
+            const int r0 = first + c * perChunk;
+            const int r1 = std::min(records, r0 + perChunk);
+            for (int r = r0; r < r1; ++r) {
+                if (market) {
+                    for (int i = 0; i < width; ++i) {
+                        p = formatValue(p, m.rowPtr(i)[r]);
+                        *p++ = '\n';
+                    }
+                } else {
+                    const T* row = m.rowPtr(r);
+                    for (int j = 0; j < width; ++j) {
+                        if (j > 0) {
+                            *p++ = sep;
+                        }
+                        p = formatValue(p, row[j]);
+                    }
+                    *p++ = '\n';
+                }
+            }
+            used[c] = static_cast<std::size_t>(p - buffers[c].data());
+        });
+        for (int c = 0; c < chunks; ++c) {
+            out.write(buffers[c].data(), static_cast<std::streamsize>(used[c]));
+        }
+    }
+}
+
+/**
+* \brief Zapisuje macierz do pliku.
+* \param m Macierz.
+* \param path Ścieżka pliku (nadpisywanego).
+* \param f Format.
+* \param parallel Czy formatować porcje wierszy równolegle.
+*/
+template <typename T>
+void matrix_text<T>::write(const basic_matrix<T>& m, const std::string& path, format f, bool parallel) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("matrix text: cannot create " + path);
+    }
+    write(m, out, f, parallel);
+    out.close();
+    if (!out) {
+        throw std::runtime_error("matrix text: write failed");
+    }
+}
+
+/**
+* \brief Parsuje macierz z tekstu w pamięci.
+* \param first Początek tekstu.
+* \param last Koniec tekstu.
+* \param f Format.
+* \param parallel Czy parsować porcje tekstu równolegle.
+* \return Macierz.
+*/
+template <typename T>
+basic_matrix<T> matrix_text<T>::parse(const char* first, const char* last, format f, bool parallel) {
+    switch (f) {
+    case format::csv:
+        return parseDense(first, last, ',', parallel);
+    case format::matrix_market:
+        return parseMarket(first, last, parallel);
+    case format::whitespace:
+    default:
+        return parseDense(first, last, ' ', parallel);
+    }
+}
+
+/**
+* \brief Wczytuje macierz ze strumienia (w całości do pamięci, potem parse()).
+* \param in Strumień wejściowy.
+* \param f Format.
+* \param parallel Czy parsować porcje tekstu równolegle.
+* \return Macierz.
+*/
+template <typename T>
+basic_matrix<T> matrix_text<T>::read(std::istream& in, format f, bool parallel) {
+    std::vector<char> text;
+    std::size_t size = 0;
+    for (;;) {
+        text.resize(size + OUTPUT_CHUNK);
+        in.read(text.data() + size, static_cast<std::streamsize>(OUTPUT_CHUNK));
+        size += static_cast<std::size_t>(in.gcount());
+        if (!in) {
+            break;
+        }
+    }
+    if (in.bad()) {
+        throw std::runtime_error("matrix text: read failed");
+    }
+    return parse(text.data(), text.data() + size, f, parallel);
+}
+
+/**
+* \brief Wczytuje macierz z pliku.
+* \param path Ścieżka pliku.
+* \param f Format.
+* \param parallel Czy parsować porcje tekstu równolegle.
+* \return Macierz.
+*/
+template <typename T>
+basic_matrix<T> matrix_text<T>::read(const std::string& path, format f, bool parallel) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        throw std::runtime_error("matrix text: cannot open " + path);
+    }
+    const std::streamoff size = in.tellg();
+    in.seekg(0);
+    std::vector<char> text(static_cast<std::size_t>(std::max<std::streamoff>(size, 0)));
+    if (!in.read(text.data(), static_cast<std::streamsize>(text.size()))) {
+        throw std::runtime_error("matrix text: read failed");
+    }
+    return parse(text.data(), text.data() + text.size(), f, parallel);
+}
+
+template class matrix_text<std::int8_t>;
+template class matrix_text<std::int16_t>;
+template class matrix_text<std::int32_t>;
+template class matrix_text<std::int64_t>;
+template class matrix_text<float>;
+template class matrix_text<double>;
\ No newline at end of file
@@ -0,0 +1,96 @@
+﻿#pragma once
+#include <iosfwd>
+#include <string>
+#include "matrix.h"
+
+/**
+ * \class matrix_text
+ * \brief Szybki zapis i odczyt macierzy w formatach tekstowych.
+ *
+ * Liczby formatowane są przez std::to_chars (dla float/double - najkrótszy
+ * zapis odtwarzający wartość) do dużych buforów zapisywanych do strumienia
+ * naraz, a parsowane przez std::from_chars. Przy odczycie tekst dzielony
+ * jest na porcje na granicach wierszy: w pierwszym przebiegu każda porcja
+ * liczy swoje rekordy (wiersze lub wartości), w drugim - parsuje je
+ * bezpośrednio na właściwe pozycje macierzy, więc oba przebiegi mogą
+ * działać równolegle w thread_pool::instance().
+ */
+template <typename T>
+class matrix_text {
+    private:
+        /**
+         * \brief Parsuje formaty whitespace i csv.
+         * \param delim ',' dla CSV, ' ' dla wartości oddzielonych odstępami.
+         */
+        static basic_matrix<T> parseDense(const char* first, const char* last, char delim, bool parallel);
+
+        /**
+         * \brief Parsuje format Matrix Market (array lub coordinate; general lub symmetric).
+         */
+        static basic_matrix<T> parseMarket(const char* first, const char* last, bool parallel);
+
+    public:
+        /**
+         * \brief Obsługiwane formaty tekstowe.
+         */
+        enum class format {
+            whitespace,   ///< Wiersz macierzy w linii, wartości oddzielone spacjami lub tabulatorami.
+            csv,          ///< Wiersz macierzy w linii, wartości oddzielone przecinkami.
+            matrix_market ///< Matrix Market: zapis "array general" kolumnami; odczyt także "coordinate", "pattern" i "symmetric".
+        };
+
+        /**
+         * \brief Zapisuje macierz do strumienia.
+         * \param m Macierz.
+         * \param out Strumień wyjściowy.
+         * \param f Format.
+         * \param parallel Czy formatować porcje wierszy równolegle.
+         *
+         * Błędy zapisu sygnalizowane są stanem strumienia.
+         */
+        static void write(const basic_matrix<T>& m, std::ostream& out, format f = format::whitespace, bool parallel = true);
+
+        /**
+         * \brief Zapisuje macierz do pliku.
+         * \param m Macierz.
+         * \param path Ścieżka pliku (nadpisywanego).
+         * \param f Format.
+         * \param parallel Czy formatować porcje wierszy równolegle.
+         * \throw std::runtime_error Gdy pliku nie da się utworzyć lub zapisać.
+         */
+        static void write(const basic_matrix<T>& m, const std::string& path, format f = format::whitespace, bool parallel = true);
+
+        /**
+         * \brief Parsuje macierz z tekstu w pamięci.
+         *
+         * W formatach whitespace i csv puste linie są pomijane, a liczba
+         * kolumn wyznaczana jest z pierwszej niepustej linii.
+         * \param first Początek tekstu.
+         * \param last Koniec tekstu.
+         * \param f Format.
+         * \param parallel Czy parsować porcje tekstu równolegle.
+         * \return Macierz.
+         * \throw std::runtime_error Przy błędzie składni, wartości spoza zakresu T lub niezgodnej liczbie wartości.
+         */
+        static basic_matrix<T> parse(const char* first, const char* last, format f = format::whitespace, bool parallel = true);
+
+        /**
+         * \brief Wczytuje macierz ze strumienia (w całości do pamięci, potem parse()).
+         * \param in Strumień wejściowy.
+         * \param f Format.
+         * \param parallel Czy parsować porcje tekstu równolegle.
+         * \return Macierz.
+         * \throw std::runtime_error Przy błędzie odczytu lub składni.
+         */
+        static basic_matrix<T> read(std::istream& in, format f = format::whitespace, bool parallel = true);
+
+        /**
+         * \brief Wczytuje macierz z pliku.
+         * \param path Ścieżka pliku.
+         * \param f Format.
+         * \param parallel Czy parsować porcje tekstu równolegle.
+         * \return Macierz.
+         * \throw std::runtime_error Gdy pliku nie da się otworzyć lub przy błędzie składni.
+         */
+        static basic_matrix<T> read(const std::string& path, format f = format::whitespace, bool parallel = true);
+};
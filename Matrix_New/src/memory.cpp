@@ -0,0 +1,382 @@
+﻿#include "memory.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+/**
+* \brief Alokuje wyrównany blok pamięci.
+* \param bytes Liczba bajtów do zaalokowania.
+* \param alignment Wyrównanie w bajtach (potęga dwójki).
+* \return Wskaźnik na wyrównany blok; rzuca std::bad_alloc przy braku pamięci.
+*/
+void* alignedAlloc(std::size_t bytes, std::size_t alignment) {
+    if (bytes == 0) {
+        bytes = alignment;
+    }
+#ifdef _MSC_VER
+    void* p = _aligned_malloc(bytes, alignment);
+#else
+    void* p = nullptr;
+    if (posix_memalign(&p, alignment, bytes) != 0) {
+        p = nullptr;
+    }
+#endif
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+/**
+* \brief Zwalnia blok pamięci zaalokowany przez alignedAlloc.
+* \param p Wskaźnik na blok (może być nullptr).
+*/
+void alignedFree(void* p) {
+#ifdef _MSC_VER
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+const int pool_allocator::CLASSES;
+const std::size_t pool_allocator::MIN_BLOCK;
+
+/// Alokator ustawiony dla bieżącego wątku (nullptr - pula globalna).
+static thread_local allocator* threadAllocator = nullptr;
+
+/**
+* \brief Zwraca wspólną instancję.
+* \return Referencja do alokatora.
+*/
+heap_allocator& heap_allocator::instance() {
+    static heap_allocator* heap = new heap_allocator();
+    return *heap;
+}
+
+/**
+* \brief Alokuje wyrównany blok pamięci.
+* \param bytes Liczba bajtów.
+* \param alignment Wyrównanie w bajtach (potęga dwójki).
+* \return Wskaźnik na blok; rzuca std::bad_alloc przy braku pamięci.
+*/
+void* heap_allocator::allocate(std::size_t bytes, std::size_t alignment) {
+    return alignedAlloc(bytes, alignment);
+}
+
+/**
+* \brief Zwraca blok pamięci.
+* \param p Wskaźnik zwrócony przez allocate() (może być nullptr).
+* \param bytes Rozmiar podany przy alokacji.
+* \param alignment Wyrównanie podane przy alokacji.
+*/
+void heap_allocator::deallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept {
+    (void)bytes;
+    (void)alignment;
+    alignedFree(p);
+}
+
+/**
+* \brief Wyznacza klasę rozmiaru.
+*
+* Dla 2^e < bytes <= 2^(e+1) klasy mają rozmiary 2^e * (1 + q/4), q = 1..4.
+* \param bytes Żądany rozmiar.
+* \param rounded Rozmiar bloku klasy.
+* \return Numer klasy lub -1, gdy blok jest za duży na pulę.
+*/
+int pool_allocator::sizeClass(std::size_t bytes, std::size_t& rounded) {
+    if (bytes <= MIN_BLOCK) {
+        rounded = MIN_BLOCK;
+        return 0;
+    }
+    int e = 0;
+    for (std::size_t v = bytes - 1; v > 1; v >>= 1) {
+        ++e;
+    }
+    if (e >= 30) {
+        rounded = bytes;
+        return -1;
+    }
+    const std::size_t base = std::size_t(1) << e;
+    const std::size_t step = base / 4;
+    const std::size_t q = (bytes - base + step - 1) / step;
+    rounded = base + q * step;
+    return (e - 6) * 4 + static_cast<int>(q);
+}
+
+/**
+* \brief Zwraca globalną pulę, domyślny alokator macierzy.
+* \return Referencja do puli.
+*/
+pool_allocator& pool_allocator::instance() {
+    static pool_allocator* pool = new pool_allocator();
+    return *pool;
+}
+
+/**
+* \brief Konstruktor.
+* \param cacheLimit Największy łączny rozmiar przechowywanych wolnych bloków w bajtach.
+*/
+pool_allocator::pool_allocator(std::size_t cacheLimit) : cached(0), limit(cacheLimit), heapCalls(0) {}
+
+/**
+* \brief Destruktor; oddaje wolne bloki systemowi.
+*/
+pool_allocator::~pool_allocator() {
+    trim();
+}
+
+/**
+* \brief Alokuje blok z listy wolnych bloków klasy lub, gdy jest pusta, z alignedAlloc.
+* \param bytes Liczba bajtów.
+* \param alignment Wyrównanie w bajtach (potęga dwójki).
+* \return Wskaźnik na blok; rzuca std::bad_alloc przy braku pamięci.
+*/
+void* pool_allocator::allocate(std::size_t bytes, std::size_t alignment) {
+    std::size_t rounded = 0;
+    const int c = sizeClass(bytes, rounded);
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (c >= 0 && alignment <= MIN_BLOCK && !freeLists[c].empty()) {
+            void* p = freeLists[c].back();
+            freeLists[c].pop_back();
+            cached -= rounded;
+            return p;
+        }
+        ++heapCalls;
+    }
+    if (c < 0 || alignment > MIN_BLOCK) {
+        return alignedAlloc(bytes, alignment);
+    }
+    return alignedAlloc(rounded, MIN_BLOCK);
+}
+
+/**
+* \brief Odkłada blok na listę wolnych bloków klasy lub, powyżej limitu, zwalnia go.
+* \param p Wskaźnik zwrócony przez allocate() (może być nullptr).
+* \param bytes Rozmiar podany przy alokacji.
+* \param alignment Wyrównanie podane przy alokacji.
+*/
+void pool_allocator::deallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept {
+    if (p == nullptr) {
+        return;
+    }
+    std::size_t rounded = 0;
+    const int c = sizeClass(bytes, rounded);
+    if (c >= 0 && alignment <= MIN_BLOCK) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (cached + rounded <= limit) {
+            try {
+                freeLists[c].push_back(p);
+                cached += rounded;
+                return;
+            } catch (...) {
+            }
+        }
+    }
+    alignedFree(p);
+}
+
+/**
+* \brief Oddaje systemowi wszystkie wolne bloki.
+*/
+void pool_allocator::trim() {
+    std::vector<void*> released;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        for (int c = 0; c < CLASSES; ++c) {
+            released.insert(released.end(), freeLists[c].begin(), freeLists[c].end());
+            freeLists[c].clear();
+        }
+        cached = 0;
+    }
+    for (void* p : released) {
+        alignedFree(p);
+    }
+}
+
+/**
+* \brief Ustawia limit rozmiaru przechowywanych wolnych bloków.
+*
+* Nadmiar zwalniany jest od największych klas.
+* \param bytes Limit w bajtach.
+*/
+void pool_allocator::setLimit(std::size_t bytes) {
+    std::vector<void*> released;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        limit = bytes;
+        for (int c = CLASSES - 1; c >= 0 && cached > limit; --c) {
+            const int e = c == 0 ? 6 : (c - 1) / 4 + 6;
+            const std::size_t q = c == 0 ? 0 : (c - 1) % 4 + 1;
+            const std::size_t rounded = c == 0 ? MIN_BLOCK : (std::size_t(1) << e) + q * ((std::size_t(1) << e) / 4);
+            while (!freeLists[c].empty() && cached > limit) {
+                released.push_back(freeLists[c].back());
+                freeLists[c].pop_back();
+                cached -= rounded;
+            }
+        }
+    }
+    for (void* p : released) {
+        alignedFree(p);
+    }
+}
+
+/**
+* \brief Zwraca limit rozmiaru przechowywanych wolnych bloków.
+* \return Limit w bajtach.
+*/
+std::size_t pool_allocator::getLimit() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return limit;
+}
+
+/**
+* \brief Zwraca łączny rozmiar przechowywanych wolnych bloków.
+* \return Rozmiar w bajtach.
+*/
+std::size_t pool_allocator::getCached() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return cached;
+}
+
+/**
+* \brief Zwraca liczbę alokacji, których pula nie obsłużyła z list wolnych bloków.
+* \return Liczba wywołań alignedAlloc.
+*/
+std::size_t pool_allocator::getHeapCalls() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return heapCalls;
+}
+
+/**
+* \brief Konstruktor.
+* \param chunkBytes Domyślny rozmiar fragmentu w bajtach.
+* \param source Alokator nadrzędny.
+*/
+arena_allocator::arena_allocator(std::size_t chunkBytes, allocator& source)
+    : upstream(source), chunkSize(chunkBytes), current(0), top(nullptr), last(nullptr) {}
+
+/**
+* \brief Destruktor; oddaje fragmenty alokatorowi nadrzędnemu.
+*/
+arena_allocator::~arena_allocator() {
+    release();
+}
+
+/**
+* \brief Wycina blok z bieżącego fragmentu, w razie potrzeby przechodząc do kolejnego lub pobierając nowy.
+* \param bytes Liczba bajtów.
+* \param alignment Wyrównanie w bajtach (potęga dwójki).
+* \return Wskaźnik na blok; rzuca std::bad_alloc przy braku pamięci.
+*/
+void* arena_allocator::allocate(std::size_t bytes, std::size_t alignment) {
+    while (current < chunks.size()) {
+        const chunk& ch = chunks[current];
+        const std::uintptr_t address = (reinterpret_cast<std::uintptr_t>(top) + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+        char* p = reinterpret_cast<char*>(address);
+        if (p >= top && static_cast<std::size_t>(ch.begin + ch.size - p) >= bytes) {
+            last = p;
+            top = p + bytes;
+            return p;
+        }
+        if (++current < chunks.size()) {
+            top = chunks[current].begin;
+        }
+    }
+    const std::size_t size = std::max(chunkSize, bytes + alignment);
+    chunk ch;
+    ch.begin = static_cast<char*>(upstream.allocate(size, 64));
+    ch.size = size;
+    try {
+        chunks.push_back(ch);
+    } catch (...) {
+        upstream.deallocate(ch.begin, size, 64);
+        throw;
+    }
+    current = chunks.size() - 1;
+    top = ch.begin;
+    return allocate(bytes, alignment);
+}
+
+/**
+* \brief Cofa wskaźnik areny, jeśli p jest ostatnio wydanym blokiem; inne bloki czekają na reset().
+* \param p Wskaźnik zwrócony przez allocate() (może być nullptr).
+* \param bytes Rozmiar podany przy alokacji.
+* \param alignment Wyrównanie podane przy alokacji.
+*/
+void arena_allocator::deallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept {
+    (void)alignment;
+    if (p != nullptr && p == last && last + bytes == top) {
+        top = last;
+        last = nullptr;
+    }
+}
+
+/**
+* \brief Unieważnia wszystkie wydane bloki, zachowując fragmenty do ponownego użycia.
+*/
+void arena_allocator::reset() {
+    current = 0;
+    top = chunks.empty() ? nullptr : chunks[0].begin;
+    last = nullptr;
+}
+
+/**
+* \brief Unieważnia wszystkie wydane bloki i oddaje fragmenty alokatorowi nadrzędnemu.
+*/
+void arena_allocator::release() {
+    for (const chunk& ch : chunks) {
+        upstream.deallocate(ch.begin, ch.size, 64);
+    }
+    chunks.clear();
+    reset();
+}
+
+/**
+* \brief Zwraca łączny rozmiar pobranych fragmentów.
+* \return Rozmiar w bajtach.
+*/
+std::size_t arena_allocator::getReserved() const {
+    std::size_t total = 0;
+    for (const chunk& ch : chunks) {
+        total += ch.size;
+    }
+    return total;
+}
+
+/**
+* \brief Zwraca alokator używany przez bieżący wątek dla nowych macierzy.
+* \return Alokator ustawiony przez setAllocator() lub pool_allocator::instance().
+*/
+allocator& currentAllocator() {
+    return threadAllocator != nullptr ? *threadAllocator : pool_allocator::instance();
+}
+
+/**
+* \brief Ustawia alokator bieżącego wątku dla nowych macierzy.
+* \param a Alokator (nullptr - przywraca pool_allocator::instance()).
+* \return Poprzednio ustawiony alokator (nullptr, jeśli domyślny).
+*/
+allocator* setAllocator(allocator* a) {
+    allocator* previous = threadAllocator;
+    threadAllocator = a;
+    return previous;
+}
+
+/**
+* \brief Konstruktor; ustawia arenę jako alokator bieżącego wątku.
+* \param chunkBytes Domyślny rozmiar fragmentu areny w bajtach.
+*/
+scoped_arena::scoped_arena(std::size_t chunkBytes) : arena(chunkBytes), previous(setAllocator(&arena)) {}
+
+/**
+* \brief Destruktor; przywraca poprzedni alokator i zwalnia arenę.
+*/
+scoped_arena::~scoped_arena() {
+    setAllocator(previous);
+}
\ No newline at end of file
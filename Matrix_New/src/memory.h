@@ -0,0 +1,264 @@
+﻿#pragma once
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+/**
+ * \brief Alokuje wyrównany blok pamięci.
+ * \param bytes Liczba bajtów do zaalokowania.
+ * \param alignment Wyrównanie w bajtach (potęga dwójki).
+ * \return Wskaźnik na wyrównany blok; rzuca std::bad_alloc przy braku pamięci.
+ */
+void* alignedAlloc(std::size_t bytes, std::size_t alignment);
+
+/**
+ * \brief Zwalnia blok pamięci zaalokowany przez alignedAlloc.
+ * \param p Wskaźnik na blok (może być nullptr).
+ */
+void alignedFree(void* p);
+
+/**
+ * \class allocator
+ * \brief Interfejs źródła pamięci dla buforów macierzy i buforów roboczych.
+ *
+ * Bloki zwracane są z tym samym rozmiarem i wyrównaniem, z jakimi zostały
+ * zaalokowane.
+ */
+class allocator {
+    public:
+        /**
+         * \brief Destruktor.
+         */
+        virtual ~allocator() {}
+
+        /**
+         * \brief Alokuje wyrównany blok pamięci.
+         * \param bytes Liczba bajtów.
+         * \param alignment Wyrównanie w bajtach (potęga dwójki).
+         * \return Wskaźnik na blok; rzuca std::bad_alloc przy braku pamięci.
+         */
+        virtual void* allocate(std::size_t bytes, std::size_t alignment) = 0;
+
+        /**
+         * \brief Zwraca blok pamięci.
+         * \param p Wskaźnik zwrócony przez allocate() (może być nullptr).
+         * \param bytes Rozmiar podany przy alokacji.
+         * \param alignment Wyrównanie podane przy alokacji.
+         */
+        virtual void deallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept = 0;
+};
+
+/**
+ * \class heap_allocator
+ * \brief Alokator bez buforowania: każde wywołanie trafia do alignedAlloc/alignedFree.
+ */
+class heap_allocator : public allocator {
+    public:
+        /**
+         * \brief Zwraca wspólną instancję.
+         * \return Referencja do alokatora.
+         */
+        static heap_allocator& instance();
+
+        void* allocate(std::size_t bytes, std::size_t alignment) override;
+        void deallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept override;
+};
+
+/**
+ * \class pool_allocator
+ * \brief Pula buforów w klasach rozmiarów, współdzielona przez wątki.
+ *
+ * Rozmiary zaokrąglane są w górę do klasy (cztery klasy na każdą potęgę
+ * dwójki, od 64 B do 1 GiB, więc narzut nie przekracza 25%). Zwolnione
+ * bloki trafiają na listę wolnych bloków swojej klasy i są ponownie
+ * wydawane bez wywołania alokatora systemowego, dopóki łączny rozmiar
+ * przechowywanych bloków nie przekracza limitu. Większe bloki i wyrównania
+ * powyżej 64 B obsługuje bezpośrednio alignedAlloc.
+ */
+class pool_allocator : public allocator {
+    private:
+        static const int CLASSES = 97;            ///< Liczba klas rozmiarów.
+        static const std::size_t MIN_BLOCK = 64;  ///< Najmniejszy blok i największe obsługiwane wyrównanie.
+
+        std::vector<void*> freeLists[CLASSES]; ///< Wolne bloki każdej klasy.
+        std::size_t cached;     ///< Łączny rozmiar wolnych bloków w bajtach.
+        std::size_t limit;      ///< Największy dopuszczalny rozmiar wolnych bloków w bajtach.
+        std::size_t heapCalls;  ///< Liczba alokacji przekazanych do alignedAlloc.
+        mutable std::mutex lock; ///< Chroni listy i liczniki.
+
+        /**
+         * \brief Wyznacza klasę rozmiaru.
+         * \param bytes Żądany rozmiar.
+         * \param rounded Rozmiar bloku klasy.
+         * \return Numer klasy lub -1, gdy blok jest za duży na pulę.
+         */
+        static int sizeClass(std::size_t bytes, std::size_t& rounded);
+
+    public:
+        /**
+         * \brief Zwraca globalną pulę, domyślny alokator macierzy.
+         *
+         * Pula nie jest niszczona przy zakończeniu programu, więc mogą
+         * z niej korzystać także obiekty statyczne.
+         * \return Referencja do puli.
+         */
+        static pool_allocator& instance();
+
+        /**
+         * \brief Konstruktor.
+         * \param cacheLimit Największy łączny rozmiar przechowywanych wolnych bloków w bajtach.
+         */
+        explicit pool_allocator(std::size_t cacheLimit = std::size_t(256) << 20);
+
+        pool_allocator(const pool_allocator&) = delete;
+        pool_allocator& operator=(const pool_allocator&) = delete;
+
+        /**
+         * \brief Destruktor; oddaje wolne bloki systemowi.
+         */
+        ~pool_allocator();
+
+        void* allocate(std::size_t bytes, std::size_t alignment) override;
+        void deallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept override;
+
+        /**
+         * \brief Oddaje systemowi wszystkie wolne bloki.
+         */
+        void trim();
+
+        /**
+         * \brief Ustawia limit rozmiaru przechowywanych wolnych bloków (nadmiar jest zwalniany).
+         * \param bytes Limit w bajtach.
+         */
+        void setLimit(std::size_t bytes);
+
+        /**
+         * \brief Zwraca limit rozmiaru przechowywanych wolnych bloków.
+         * \return Limit w bajtach.
+         */
+        std::size_t getLimit() const;
+
+        /**
+         * \brief Zwraca łączny rozmiar przechowywanych wolnych bloków.
+         * \return Rozmiar w bajtach.
+         */
+        std::size_t getCached() const;
+
+        /**
+         * \brief Zwraca liczbę alokacji, których pula nie obsłużyła z list wolnych bloków.
+         *
+         * W pętli w stanie ustalonym licznik przestaje rosnąć.
+         * \return Liczba wywołań alignedAlloc.
+         */
+        std::size_t getHeapCalls() const;
+};
+
+/**
+ * \class arena_allocator
+ * \brief Alokator przyrostowy: bloki wycinane są kolejno z dużych fragmentów.
+ *
+ * deallocate() cofa wskaźnik tylko dla ostatnio wydanego bloku; pozostała
+ * pamięć odzyskiwana jest naraz przez reset() lub release(). Fragmenty
+ * pobierane są z alokatora nadrzędnego (domyślnie pool_allocator::instance()).
+ * Nie jest bezpieczny wielowątkowo.
+ */
+class arena_allocator : public allocator {
+    private:
+        /**
+         * \brief Fragment pamięci areny.
+         */
+        struct chunk {
+            char* begin;      ///< Początek fragmentu.
+            std::size_t size; ///< Rozmiar fragmentu w bajtach.
+        };
+
+        allocator& upstream;       ///< Źródło fragmentów.
+        std::size_t chunkSize;     ///< Domyślny rozmiar fragmentu.
+        std::vector<chunk> chunks; ///< Pobrane fragmenty.
+        std::size_t current;       ///< Indeks fragmentu, z którego wycinane są bloki.
+        char* top;                 ///< Pierwszy wolny bajt bieżącego fragmentu.
+        char* last;                ///< Początek ostatnio wydanego bloku.
+
+    public:
+        /**
+         * \brief Konstruktor.
+         * \param chunkBytes Domyślny rozmiar fragmentu w bajtach.
+         * \param source Alokator nadrzędny.
+         */
+        explicit arena_allocator(std::size_t chunkBytes = std::size_t(1) << 20, allocator& source = pool_allocator::instance());
+
+        arena_allocator(const arena_allocator&) = delete;
+        arena_allocator& operator=(const arena_allocator&) = delete;
+
+        /**
+         * \brief Destruktor; oddaje fragmenty alokatorowi nadrzędnemu.
+         */
+        ~arena_allocator();
+
+        void* allocate(std::size_t bytes, std::size_t alignment) override;
+        void deallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept override;
+
+        /**
+         * \brief Unieważnia wszystkie wydane bloki, zachowując fragmenty do ponownego użycia.
+         */
+        void reset();
+
+        /**
+         * \brief Unieważnia wszystkie wydane bloki i oddaje fragmenty alokatorowi nadrzędnemu.
+         */
+        void release();
+
+        /**
+         * \brief Zwraca łączny rozmiar pobranych fragmentów.
+         * \return Rozmiar w bajtach.
+         */
+        std::size_t getReserved() const;
+};
+
+/**
+ * \brief Zwraca alokator używany przez bieżący wątek dla nowych macierzy.
+ * \return Alokator ustawiony przez setAllocator() lub pool_allocator::instance().
+ */
+allocator& currentAllocator();
+
+/**
+ * \brief Ustawia alokator bieżącego wątku dla nowych macierzy.
+ * \param a Alokator (nullptr - przywraca pool_allocator::instance()).
+ * \return Poprzednio ustawiony alokator (nullptr, jeśli domyślny).
+ */
+allocator* setAllocator(allocator* a);
+
+/**
+ * \class scoped_arena
+ * \brief Arena ustawiana jako alokator bieżącego wątku na czas życia obiektu.
+ *
+ * Wszystkie macierze i bufory tymczasowe utworzone w zasięgu korzystają
+ * z areny, a destruktor zwalnia je naraz i przywraca poprzedni alokator.
+ * Macierze zaalokowane w zasięgu nie mogą go przeżyć.
+ */
+class scoped_arena {
+    private:
+        arena_allocator arena; ///< Arena zasięgu.
+        allocator* previous;   ///< Alokator wątku sprzed utworzenia zasięgu.
+
+    public:
+        /**
+         * \brief Konstruktor; ustawia arenę jako alokator bieżącego wątku.
+         * \param chunkBytes Domyślny rozmiar fragmentu areny w bajtach.
+         */
+        explicit scoped_arena(std::size_t chunkBytes = std::size_t(1) << 20);
+
+        scoped_arena(const scoped_arena&) = delete;
+        scoped_arena& operator=(const scoped_arena&) = delete;
+
+        /**
+         * \brief Destruktor; przywraca poprzedni alokator i zwalnia arenę.
+         */
+        ~scoped_arena();
+
+        /**
+         * \brief Zwraca arenę zasięgu.
+         * \return Referencja do areny.
+         */
+        arena_allocator& get() { return arena; }
+};
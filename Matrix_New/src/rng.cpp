@@ -0,0 +1,324 @@
+﻿#include "rng.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+* \brief Liczy bloki first..first+n-1 (dla attempt == 0) do bufora 4 * n słów.
+* \param first Numer pierwszego bloku.
+* \param n Liczba bloków (co najwyżej BLOCKS).
+* \param out Bufor wyjściowy.
+*/
+void rng::philox4x32::blocks(std::uint64_t first, int n, std::uint32_t* out) const {
+    std::uint32_t c0[BLOCKS];
+    std::uint32_t c1[BLOCKS];
+    std::uint32_t c2[BLOCKS];
+    std::uint32_t c3[BLOCKS];
+    for (int b = 0; b < n; ++b) {
+        c0[b] = static_cast<std::uint32_t>(first + b);
+        c1[b] = static_cast<std::uint32_t>((first + b) >> 32);
+        c2[b] = 0;
+        c3[b] = 0;
+    }
+    std::uint32_t k0 = key0;
+    std::uint32_t k1 = key1;
+    for (int round = 0; round < 10; ++round) {
+        for (int b = 0; b < n; ++b) {
+            const std::uint64_t p0 = std::uint64_t(0xD2511F53u) * c0[b];
+            const std::uint64_t p1 = std::uint64_t(0xCD9E8D57u) * c2[b];
+            const std::uint32_t n0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1[b] ^ k0;
+            const std::uint32_t n2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3[b] ^ k1;
+            c1[b] = static_cast<std::uint32_t>(p1);
+            c3[b] = static_cast<std::uint32_t>(p0);
+            c0[b] = n0;
+            c2[b] = n2;
+        }
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+    for (int b = 0; b < n; ++b) {
+        out[4 * b] = c0[b];
+        out[4 * b + 1] = c1[b];
+        out[4 * b + 2] = c2[b];
+        out[4 * b + 3] = c3[b];
+    }
+}
+
+/**
+* \brief Zwraca ziarno początkowe z std::random_device.
+* \return Ziarno.
+*/
+static std::uint64_t deviceSeed() {
+    std::random_device rd;
+    return (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+}
+
+/**
+* \brief Zwraca globalne ziarno (inicjowane przy pierwszym użyciu).
+* \return Referencja do ziarna.
+*/
+static std::atomic<std::uint64_t>& globalSeed() {
+    static std::atomic<std::uint64_t> seed(deviceSeed());
+    return seed;
+}
+
+/// Licznik strumieni globalnego ziarna.
+static std::atomic<std::uint64_t> streamCounter(0);
+
+/**
+* \brief Ustawia globalne ziarno i zeruje licznik strumieni.
+* \param seed Ziarno.
+*/
+void rng::setSeed(std::uint64_t seed) {
+    globalSeed() = seed;
+    streamCounter = 0;
+}
+
+/**
+* \brief Zwraca globalne ziarno.
+* \return Ziarno.
+*/
+std::uint64_t rng::getSeed() {
+    return globalSeed();
+}
+
+/**
+* \brief Zwraca kolejny numer strumienia dla globalnego ziarna.
+* \return Numer strumienia.
+*/
+std::uint64_t rng::nextStream() {
+    return streamCounter.fetch_add(1);
+}
+
+/**
+* \brief Przekształcenie słów losowych w wartości elementów.
+*
+* Każdy element zużywa words słów 32-bitowych. Wartość może zostać
+* odrzucona (losowanie liczb całkowitych bez obciążenia) - wtedy element
+* losowany jest ponownie z kolejnych słów.
+*/
+template <typename T>
+struct sampler {
+    /**
+     * \brief Rodzaje przekształceń.
+     */
+    enum class kind {
+        narrow, ///< Liczby całkowite z przedziału co najwyżej 2^32 wartości (jedno słowo).
+        wide,   ///< Liczby całkowite z szerszego przedziału (dwa słowa, maska i odrzucanie).
+        real,   ///< Liczby zmiennoprzecinkowe z [a, b).
+        gauss   ///< Rozkład normalny (dwa słowa).
+    };
+
+    kind k;                   ///< Rodzaj przekształcenia.
+    int words;                ///< Liczba słów na element.
+    std::int64_t low;         ///< Najmniejsza wartość całkowita.
+    std::uint64_t range;      ///< Liczba wartości całkowitych (0 oznacza 2^64).
+    std::uint64_t threshold;  ///< Próg odrzucania dla narrow, maska dla wide.
+    double a;                 ///< Dolna granica lub średnia.
+    double b;                 ///< Górna granica lub odchylenie.
+
+    /**
+    * \brief Przygotowuje przekształcenie dla parametrów o.
+    * \param o Parametry losowania.
+    */
+    explicit sampler(const rng::options& o) : k(kind::real), words(1), low(0), range(0), threshold(0), a(o.a), b(o.b) {
+        if (o.dist == rng::distribution::normal) {
+            if (!(o.b >= 0)) {
+                throw std::invalid_argument("random fill: negative standard deviation");
+            }
+            k = kind::gauss;
+            words = 2;
+        } else if (std::is_integral<T>::value) {
+            const double lo = std::max(std::ceil(o.a), static_cast<double>(std::numeric_limits<T>::min()));
+            const double hi = std::min(std::floor(o.b), static_cast<double>(std::numeric_limits<T>::max()));
+            if (!(lo <= hi)) {
+                throw std::invalid_argument("random fill: empty range");
+            }
+            low = static_cast<std::int64_t>(lo);
+            // Dla int64_t granice typu nie są dokładnie reprezentowalne jako double.
+            const std::int64_t high = hi >= 9.2233720368547758e18 ? std::numeric_limits<std::int64_t>::max() : static_cast<std::int64_t>(hi);
+            range = static_cast<std::uint64_t>(high) - static_cast<std::uint64_t>(low) + 1;
+            if (range != 0 && range <= (std::uint64_t(1) << 32)) {
+                k = kind::narrow;
+                threshold = (std::uint64_t(1) << 32) % range;
+            } else {
+                k = kind::wide;
+                words = 2;
+                threshold = ~std::uint64_t(0);
+                if (range != 0) {
+                    int bits = 64;
+                    while (bits > 0 && ((range - 1) >> (bits - 1)) == 0) {
+                        --bits;
+                    }
+                    threshold = bits == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << bits) - 1;
+                }
+            }
+        } else {
+            if (!(o.a <= o.b)) {
+                throw std::invalid_argument("random fill: empty range");
+            }
+            words = sizeof(T) > 4 ? 2 : 1;
+        }
+    }
+
+    /**
+    * \brief Przekształca słowa jednego elementu.
+    * \param w Słowa.
+    * \param out Wartość elementu.
+    * \return false, jeśli wartość została odrzucona.
+    */
+    bool operator()(const std::uint32_t* w, T& out) const {
+        switch (k) {
+            case kind::narrow: {
+                const std::uint64_t m = static_cast<std::uint64_t>(w[0]) * range;
+                out = static_cast<T>(low + static_cast<std::int64_t>(m >> 32));
+                return static_cast<std::uint32_t>(m) >= threshold;
+            }
+            case kind::wide: {
+                const std::uint64_t x = (static_cast<std::uint64_t>(w[1]) << 32 | w[0]) & threshold;
+                out = static_cast<T>(static_cast<std::int64_t>(static_cast<std::uint64_t>(low) + x));
+                return range == 0 || x < range;
+            }
+            case kind::real: {
+                const double u = words == 1
+                    ? (w[0] >> 8) * (1.0 / 16777216.0)
+                    : ((static_cast<std::uint64_t>(w[1]) << 32 | w[0]) >> 11) * (1.0 / 9007199254740992.0);
+                out = static_cast<T>(a + u * (b - a));
+                if (out >= b && a < b) {
+                    out = std::nextafter(static_cast<T>(b), static_cast<T>(a));
+                }
+                return true;
+            }
+            default: {
+                const double u1 = (w[0] + 1.0) * (1.0 / 4294967296.0);
+                const double u2 = w[1] * (1.0 / 4294967296.0);
+                const double v = a + b * std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+                if (std::is_integral<T>::value) {
+                    const double r = std::round(v);
+                    if (r <= static_cast<double>(std::numeric_limits<T>::min())) {
+                        out = std::numeric_limits<T>::min();
+                    } else if (r >= static_cast<double>(std::numeric_limits<T>::max())) {
+                        out = std::numeric_limits<T>::max();
+                    } else {
+                        out = static_cast<T>(r);
+                    }
+                } else {
+                    out = static_cast<T>(v);
+                }
+                return true;
+            }
+        }
+    }
+
+    /**
+    * \brief Przekształca n elementów; pętla dla narrow i real jest wektoryzowana.
+    * \param w Słowa (words * n).
+    * \param out Wartości.
+    * \param n Liczba elementów.
+    * \return false, jeśli któraś wartość została odrzucona.
+    */
+    bool run(const std::uint32_t* w, T* out, int n) const {
+        if (k == kind::narrow) {
+            std::uint32_t rejected = 0;
+            for (int i = 0; i < n; ++i) {
+                const std::uint64_t m = static_cast<std::uint64_t>(w[i]) * range;
+                out[i] = static_cast<T>(low + static_cast<std::int64_t>(m >> 32));
+                rejected |= static_cast<std::uint32_t>(m) < threshold;
+            }
+            return rejected == 0;
+        }
+        bool ok = true;
+        for (int i = 0; i < n; ++i) {
+            ok &= (*this)(w + i * words, out[i]);
+        }
+        return ok;
+    }
+};
+
+/// Liczba elementów przekształcanych naraz (bloki Philox mieszczą się w BLOCKS).
+static const int BATCH = 64;
+
+/**
+* \brief Wypełnia bufor rows x cols wartościami losowymi.
+* \param data Bufor.
+* \param rows Liczba wierszy.
+* \param cols Liczba kolumn.
+* \param ld Odstęp między wierszami w elementach.
+* \param o Rozkład i generator.
+* \param seed Ziarno.
+* \param stream Numer strumienia.
+*/
+template <typename T>
+void rng::fill(T* data, int rows, int cols, int ld, const options& o, std::uint64_t seed, std::uint64_t stream) {
+    const sampler<T> s(o);
+    if (rows <= 0 || cols <= 0) {
+        return;
+    }
+    const std::uint64_t key = streamKey(seed, stream);
+    const std::uint64_t total = static_cast<std::uint64_t>(rows) * cols;
+    const int tasks = static_cast<int>((total + CHUNK - 1) / CHUNK);
+    const int words = s.words;
+    const int perBlock = 4 / words;
+    const philox4x32 philox(key);
+    thread_pool::instance().parallelFor(tasks, [&](int t) {
+        std::uint32_t buffer[4 * philox4x32::BLOCKS];
+        xoshiro256 xoshiro(streamKey(key, static_cast<std::uint64_t>(t)));
+        const std::uint64_t last = std::min(total, static_cast<std::uint64_t>(t + 1) * CHUNK);
+        for (std::uint64_t e = static_cast<std::uint64_t>(t) * CHUNK; e < last; ) {
+            const int i = static_cast<int>(e / cols);
+            const int j = static_cast<int>(e % cols);
+            const int n = static_cast<int>(std::min<std::uint64_t>({ static_cast<std::uint64_t>(BATCH), static_cast<std::uint64_t>(cols - j), last - e }));
+            T* out = data + static_cast<std::ptrdiff_t>(i) * ld + j;
+            const std::uint32_t* w = buffer;
+            if (o.gen == engine::philox) {
+                const std::uint64_t first = e / perBlock;
+                philox.blocks(first, static_cast<int>((e + n - 1) / perBlock - first + 1), buffer);
+                w = buffer + (e - first * perBlock) * words;
+            } else {
+                for (int q = 0; q < n * words; q += 2) {
+                    const std::uint64_t x = xoshiro();
+                    buffer[q] = static_cast<std::uint32_t>(x);
+                    buffer[q + 1] = static_cast<std::uint32_t>(x >> 32);
+                }
+            }
+            if (!s.run(w, out, n)) {
+                // Rzadkie odrzucenia losowane są ponownie: Philox z kolejnym numerem próby bloku, xoshiro z dalszej części ciągu.
+                for (int q = 0; q < n; ++q) {
+                    if (s(w + q * words, out[q])) {
+                        continue;
+                    }
+                    const std::uint64_t element = e + q;
+                    for (std::uint32_t attempt = 1; ; ++attempt) {
+                        std::uint32_t redraw[4];
+                        const std::uint32_t* r = redraw;
+                        if (o.gen == engine::philox) {
+                            const std::array<std::uint32_t, 4> block = philox(element / perBlock, attempt);
+                            std::copy(block.begin(), block.end(), redraw);
+                            r = redraw + (element % perBlock) * words;
+                        } else {
+                            const std::uint64_t x = xoshiro();
+                            redraw[0] = static_cast<std::uint32_t>(x);
+                            redraw[1] = static_cast<std::uint32_t>(x >> 32);
+                        }
+                        if (s(r, out[q])) {
+                            break;
+                        }
+                    }
+                }
+            }
+            e += n;
+        }
+    });
+}
+
+template void rng::fill<std::int8_t>(std::int8_t*, int, int, int, const options&, std::uint64_t, std::uint64_t);
+template void rng::fill<std::int16_t>(std::int16_t*, int, int, int, const options&, std::uint64_t, std::uint64_t);
+template void rng::fill<std::int32_t>(std::int32_t*, int, int, int, const options&, std::uint64_t, std::uint64_t);
+template void rng::fill<std::int64_t>(std::int64_t*, int, int, int, const options&, std::uint64_t, std::uint64_t);
+template void rng::fill<float>(float*, int, int, int, const options&, std::uint64_t, std::uint64_t);
+template void rng::fill<double>(double*, int, int, int, const options&, std::uint64_t, std::uint64_t);
\ No newline at end of file
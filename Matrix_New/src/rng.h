@@ -0,0 +1,243 @@
+﻿#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * \namespace rng
+ * \brief Generatory liczb losowych i równoległe wypełnianie buforów.
+ *
+ * Wartość każdego elementu zależy wyłącznie od ziarna, numeru strumienia
+ * i pozycji elementu, więc wynik fill() jest identyczny niezależnie od
+ * liczby wątków puli. Liczby całkowite losowane są bez obciążenia
+ * (mnożenie z odrzucaniem Lemire'a), a nie przez resztę z dzielenia.
+ */
+namespace rng {
+
+    /**
+     * \brief Dostępne generatory.
+     */
+    enum class engine {
+        philox, ///< Philox4x32-10: licznikowy, każdy element liczony niezależnie (wektoryzowany).
+        xoshiro ///< xoshiro256++: sekwencyjny, osobny stan dla każdej porcji CHUNK elementów.
+    };
+
+    /**
+     * \brief Dostępne rozkłady.
+     */
+    enum class distribution {
+        uniform, ///< Jednostajny: liczby całkowite z [a, b], zmiennoprzecinkowe z [a, b).
+        normal   ///< Normalny o średniej a i odchyleniu b (Box-Muller; dla typów całkowitych zaokrąglany).
+    };
+
+    /**
+     * \brief Parametry losowania.
+     */
+    struct options {
+        distribution dist; ///< Rozkład.
+        double a;          ///< Dolna granica lub średnia.
+        double b;          ///< Górna granica lub odchylenie standardowe.
+        engine gen;        ///< Generator.
+
+        /**
+         * \brief Rozkład jednostajny.
+         * \param low Dolna granica.
+         * \param high Górna granica (włącznie dla typów całkowitych).
+         * \param g Generator.
+         * \return Parametry.
+         */
+        static options uniform(double low, double high, engine g = engine::philox) {
+            return options{ distribution::uniform, low, high, g };
+        }
+
+        /**
+         * \brief Rozkład normalny.
+         * \param mean Średnia.
+         * \param stddev Odchylenie standardowe.
+         * \param g Generator.
+         * \return Parametry.
+         */
+        static options normal(double mean, double stddev, engine g = engine::philox) {
+            return options{ distribution::normal, mean, stddev, g };
+        }
+    };
+
+    const std::size_t CHUNK = std::size_t(1) << 14; ///< Liczba elementów jednego zadania fill() (i jednego stanu xoshiro).
+
+    /**
+     * \brief Krok generatora SplitMix64 (używany do wyprowadzania kluczy i stanów).
+     * \param state Stan, przesuwany o jeden krok.
+     * \return Kolejna 64-bitowa wartość.
+     */
+    inline std::uint64_t splitmix64(std::uint64_t& state) {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * \brief Wyprowadza klucz generatora z ziarna i numeru strumienia.
+     * \param seed Ziarno.
+     * \param stream Numer strumienia.
+     * \return Klucz.
+     */
+    inline std::uint64_t streamKey(std::uint64_t seed, std::uint64_t stream) {
+        std::uint64_t s = stream;
+        return seed ^ splitmix64(s);
+    }
+
+    /**
+     * \class philox4x32
+     * \brief Licznikowy generator Philox4x32-10 (Salmon i in., 2011).
+     *
+     * Dla klucza i 128-bitowego licznika zwraca cztery niezależne słowa
+     * 32-bitowe; nie ma stanu, więc bloki można liczyć w dowolnej kolejności.
+     */
+    class philox4x32 {
+        private:
+            std::uint32_t key0; ///< Młodsza połowa klucza.
+            std::uint32_t key1; ///< Starsza połowa klucza.
+
+        public:
+            /**
+             * \brief Konstruktor.
+             * \param key Klucz.
+             */
+            explicit philox4x32(std::uint64_t key)
+                : key0(static_cast<std::uint32_t>(key)), key1(static_cast<std::uint32_t>(key >> 32)) {}
+
+            /**
+             * \brief Liczy blok dla licznika (counter, attempt).
+             * \param counter Numer bloku.
+             * \param attempt Numer dodatkowego losowania tego samego bloku (np. po odrzuceniu).
+             * \return Cztery słowa losowe.
+             */
+            std::array<std::uint32_t, 4> operator()(std::uint64_t counter, std::uint32_t attempt = 0) const {
+                std::uint32_t c0 = static_cast<std::uint32_t>(counter);
+                std::uint32_t c1 = static_cast<std::uint32_t>(counter >> 32);
+                std::uint32_t c2 = attempt;
+                std::uint32_t c3 = 0;
+                std::uint32_t k0 = key0;
+                std::uint32_t k1 = key1;
+                for (int round = 0; round < 10; ++round) {
+                    const std::uint64_t p0 = std::uint64_t(0xD2511F53u) * c0;
+                    const std::uint64_t p1 = std::uint64_t(0xCD9E8D57u) * c2;
+                    const std::uint32_t n0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1 ^ k0;
+                    const std::uint32_t n2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3 ^ k1;
+                    c1 = static_cast<std::uint32_t>(p1);
+                    c3 = static_cast<std::uint32_t>(p0);
+                    c0 = n0;
+                    c2 = n2;
+                    k0 += 0x9E3779B9u;
+                    k1 += 0xBB67AE85u;
+                }
+                return { c0, c1, c2, c3 };
+            }
+
+            /**
+             * \brief Liczy bloki first..first+n-1 (dla attempt == 0) do bufora 4 * n słów.
+             *
+             * Pętle przebiegają po blokach wewnątrz każdej rundy, więc kompilator
+             * wektoryzuje je (mnożenie 32 x 32 -> 64 bity).
+             * \param first Numer pierwszego bloku.
+             * \param n Liczba bloków (co najwyżej BLOCKS).
+             * \param out Bufor wyjściowy.
+             */
+            void blocks(std::uint64_t first, int n, std::uint32_t* out) const;
+
+            static const int BLOCKS = 64; ///< Największa liczba bloków jednego wywołania blocks().
+    };
+
+    /**
+     * \class xoshiro256
+     * \brief Generator xoshiro256++ (Blackman, Vigna).
+     */
+    class xoshiro256 {
+        private:
+            std::uint64_t s[4]; ///< Stan.
+
+            static std::uint64_t rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+        public:
+            /**
+             * \brief Konstruktor; stan wyprowadzany jest z ziarna generatorem SplitMix64.
+             * \param seed Ziarno.
+             */
+            explicit xoshiro256(std::uint64_t seed) {
+                for (std::uint64_t& v : s) {
+                    v = splitmix64(seed);
+                }
+            }
+
+            /**
+             * \brief Zwraca kolejną wartość.
+             * \return 64 losowe bity.
+             */
+            std::uint64_t operator()() {
+                const std::uint64_t result = rotl(s[0] + s[3], 23) + s[0];
+                const std::uint64_t t = s[1] << 17;
+                s[2] ^= s[0];
+                s[3] ^= s[1];
+                s[1] ^= s[2];
+                s[0] ^= s[3];
+                s[2] ^= t;
+                s[3] = rotl(s[3], 45);
+                return result;
+            }
+
+            /**
+             * \brief Losuje liczbę z [0, n) bez obciążenia.
+             * \param n Górna granica (> 0).
+             * \return Wartość.
+             */
+            std::uint64_t below(std::uint64_t n) {
+                const std::uint64_t limit = (0 - n) % n;
+                for (;;) {
+                    const std::uint64_t x = (*this)();
+                    if (x >= limit) {
+                        return x % n;
+                    }
+                }
+            }
+    };
+
+    /**
+     * \brief Ustawia globalne ziarno i zeruje licznik strumieni.
+     *
+     * Po ustawieniu ziarna kolejne wywołania randomize() dają powtarzalny
+     * ciąg macierzy. Domyślne ziarno pochodzi z std::random_device.
+     * \param seed Ziarno.
+     */
+    void setSeed(std::uint64_t seed);
+
+    /**
+     * \brief Zwraca globalne ziarno.
+     * \return Ziarno.
+     */
+    std::uint64_t getSeed();
+
+    /**
+     * \brief Zwraca kolejny numer strumienia dla globalnego ziarna (bezpieczne wielowątkowo).
+     * \return Numer strumienia.
+     */
+    std::uint64_t nextStream();
+
+    /**
+     * \brief Wypełnia bufor rows x cols wartościami losowymi.
+     *
+     * Elementy numerowane są wierszami (i * cols + j) i dzielone na zadania
+     * po CHUNK elementów wykonywane przez thread_pool::instance(). Granice
+     * rozkładu jednostajnego są obcinane do zakresu typu T.
+     * \param data Bufor.
+     * \param rows Liczba wierszy.
+     * \param cols Liczba kolumn.
+     * \param ld Odstęp między wierszami w elementach.
+     * \param o Rozkład i generator.
+     * \param seed Ziarno.
+     * \param stream Numer strumienia.
+     * \throw std::invalid_argument Gdy przedział rozkładu jednostajnego jest pusty lub odchylenie ujemne.
+     */
+    template <typename T>
+    void fill(T* data, int rows, int cols, int ld, const options& o, std::uint64_t seed, std::uint64_t stream);
+}
@@ -0,0 +1,495 @@
+﻿#include "simd.h"
+#include <atomic>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MATRIX_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMD_TARGET(x) __attribute__((target(x)))
+#else
+#define SIMD_TARGET(x)
+#endif
+
+namespace simd {
+
+    // Wersje ogólne (skalarne, wektoryzowane przez kompilator).
+
+    template <typename T>
+    static void addGeneric(T* dst, const T* src, std::size_t n, T a) {
+        for (std::size_t i = 0; i < n; ++i) dst[i] = static_cast<T>(src[i] + a);
+    }
+
+    template <typename T>
+    static void subGeneric(T* dst, const T* src, std::size_t n, T a) {
+        for (std::size_t i = 0; i < n; ++i) dst[i] = static_cast<T>(src[i] - a);
+    }
+
+    template <typename T>
+    static void rsubGeneric(T* dst, const T* src, std::size_t n, T a) {
+        for (std::size_t i = 0; i < n; ++i) dst[i] = static_cast<T>(a - src[i]);
+    }
+
+    template <typename T>
+    static void mulGeneric(T* dst, const T* src, std::size_t n, T a) {
+        for (std::size_t i = 0; i < n; ++i) dst[i] = static_cast<T>(src[i] * a);
+    }
+
+    template <typename T>
+    static void fillGeneric(T* dst, std::size_t n, T value) {
+        for (std::size_t i = 0; i < n; ++i) dst[i] = value;
+    }
+
+    template <typename T>
+    static void alternateGeneric(T* dst, std::size_t n, T value) {
+        const std::size_t first = value != T(0) ? 1 : 0;
+        for (std::size_t i = 0; i < n; ++i) dst[i] = static_cast<T>((first + i) % 2);
+    }
+
+    template <typename T>
+    static void transpose8Generic(const T* src, std::ptrdiff_t lds, T* dst, std::ptrdiff_t ldd) {
+        T block[8][8];
+        for (int i = 0; i < 8; ++i) {
+            for (int j = 0; j < 8; ++j) block[j][i] = src[i * lds + j];
+        }
+        for (int i = 0; i < 8; ++i) {
+            for (int j = 0; j < 8; ++j) dst[i * ldd + j] = block[i][j];
+        }
+    }
+
+    template <typename T>
+    static const kernels<T>& genericKernels() {
+        static const kernels<T> table = {
+            level::scalar, addGeneric<T>, subGeneric<T>, rsubGeneric<T>, mulGeneric<T>,
+            fillGeneric<T>, alternateGeneric<T>, transpose8Generic<T>
+        };
+        return table;
+    }
+
+    static void addScalar(int* dst, const int* src, std::size_t n, int a) { addGeneric(dst, src, n, a); }
+    static void subScalar(int* dst, const int* src, std::size_t n, int a) { subGeneric(dst, src, n, a); }
+    static void rsubScalar(int* dst, const int* src, std::size_t n, int a) { rsubGeneric(dst, src, n, a); }
+    static void mulScalar(int* dst, const int* src, std::size_t n, int a) { mulGeneric(dst, src, n, a); }
+    static void fillScalar(int* dst, std::size_t n, int value) { fillGeneric(dst, n, value); }
+    static void alternateScalar(int* dst, std::size_t n, int value) { alternateGeneric(dst, n, value); }
+
+#ifdef MATRIX_SIMD_X86
+
+    // Wersje SSE4.2 (128 bitów, 4 elementy).
+
+    SIMD_TARGET("sse4.2")
+    static void addSse(int* dst, const int* src, std::size_t n, int a) {
+        const __m128i va = _mm_set1_epi32(a);
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi32(v, va));
+        }
+        addScalar(dst + i, src + i, n - i, a);
+    }
+
+    SIMD_TARGET("sse4.2")
+    static void subSse(int* dst, const int* src, std::size_t n, int a) {
+        const __m128i va = _mm_set1_epi32(a);
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_sub_epi32(v, va));
+        }
+        subScalar(dst + i, src + i, n - i, a);
+    }
+
+    SIMD_TARGET("sse4.2")
+    static void rsubSse(int* dst, const int* src, std::size_t n, int a) {
+        const __m128i va = _mm_set1_epi32(a);
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_sub_epi32(va, v));
+        }
+        rsubScalar(dst + i, src + i, n - i, a);
+    }
+
+    SIMD_TARGET("sse4.2")
+    static void mulSse(int* dst, const int* src, std::size_t n, int a) {
+        const __m128i va = _mm_set1_epi32(a);
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_mullo_epi32(v, va));
+        }
+        mulScalar(dst + i, src + i, n - i, a);
+    }
+
+    SIMD_TARGET("sse4.2")
+    static void fillSse(int* dst, std::size_t n, int value) {
+        const __m128i v = _mm_set1_epi32(value);
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+        }
+        fillScalar(dst + i, n - i, value);
+    }
+
+    SIMD_TARGET("sse4.2")
+    static void alternateSse(int* dst, std::size_t n, int value) {
+        const __m128i v = value % 2 ? _mm_setr_epi32(1, 0, 1, 0) : _mm_setr_epi32(0, 1, 0, 1);
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+        }
+        alternateScalar(dst + i, n - i, value);
+    }
+
+    /**
+    * \brief Transpozycja bloku 8 x 8 jako czterech bloków 4 x 4 w rejestrach SSE.
+    */
+    SIMD_TARGET("sse4.2")
+    static void transpose8Sse(const int* src, std::ptrdiff_t lds, int* dst, std::ptrdiff_t ldd) {
+        __m128i r[8][2];
+        for (int i = 0; i < 8; ++i) {
+            r[i][0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * lds));
+            r[i][1] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * lds + 4));
+        }
+        for (int bi = 0; bi < 2; ++bi) {
+            for (int bj = 0; bj < 2; ++bj) {
+                __m128i* q[4] = { &r[4 * bi][bj], &r[4 * bi + 1][bj], &r[4 * bi + 2][bj], &r[4 * bi + 3][bj] };
+                const __m128i t0 = _mm_unpacklo_epi32(*q[0], *q[1]);
+                const __m128i t1 = _mm_unpacklo_epi32(*q[2], *q[3]);
+                const __m128i t2 = _mm_unpackhi_epi32(*q[0], *q[1]);
+                const __m128i t3 = _mm_unpackhi_epi32(*q[2], *q[3]);
+                *q[0] = _mm_unpacklo_epi64(t0, t1);
+                *q[1] = _mm_unpackhi_epi64(t0, t1);
+                *q[2] = _mm_unpacklo_epi64(t2, t3);
+                *q[3] = _mm_unpackhi_epi64(t2, t3);
+            }
+        }
+        for (int i = 0; i < 8; ++i) {
+            // Wiersz i wyniku: kolumna i wejścia, czyli wiersz (i % 4) transponowanych bloków (0, i / 4) i (1, i / 4).
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * ldd), r[i % 4][i / 4]);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * ldd + 4), r[4 + i % 4][i / 4]);
+        }
+    }
+
+    static const kernels<int> sseKernels = {
+        level::sse42, addSse, subSse, rsubSse, mulSse, fillSse, alternateSse, transpose8Sse
+    };
+
+    // Wersje AVX2 (256 bitów, 8 elementów).
+
+    SIMD_TARGET("avx2")
+    static void addAvx2(int* dst, const int* src, std::size_t n, int a) {
+        const __m256i va = _mm256_set1_epi32(a);
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_add_epi32(v, va));
+        }
+        addScalar(dst + i, src + i, n - i, a);
+    }
+
+    SIMD_TARGET("avx2")
+    static void subAvx2(int* dst, const int* src, std::size_t n, int a) {
+        const __m256i va = _mm256_set1_epi32(a);
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_sub_epi32(v, va));
+        }
+        subScalar(dst + i, src + i, n - i, a);
+    }
+
+    SIMD_TARGET("avx2")
+    static void rsubAvx2(int* dst, const int* src, std::size_t n, int a) {
+        const __m256i va = _mm256_set1_epi32(a);
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_sub_epi32(va, v));
+        }
+        rsubScalar(dst + i, src + i, n - i, a);
+    }
+
+    SIMD_TARGET("avx2")
+    static void mulAvx2(int* dst, const int* src, std::size_t n, int a) {
+        const __m256i va = _mm256_set1_epi32(a);
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_mullo_epi32(v, va));
+        }
+        mulScalar(dst + i, src + i, n - i, a);
+    }
+
+    SIMD_TARGET("avx2")
+    static void fillAvx2(int* dst, std::size_t n, int value) {
+        const __m256i v = _mm256_set1_epi32(value);
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+        }
+        fillScalar(dst + i, n - i, value);
+    }
+
+    SIMD_TARGET("avx2")
+    static void alternateAvx2(int* dst, std::size_t n, int value) {
+        const __m256i v = value % 2 ? _mm256_setr_epi32(1, 0, 1, 0, 1, 0, 1, 0)
+                                    : _mm256_setr_epi32(0, 1, 0, 1, 0, 1, 0, 1);
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+        }
+        alternateScalar(dst + i, n - i, value);
+    }
+
+    /**
+    * \brief Transpozycja bloku 8 x 8 w rejestrach AVX2 (unpack 32/64 bity, zamiana połówek 128-bitowych).
+    */
+    SIMD_TARGET("avx2")
+    static void transpose8Avx2(const int* src, std::ptrdiff_t lds, int* dst, std::ptrdiff_t ldd) {
+        __m256i r[8];
+        for (int i = 0; i < 8; ++i) {
+            r[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * lds));
+        }
+        const __m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+        const __m256i t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+        const __m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+        const __m256i t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+        const __m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+        const __m256i t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+        const __m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+        const __m256i t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+        const __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+        const __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+        const __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+        const __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+        const __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+        const __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+        const __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+        const __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+        r[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+        r[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+        r[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+        r[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+        r[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+        r[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+        r[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+        r[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+        for (int i = 0; i < 8; ++i) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * ldd), r[i]);
+        }
+    }
+
+    static const kernels<int> avx2Kernels = {
+        level::avx2, addAvx2, subAvx2, rsubAvx2, mulAvx2, fillAvx2, alternateAvx2, transpose8Avx2
+    };
+
+    // Wersje AVX-512F (512 bitów, 16 elementów, ogony przez maski).
+
+    SIMD_TARGET("avx512f")
+    static void addAvx512(int* dst, const int* src, std::size_t n, int a) {
+        const __m512i va = _mm512_set1_epi32(a);
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            _mm512_storeu_si512(dst + i, _mm512_add_epi32(_mm512_loadu_si512(src + i), va));
+        }
+        const __mmask16 tail = static_cast<__mmask16>((1u << (n - i)) - 1);
+        _mm512_mask_storeu_epi32(dst + i, tail, _mm512_add_epi32(_mm512_maskz_loadu_epi32(tail, src + i), va));
+    }
+
+    SIMD_TARGET("avx512f")
+    static void subAvx512(int* dst, const int* src, std::size_t n, int a) {
+        const __m512i va = _mm512_set1_epi32(a);
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            _mm512_storeu_si512(dst + i, _mm512_sub_epi32(_mm512_loadu_si512(src + i), va));
+        }
+        const __mmask16 tail = static_cast<__mmask16>((1u << (n - i)) - 1);
+        _mm512_mask_storeu_epi32(dst + i, tail, _mm512_sub_epi32(_mm512_maskz_loadu_epi32(tail, src + i), va));
+    }
+
+    SIMD_TARGET("avx512f")
+    static void rsubAvx512(int* dst, const int* src, std::size_t n, int a) {
+        const __m512i va = _mm512_set1_epi32(a);
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            _mm512_storeu_si512(dst + i, _mm512_sub_epi32(va, _mm512_loadu_si512(src + i)));
+        }
+        const __mmask16 tail = static_cast<__mmask16>((1u << (n - i)) - 1);
+        _mm512_mask_storeu_epi32(dst + i, tail, _mm512_sub_epi32(va, _mm512_maskz_loadu_epi32(tail, src + i)));
+    }
+
+    SIMD_TARGET("avx512f")
+    static void mulAvx512(int* dst, const int* src, std::size_t n, int a) {
+        const __m512i va = _mm512_set1_epi32(a);
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            _mm512_storeu_si512(dst + i, _mm512_mullo_epi32(_mm512_loadu_si512(src + i), va));
+        }
+        const __mmask16 tail = static_cast<__mmask16>((1u << (n - i)) - 1);
+        _mm512_mask_storeu_epi32(dst + i, tail, _mm512_mullo_epi32(_mm512_maskz_loadu_epi32(tail, src + i), va));
+    }
+
+    SIMD_TARGET("avx512f")
+    static void fillAvx512(int* dst, std::size_t n, int value) {
+        const __m512i v = _mm512_set1_epi32(value);
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            _mm512_storeu_si512(dst + i, v);
+        }
+        _mm512_mask_storeu_epi32(dst + i, static_cast<__mmask16>((1u << (n - i)) - 1), v);
+    }
+
+    SIMD_TARGET("avx512f")
+    static void alternateAvx512(int* dst, std::size_t n, int value) {
+        const __m512i v = value % 2 ? _mm512_set1_epi64(1) : _mm512_set1_epi64(static_cast<long long>(1) << 32);
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            _mm512_storeu_si512(dst + i, v);
+        }
+        _mm512_mask_storeu_epi32(dst + i, static_cast<__mmask16>((1u << (n - i)) - 1), v);
+    }
+
+    static const kernels<int> avx512Kernels = {
+        level::avx512, addAvx512, subAvx512, rsubAvx512, mulAvx512, fillAvx512, alternateAvx512, transpose8Avx2
+    };
+
+    /**
+    * \brief Wywołuje instrukcję CPUID.
+    */
+    static void cpuid(unsigned leaf, unsigned subleaf, unsigned regs[4]) {
+#if defined(_MSC_VER)
+        int r[4];
+        __cpuidex(r, static_cast<int>(leaf), static_cast<int>(subleaf));
+        for (int i = 0; i < 4; ++i) regs[i] = static_cast<unsigned>(r[i]);
+#else
+        __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    }
+
+    /**
+    * \brief Odczytuje rejestr XCR0 (stany rejestrów zapisywane przez system).
+    */
+    static unsigned long long xcr0() {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        unsigned lo, hi;
+        __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        return (static_cast<unsigned long long>(hi) << 32) | lo;
+#endif
+    }
+
+#endif
+
+    /**
+    * \brief Wykrywa najwyższy zestaw instrukcji obsługiwany przez procesor i system.
+    * \return Wykryty poziom.
+    */
+    level detect() {
+#ifdef MATRIX_SIMD_X86
+        unsigned r[4];
+        cpuid(0, 0, r);
+        const unsigned maxLeaf = r[0];
+        if (maxLeaf < 1) {
+            return level::scalar;
+        }
+        cpuid(1, 0, r);
+        const bool sse42 = (r[2] & (1u << 20)) != 0;
+        const bool osxsave = (r[2] & (1u << 27)) != 0;
+        const bool avx = (r[2] & (1u << 28)) != 0;
+        if (!sse42) {
+            return level::scalar;
+        }
+        if (!osxsave || !avx || maxLeaf < 7) {
+            return level::sse42;
+        }
+        const unsigned long long xcr = xcr0();
+        if ((xcr & 0x6) != 0x6) {
+            return level::sse42;
+        }
+        cpuid(7, 0, r);
+        const bool avx2 = (r[1] & (1u << 5)) != 0;
+        const bool avx512f = (r[1] & (1u << 16)) != 0;
+        if (avx512f && (xcr & 0xE6) == 0xE6) {
+            return level::avx512;
+        }
+        return avx2 ? level::avx2 : level::sse42;
+#else
+        return level::scalar;
+#endif
+    }
+
+    /**
+    * \brief Zwraca tablicę jąder dla danego poziomu.
+    */
+    static const kernels<int>* table(level l) {
+#ifdef MATRIX_SIMD_X86
+        switch (l) {
+        case level::avx512: return &avx512Kernels;
+        case level::avx2: return &avx2Kernels;
+        case level::sse42: return &sseKernels;
+        default: break;
+        }
+#else
+        (void)l;
+#endif
+        return &genericKernels<int>();
+    }
+
+    /**
+    * \brief Zwraca wskaźnik na aktywną tablicę (inicjalizowany przy pierwszym użyciu).
+    */
+    static std::atomic<const kernels<int>*>& current() {
+        static std::atomic<const kernels<int>*> selected(table(detect()));
+        return selected;
+    }
+
+    /**
+    * \brief Zwraca aktywną tablicę jąder dla typu T.
+    * \return Tablica jąder.
+    */
+    template <typename T>
+    const kernels<T>& active() {
+        return genericKernels<T>();
+    }
+
+    /**
+    * \brief Zwraca aktywną tablicę jąder int (wybraną przez detect() lub setLevel()).
+    * \return Tablica jąder.
+    */
+    template <>
+    const kernels<int>& active<int>() {
+        return *current().load(std::memory_order_relaxed);
+    }
+
+    template const kernels<std::int8_t>& active<std::int8_t>();
+    template const kernels<std::int16_t>& active<std::int16_t>();
+    template const kernels<std::int64_t>& active<std::int64_t>();
+    template const kernels<float>& active<float>();
+    template const kernels<double>& active<double>();
+
+    /**
+    * \brief Wymusza zestaw instrukcji jąder int (np. skalarny do testów).
+    * \param l Żądany poziom; obcinany do poziomu wykrytego przez detect().
+    */
+    void setLevel(level l) {
+        const level best = detect();
+        current() = table(static_cast<int>(l) > static_cast<int>(best) ? best : l);
+    }
+
+    /**
+    * \brief Zwraca aktywny zestaw instrukcji jąder int.
+    * \return Aktywny poziom.
+    */
+    level getLevel() {
+        return active<int>().isa;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * \namespace simd
+ * \brief Wektorowe jądra operacji element po elemencie z wyborem zestawu instrukcji w czasie działania.
+ *
+ * Zestaw instrukcji wykrywany jest (CPUID) przy pierwszym użyciu; zawsze
+ * dostępna jest wersja skalarna.
+ */
+namespace simd {
+
+    /**
+     * \brief Poziomy zestawów instrukcji.
+     */
+    enum class level {
+        scalar, ///< Zwykłe pętle skalarne.
+        sse42,  ///< SSE4.2 (128 bitów).
+        avx2,   ///< AVX2 (256 bitów).
+        avx512  ///< AVX-512F (512 bitów).
+    };
+
+    /**
+     * \brief Jądro dwuargumentowe: dst[i] = f(src[i], a). Dopuszcza dst == src.
+     */
+    template <typename T>
+    using binaryKernel = void (*)(T* dst, const T* src, std::size_t n, T a);
+
+    /**
+     * \brief Jądro wypełniające n elementów dst.
+     */
+    template <typename T>
+    using fillKernel = void (*)(T* dst, std::size_t n, T value);
+
+    /**
+     * \brief Jądro transpozycji bloku 8 x 8: dst[j][i] = src[i][j].
+     *
+     * Odstępy podawane są w elementach. Blok jest wczytywany w całości przed
+     * zapisem, więc dopuszczalne jest src == dst (transpozycja w miejscu).
+     */
+    template <typename T>
+    using transposeKernel = void (*)(const T* src, std::ptrdiff_t lds, T* dst, std::ptrdiff_t ldd);
+
+    /**
+     * \brief Tablica jąder dla jednego typu elementu i zestawu instrukcji.
+     *
+     * Dla int istnieją ręcznie wektoryzowane wersje SSE4.2/AVX2/AVX-512
+     * wybierane w czasie działania; pozostałe typy (int8_t, int16_t,
+     * int64_t, float, double) używają pętli wektoryzowanych przez kompilator.
+     */
+    template <typename T>
+    struct kernels {
+        level isa;                     ///< Zestaw instrukcji, dla którego skompilowano jądra.
+        binaryKernel<T> add;           ///< dst = src + a.
+        binaryKernel<T> sub;           ///< dst = src - a.
+        binaryKernel<T> rsub;          ///< dst = a - src.
+        binaryKernel<T> mul;           ///< dst = src * a.
+        fillKernel<T> fill;            ///< dst = value.
+        fillKernel<T> alternate;       ///< dst[j] = (value + j) % 2, value to 0 lub 1.
+        transposeKernel<T> transpose8; ///< Transpozycja bloku 8 x 8.
+    };
+
+    /**
+     * \brief Wykrywa najwyższy zestaw instrukcji obsługiwany przez procesor i system.
+     * \return Wykryty poziom.
+     */
+    level detect();
+
+    /**
+     * \brief Zwraca aktywną tablicę jąder dla typu T.
+     * \return Tablica jąder.
+     */
+    template <typename T = int>
+    const kernels<T>& active();
+
+    template <>
+    const kernels<int>& active<int>();
+
+    extern template const kernels<std::int8_t>& active<std::int8_t>();
+    extern template const kernels<std::int16_t>& active<std::int16_t>();
+    extern template const kernels<std::int64_t>& active<std::int64_t>();
+    extern template const kernels<float>& active<float>();
+    extern template const kernels<double>& active<double>();
+
+    /**
+     * \brief Wymusza zestaw instrukcji jąder int (np. skalarny do testów).
+     * \param l Żądany poziom; obcinany do poziomu wykrytego przez detect().
+     */
+    void setLevel(level l);
+
+    /**
+     * \brief Zwraca aktywny zestaw instrukcji jąder int.
+     * \return Aktywny poziom.
+     */
+    level getLevel();
+}
@@ -0,0 +1,475 @@
+﻿#include "sparse.h"
+#include "rng.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <utility>
+
+/// Minimalna liczba elementów niezerowych, od której jądra dzielą pracę między wątki.
+static const int PARALLEL_NNZ = 1 << 15;
+
+/**
+* \brief Wyznacza granicę porcji pracy tak, żeby porcje miały zbliżoną liczbę elementów niezerowych.
+* \param offsets Tablica początków wierszy (major + 1 pozycji).
+* \param major Liczba wierszy.
+* \param chunks Liczba porcji.
+* \param c Numer granicy (0..chunks).
+* \return Pierwszy wiersz porcji c.
+*/
+static int chunkBegin(const std::vector<int>& offsets, int major, int chunks, int c) {
+    if (c >= chunks) {
+        return major;
+    }
+    const long long target = static_cast<long long>(offsets[major]) * c / chunks;
+    return static_cast<int>(std::lower_bound(offsets.begin(), offsets.begin() + major, target) - offsets.begin());
+}
+
+/**
+* \brief Wykonuje task(first, last) dla porcji wierszy, równolegle dla dużych macierzy.
+* \param offsets Tablica początków wierszy.
+* \param major Liczba wierszy.
+* \param task Funkcja przetwarzająca wiersze [first, last).
+*/
+template <typename F>
+static void forRows(const std::vector<int>& offsets, int major, const F& task) {
+    thread_pool& pool = thread_pool::instance();
+    const int threads = pool.getThreadCount();
+    if (offsets[major] < PARALLEL_NNZ || threads == 1 || major < 2) {
+        task(0, major);
+        return;
+    }
+    const int chunks = std::min(major, threads * 4);
+    pool.parallelFor(chunks, [&](int c) {
+        task(chunkBegin(offsets, major, chunks, c), chunkBegin(offsets, major, chunks, c + 1));
+    });
+}
+
+/**
+* \brief Iloczyn macierzy rzadkich w formacie CSR algorytmem Gustavsona: C = A * B.
+*
+* Każdy wiersz C zbierany jest w gęstym akumulatorze długości n z listą
+* dotkniętych kolumn, które po posortowaniu trafiają do wyniku.
+* \param m Liczba wierszy A.
+* \param n Liczba kolumn B.
+* \param aOff, aIdx, aVal Struktura CSR macierzy A.
+* \param bOff, bIdx, bVal Struktura CSR macierzy B.
+* \param cOff, cIdx, cVal Struktura CSR wyniku (nadpisywana).
+*/
+template <typename T>
+static void gustavson(int m, int n,
+                      const std::vector<int>& aOff, const std::vector<int>& aIdx, const std::vector<T>& aVal,
+                      const std::vector<int>& bOff, const std::vector<int>& bIdx, const std::vector<T>& bVal,
+                      std::vector<int>& cOff, std::vector<int>& cIdx, std::vector<T>& cVal) {
+    thread_pool& pool = thread_pool::instance();
+    const int chunks = aOff[m] < PARALLEL_NNZ || pool.getThreadCount() == 1 ? 1 : std::min(std::max(m, 1), pool.getThreadCount() * 4);
+    std::vector<std::vector<int>> partIdx(chunks);
+    std::vector<std::vector<T>> partVal(chunks);
+    cOff.assign(m + 1, 0);
+
+    pool.parallelFor(chunks, [&](int c) {
+        const int first = chunkBegin(aOff, m, chunks, c);
+        const int last = chunkBegin(aOff, m, chunks, c + 1);
+        std::vector<T> acc(n, T(0));
+        std::vector<int> mark(n, -1);
+        std::vector<int> touched;
+        std::vector<int>& idx = partIdx[c];
+        std::vector<T>& val = partVal[c];
+        for (int i = first; i < last; ++i) {
+            touched.clear();
+            for (int p = aOff[i]; p < aOff[i + 1]; ++p) {
+                const int k = aIdx[p];
+                const T a = aVal[p];
+                for (int q = bOff[k]; q < bOff[k + 1]; ++q) {
+                    const int j = bIdx[q];
+                    if (mark[j] != i) {
+                        mark[j] = i;
+                        acc[j] = T(0);
+                        touched.push_back(j);
+                    }
+                    acc[j] += a * bVal[q];
+                }
+            }
+            std::sort(touched.begin(), touched.end());
+            for (int j : touched) {
+                idx.push_back(j);
+                val.push_back(acc[j]);
+            }
+            cOff[i + 1] = static_cast<int>(touched.size());
+        }
+    });
+
+    for (int i = 0; i < m; ++i) {
+        cOff[i + 1] += cOff[i];
+    }
+    cIdx.clear();
+    cVal.clear();
+    cIdx.reserve(cOff[m]);
+    cVal.reserve(cOff[m]);
+    for (int c = 0; c < chunks; ++c) {
+        cIdx.insert(cIdx.end(), partIdx[c].begin(), partIdx[c].end());
+        cVal.insert(cVal.end(), partVal[c].begin(), partVal[c].end());
+    }
+}
+
+/**
+* \brief Konstruktor domyślny (macierz 0 x 0).
+*/
+template <typename T>
+sparse_matrix<T>::sparse_matrix() : rows(0), cols(0), storage(format::csr), offsets(1, 0) {}
+
+/**
+* \brief Konstruktor tworzący zerową macierz r x c.
+* \param r Liczba wierszy.
+* \param c Liczba kolumn.
+* \param f Format przechowywania.
+*/
+template <typename T>
+sparse_matrix<T>::sparse_matrix(int r, int c, format f) : rows(r), cols(c), storage(f) {
+    offsets.assign(major() + 1, 0);
+}
+
+/**
+* \brief Konstruktor budujący macierz z listy elementów (sortowanie kubełkowe po wymiarze głównym).
+* \param r Liczba wierszy.
+* \param c Liczba kolumn.
+* \param e Elementy niezerowe w dowolnej kolejności; powtórzenia są sumowane.
+* \param f Format przechowywania.
+*/
+template <typename T>
+sparse_matrix<T>::sparse_matrix(int r, int c, const std::vector<entry>& e, format f) : rows(r), cols(c), storage(f) {
+    const bool csr = storage == format::csr;
+    const int n = major();
+    std::vector<int> start(n + 1, 0);
+    for (const entry& x : e) {
+        if (x.row >= 0 && x.row < rows && x.col >= 0 && x.col < cols) {
+            ++start[(csr ? x.row : x.col) + 1];
+        }
+    }
+    for (int p = 0; p < n; ++p) {
+        start[p + 1] += start[p];
+    }
+    std::vector<std::pair<int, T>> sorted(start[n]);
+    std::vector<int> next(start.begin(), start.end() - 1);
+    for (const entry& x : e) {
+        if (x.row >= 0 && x.row < rows && x.col >= 0 && x.col < cols) {
+            const int p = csr ? x.row : x.col;
+            sorted[next[p]++] = std::make_pair(csr ? x.col : x.row, x.value);
+        }
+    }
+
+    offsets.assign(n + 1, 0);
+    indices.reserve(sorted.size());
+    values.reserve(sorted.size());
+    for (int p = 0; p < n; ++p) {
+        std::sort(sorted.begin() + start[p], sorted.begin() + start[p + 1],
+                  [](const std::pair<int, T>& a, const std::pair<int, T>& b) { return a.first < b.first; });
+        for (int q = start[p]; q < start[p + 1]; ++q) {
+            if (q > start[p] && sorted[q].first == indices.back()) {
+                values.back() += sorted[q].second;
+            } else {
+                indices.push_back(sorted[q].first);
+                values.push_back(sorted[q].second);
+            }
+        }
+        offsets[p + 1] = static_cast<int>(indices.size());
+    }
+}
+
+/**
+* \brief Konstruktor konwertujący z macierzy gęstej (pomija zera).
+* \param m Macierz gęsta.
+* \param f Format przechowywania.
+*/
+template <typename T>
+sparse_matrix<T>::sparse_matrix(const basic_matrix<T>& m, format f) : rows(m.rows), cols(m.cols), storage(format::csr) {
+    offsets.assign(rows + 1, 0);
+    for (int i = 0; i < rows; ++i) {
+        const T* r = m.rowPtr(i);
+        for (int j = 0; j < cols; ++j) {
+            if (r[j] != T(0)) {
+                indices.push_back(j);
+                values.push_back(r[j]);
+            }
+        }
+        offsets[i + 1] = static_cast<int>(indices.size());
+    }
+    if (f != storage) {
+        *this = convert(f);
+    }
+}
+
+/**
+* \brief Zwraca wartość z macierzy na pozycji (x, y) (wyszukiwanie binarne w wierszu/kolumnie).
+* \param x Wiersz.
+* \param y Kolumna.
+* \return Wartość (0 dla elementów nieprzechowywanych i spoza macierzy).
+*/
+template <typename T>
+T sparse_matrix<T>::show(int x, int y) const {
+    if (x < 0 || x >= rows || y < 0 || y >= cols) {
+        return T(0);
+    }
+    const int p = storage == format::csr ? x : y;
+    const int q = storage == format::csr ? y : x;
+    const int* first = indices.data() + offsets[p];
+    const int* last = indices.data() + offsets[p + 1];
+    const int* it = std::lower_bound(first, last, q);
+    return it != last && *it == q ? values[it - indices.data()] : T(0);
+}
+
+/**
+* \brief Zwraca tę samą macierz w zadanym formacie (sortowanie kubełkowe, O(nnz + rows + cols)).
+* \param f Format docelowy.
+* \return Kopia macierzy w formacie f.
+*/
+template <typename T>
+sparse_matrix<T> sparse_matrix<T>::convert(format f) const {
+    if (f == storage) {
+        return *this;
+    }
+    sparse_matrix result(rows, cols, f);
+    const int n = major();
+    const int m = minor();
+    const int nnz = nonZeros();
+    std::vector<int>& off = result.offsets;
+    for (int p = 0; p < nnz; ++p) {
+        ++off[indices[p] + 1];
+    }
+    for (int q = 0; q < m; ++q) {
+        off[q + 1] += off[q];
+    }
+    result.indices.resize(nnz);
+    result.values.resize(nnz);
+    std::vector<int> next(off.begin(), off.end() - 1);
+    for (int p = 0; p < n; ++p) {
+        for (int q = offsets[p]; q < offsets[p + 1]; ++q) {
+            const int dst = next[indices[q]]++;
+            result.indices[dst] = p;
+            result.values[dst] = values[q];
+        }
+    }
+    return result;
+}
+
+/**
+* \brief Transponuje macierz w O(1): CSR staje się CSC z zamienionymi wymiarami i odwrotnie.
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+sparse_matrix<T>& sparse_matrix<T>::transpose() {
+    std::swap(rows, cols);
+    storage = storage == format::csr ? format::csc : format::csr;
+    return *this;
+}
+
+/**
+* \brief Zamienia macierz na gęstą.
+* \return Macierz gęsta rows x cols.
+*/
+template <typename T>
+basic_matrix<T> sparse_matrix<T>::toDense() const {
+    basic_matrix<T> result(rows, cols);
+    const int n = major();
+    for (int p = 0; p < n; ++p) {
+        for (int q = offsets[p]; q < offsets[p + 1]; ++q) {
+            if (storage == format::csr) {
+                result.rowPtr(p)[indices[q]] = values[q];
+            } else {
+                result.rowPtr(indices[q])[p] = values[q];
+            }
+        }
+    }
+    return result;
+}
+
+/**
+* \brief Ustawia wartości na k-tej przekątnej macierzy (pozostałe zeruje), bez sortowania.
+* \param k Numer przekątnej.
+* \param t Tablica wartości do ustawienia na przekątnej.
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+sparse_matrix<T>& sparse_matrix<T>::diagonal_k(int k, const T* t) {
+    const int r0 = k < 0 ? -k : 0;
+    const int c0 = k > 0 ? k : 0;
+    const int n = std::max(0, std::min(rows - r0, cols - c0));
+    const int major0 = storage == format::csr ? r0 : c0;
+    const int minor0 = storage == format::csr ? c0 : r0;
+    const int m = major();
+    offsets.resize(m + 1);
+    for (int p = 0; p <= m; ++p) {
+        offsets[p] = std::min(std::max(p - major0, 0), n);
+    }
+    indices.resize(n);
+    values.resize(n);
+    for (int d = 0; d < n; ++d) {
+        indices[d] = minor0 + d;
+        values[d] = t != nullptr ? t[d] : T(1);
+    }
+    return *this;
+}
+
+/**
+* \brief Ustawia wartości na przekątnej macierzy (pozostałe zeruje).
+* \param t Tablica min(rows, cols) wartości do ustawienia na przekątnej.
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+sparse_matrix<T>& sparse_matrix<T>::diagonal(const T* t) {
+    return diagonal_k(0, t);
+}
+
+/**
+* \brief Ustawia wartości na głównej przekątnej macierzy na 1 (pozostałe zeruje).
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+sparse_matrix<T>& sparse_matrix<T>::diagonal() {
+    return diagonal_k(0, nullptr);
+}
+
+/**
+* \brief Losowo wypełnia x elementów macierzy wartościami od 1 do 9 (pozostałe zeruje).
+* \param x Liczba losowanych pozycji (powtórzenia są sumowane).
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+sparse_matrix<T>& sparse_matrix<T>::randomize(int x) {
+    if (rows == 0 || cols == 0) {
+        return *this;
+    }
+    rng::xoshiro256 gen(rng::streamKey(rng::getSeed(), rng::nextStream()));
+    std::vector<entry> e(x > 0 ? x : 0);
+    for (entry& v : e) {
+        v.row = static_cast<int>(gen.below(rows));
+        v.col = static_cast<int>(gen.below(cols));
+        v.value = static_cast<T>(gen.below(9) + 1);
+    }
+    *this = sparse_matrix(rows, cols, e, storage);
+    return *this;
+}
+
+/**
+* \brief Iloczyn macierz rzadka - wektor (SpMV): y = A * x.
+* \param x Wektor cols wartości.
+* \param y Wektor rows wartości na wynik (nie może pokrywać się z x).
+*/
+template <typename T>
+void sparse_matrix<T>::multiply(const T* x, T* y) const {
+    if (storage == format::csr) {
+        forRows(offsets, rows, [&](int first, int last) {
+            for (int i = first; i < last; ++i) {
+                T sum = T(0);
+                for (int p = offsets[i]; p < offsets[i + 1]; ++p) {
+                    sum += values[p] * x[indices[p]];
+                }
+                y[i] = sum;
+            }
+        });
+        return;
+    }
+    std::fill(y, y + rows, T(0));
+    for (int j = 0; j < cols; ++j) {
+        const T xj = x[j];
+        for (int p = offsets[j]; p < offsets[j + 1]; ++p) {
+            y[indices[p]] += values[p] * xj;
+        }
+    }
+}
+
+/**
+* \brief Iloczyn macierz rzadka - macierz gęsta (SpMM).
+*
+* Każdy element niezerowy a(i, k) dodaje a(i, k) * B[k][*] do C[i][*];
+* wewnętrzna pętla po wierszu B jest ciągła i wektoryzowana.
+* \param b Macierz gęsta cols x n.
+* \return Macierz gęsta rows x n.
+*/
+template <typename T>
+basic_matrix<T> sparse_matrix<T>::multiply(const basic_matrix<T>& b) const {
+    if (cols != b.rows) {
+        throw std::invalid_argument("sparse multiplication: inner dimensions differ");
+    }
+    basic_matrix<T> result(rows, b.cols);
+    const int n = b.cols;
+    if (storage == format::csr) {
+        forRows(offsets, rows, [&](int first, int last) {
+            for (int i = first; i < last; ++i) {
+                T* c = result.rowPtr(i);
+                for (int p = offsets[i]; p < offsets[i + 1]; ++p) {
+                    const T a = values[p];
+                    const T* r = b.rowPtr(indices[p]);
+                    for (int j = 0; j < n; ++j) {
+                        c[j] += a * r[j];
+                    }
+                }
+            }
+        });
+        return result;
+    }
+    for (int k = 0; k < cols; ++k) {
+        const T* r = b.rowPtr(k);
+        for (int p = offsets[k]; p < offsets[k + 1]; ++p) {
+            const T a = values[p];
+            T* c = result.rowPtr(indices[p]);
+            for (int j = 0; j < n; ++j) {
+                c[j] += a * r[j];
+            }
+        }
+    }
+    return result;
+}
+
+/**
+* \brief Iloczyn dwóch macierzy rzadkich (algorytm Gustavsona).
+*
+* Dla CSC liczony jest iloczyn transpozycji C^T = B^T * A^T, bo struktura
+* CSC macierzy jest strukturą CSR jej transpozycji; konwersja potrzebna
+* jest tylko przy różnych formatach argumentów.
+* \param b Macierz rzadka cols x n (dowolny format).
+* \return Macierz rzadka rows x n w formacie *this.
+*/
+template <typename T>
+sparse_matrix<T> sparse_matrix<T>::multiply(const sparse_matrix& b) const {
+    if (cols != b.rows) {
+        throw std::invalid_argument("sparse multiplication: inner dimensions differ");
+    }
+    sparse_matrix converted;
+    const sparse_matrix* other = &b;
+    if (b.storage != storage) {
+        converted = b.convert(storage);
+        other = &converted;
+    }
+    sparse_matrix result(rows, b.cols, storage);
+    if (storage == format::csr) {
+        gustavson(rows, b.cols, offsets, indices, values, other->offsets, other->indices, other->values,
+                  result.offsets, result.indices, result.values);
+    } else {
+        gustavson(b.cols, rows, other->offsets, other->indices, other->values, offsets, indices, values,
+                  result.offsets, result.indices, result.values);
+    }
+    return result;
+}
+
+/**
+* \brief Operator porównania macierzy (niezależny od formatu).
+* \param m Macierz do porównania.
+* \return true jeśli macierze mają te same wymiary i przechowywane elementy.
+*/
+template <typename T>
+bool sparse_matrix<T>::operator==(const sparse_matrix& m) const {
+    if (rows != m.rows || cols != m.cols) return false;
+    if (m.storage != storage) {
+        return *this == m.convert(storage);
+    }
+    return offsets == m.offsets && indices == m.indices && values == m.values;
+}
+
+template class sparse_matrix<std::int8_t>;
+template class sparse_matrix<std::int16_t>;
+template class sparse_matrix<std::int32_t>;
+template class sparse_matrix<std::int64_t>;
+template class sparse_matrix<float>;
+template class sparse_matrix<double>;
\ No newline at end of file
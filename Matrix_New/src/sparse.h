@@ -0,0 +1,228 @@
+﻿#pragma once
+#include <cstddef>
+#include <vector>
+#include "matrix.h"
+
+/**
+ * \class sparse_matrix
+ * \brief Macierz rzadka rows x cols w formacie CSR lub CSC.
+ *
+ * Przechowywane są tylko elementy niezerowe: dla CSR wiersz po wierszu
+ * (offsets ma rows + 1 pozycji, indices to numery kolumn), dla CSC kolumna
+ * po kolumnie (offsets ma cols + 1 pozycji, indices to numery wierszy).
+ * Indeksy w obrębie wiersza (kolumny) są rosnące i bez powtórzeń. Liczba
+ * elementów niezerowych musi mieścić się w int.
+ *
+ * Jawnie konkretyzowana dla tych samych typów co basic_matrix.
+ */
+template <typename T>
+class sparse_matrix {
+    public:
+        typedef T value_type; ///< Typ elementu.
+
+        /**
+         * \brief Format przechowywania.
+         */
+        enum class format {
+            csr, ///< Compressed Sparse Row - wierszami.
+            csc  ///< Compressed Sparse Column - kolumnami.
+        };
+
+        /**
+         * \brief Element niezerowy podawany przy budowie macierzy.
+         */
+        struct entry {
+            int row;  ///< Wiersz.
+            int col;  ///< Kolumna.
+            T value;  ///< Wartość.
+        };
+
+    private:
+        int rows; ///< Liczba wierszy.
+        int cols; ///< Liczba kolumn.
+        format storage; ///< Format przechowywania.
+        std::vector<int> offsets; ///< Początki wierszy (CSR) lub kolumn (CSC) w indices/values.
+        std::vector<int> indices; ///< Numery kolumn (CSR) lub wierszy (CSC) elementów.
+        std::vector<T> values; ///< Wartości elementów niezerowych.
+
+        /**
+         * \brief Zwraca liczbę wierszy (CSR) lub kolumn (CSC) struktury.
+         * \return Długość wymiaru głównego.
+         */
+        int major() const { return storage == format::csr ? rows : cols; }
+
+        /**
+         * \brief Zwraca liczbę kolumn (CSR) lub wierszy (CSC) struktury.
+         * \return Długość wymiaru pomocniczego.
+         */
+        int minor() const { return storage == format::csr ? cols : rows; }
+
+    public:
+
+        /**
+         * \brief Konstruktor domyślny (macierz 0 x 0).
+         */
+        sparse_matrix();
+
+        /**
+         * \brief Konstruktor tworzący zerową macierz r x c.
+         * \param r Liczba wierszy.
+         * \param c Liczba kolumn.
+         * \param f Format przechowywania.
+         */
+        sparse_matrix(int r, int c, format f = format::csr);
+
+        /**
+         * \brief Konstruktor budujący macierz z listy elementów.
+         *
+         * Elementy mogą być w dowolnej kolejności; wartości o tych samych
+         * współrzędnych są sumowane, a elementy spoza macierzy pomijane.
+         * \param r Liczba wierszy.
+         * \param c Liczba kolumn.
+         * \param e Elementy niezerowe.
+         * \param f Format przechowywania.
+         */
+        sparse_matrix(int r, int c, const std::vector<entry>& e, format f = format::csr);
+
+        /**
+         * \brief Konstruktor konwertujący z macierzy gęstej (pomija zera).
+         * \param m Macierz gęsta.
+         * \param f Format przechowywania.
+         */
+        explicit sparse_matrix(const basic_matrix<T>& m, format f = format::csr);
+
+        /**
+         * \brief Zwraca liczbę wierszy.
+         * \return Liczba wierszy.
+         */
+        int getRows() const { return rows; }
+
+        /**
+         * \brief Zwraca liczbę kolumn.
+         * \return Liczba kolumn.
+         */
+        int getCols() const { return cols; }
+
+        /**
+         * \brief Zwraca format przechowywania.
+         * \return Format.
+         */
+        format getFormat() const { return storage; }
+
+        /**
+         * \brief Zwraca liczbę przechowywanych elementów niezerowych.
+         * \return Liczba elementów.
+         */
+        int nonZeros() const { return static_cast<int>(values.size()); }
+
+        /**
+         * \brief Zwraca tablicę początków wierszy (CSR) lub kolumn (CSC).
+         * \return Wskaźnik na major() + 1 pozycji.
+         */
+        const int* getOffsets() const { return offsets.data(); }
+
+        /**
+         * \brief Zwraca numery kolumn (CSR) lub wierszy (CSC) elementów.
+         * \return Wskaźnik na nonZeros() pozycji.
+         */
+        const int* getIndices() const { return indices.data(); }
+
+        /**
+         * \brief Zwraca wartości elementów niezerowych.
+         * \return Wskaźnik na nonZeros() pozycji.
+         */
+        const T* getValues() const { return values.data(); }
+
+        /**
+         * \brief Zwraca wartość z macierzy na pozycji (x, y).
+         * \param x Wiersz.
+         * \param y Kolumna.
+         * \return Wartość (0 dla elementów nieprzechowywanych i spoza macierzy).
+         */
+        T show(int x, int y) const;
+
+        /**
+         * \brief Zwraca tę samą macierz w zadanym formacie.
+         * \param f Format docelowy.
+         * \return Kopia macierzy w formacie f (O(nnz + rows + cols)).
+         */
+        sparse_matrix convert(format f) const;
+
+        /**
+         * \brief Transponuje macierz w O(1): CSR staje się CSC z zamienionymi wymiarami i odwrotnie.
+         * \return Referencja do obiektu macierzy.
+         */
+        sparse_matrix& transpose();
+
+        /**
+         * \brief Zamienia macierz na gęstą.
+         * \return Macierz gęsta rows x cols.
+         */
+        basic_matrix<T> toDense() const;
+
+        /**
+         * \brief Ustawia wartości na głównej przekątnej macierzy na 1 (pozostałe zeruje).
+         * \return Referencja do obiektu macierzy.
+         */
+        sparse_matrix& diagonal();
+
+        /**
+         * \brief Ustawia wartości na przekątnej macierzy (pozostałe zeruje).
+         * \param t Tablica min(rows, cols) wartości do ustawienia na przekątnej.
+         * \return Referencja do obiektu macierzy.
+         */
+        sparse_matrix& diagonal(const T* t);
+
+        /**
+         * \brief Ustawia wartości na k-tej przekątnej macierzy (pozostałe zeruje).
+         * \param k Numer przekątnej (dodatni - nad główną, ujemny - pod nią).
+         * \param t Tablica wartości do ustawienia na przekątnej.
+         * \return Referencja do obiektu macierzy.
+         */
+        sparse_matrix& diagonal_k(int k, const T* t);
+
+        /**
+         * \brief Losowo wypełnia x elementów macierzy wartościami od 1 do 9 (pozostałe zeruje).
+         * \param x Liczba losowanych pozycji (powtórzenia są sumowane).
+         * \return Referencja do obiektu macierzy.
+         */
+        sparse_matrix& randomize(int x);
+
+        /**
+         * \brief Iloczyn macierz rzadka - wektor (SpMV): y = A * x.
+         *
+         * Dla CSR wiersze dzielone są między wątki thread_pool::instance().
+         * \param x Wektor cols wartości.
+         * \param y Wektor rows wartości na wynik (nie może pokrywać się z x).
+         */
+        void multiply(const T* x, T* y) const;
+
+        /**
+         * \brief Iloczyn macierz rzadka - macierz gęsta (SpMM).
+         *
+         * Koszt O(nnz * b.cols); dla CSR wiersze dzielone są między wątki.
+         * \param b Macierz gęsta cols x n.
+         * \return Macierz gęsta rows x n.
+         * \throw std::invalid_argument Gdy cols różni się od liczby wierszy b.
+         */
+        basic_matrix<T> multiply(const basic_matrix<T>& b) const;
+
+        /**
+         * \brief Iloczyn dwóch macierzy rzadkich (algorytm Gustavsona).
+         *
+         * Koszt proporcjonalny do liczby wykonanych mnożeń, a nie do
+         * rows * cols. Wynik ma format *this; jawne zera powstałe
+         * z redukcji są zachowywane.
+         * \param b Macierz rzadka cols x n (dowolny format).
+         * \return Macierz rzadka rows x n.
+         * \throw std::invalid_argument Gdy cols różni się od liczby wierszy b.
+         */
+        sparse_matrix multiply(const sparse_matrix& b) const;
+
+        /**
+         * \brief Operator porównania macierzy (niezależny od formatu).
+         * \param m Macierz do porównania.
+         * \return true jeśli macierze mają te same wymiary i przechowywane elementy.
+         */
+        bool operator==(const sparse_matrix& m) const;
+};
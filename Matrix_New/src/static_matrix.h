@@ -0,0 +1,353 @@
+﻿#pragma once
+#include <cstddef>
+#include <initializer_list>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include "matrix.h"
+
+/**
+ * \class basic_static_matrix
+ * \brief Macierz R x C o elementach typu T i wymiarach znanych w czasie kompilacji.
+ *
+ * Elementy przechowywane są wierszami w tablicy wewnątrz obiektu (bez
+ * alokacji). Konstrukcja i arytmetyka są constexpr, a operacje element po
+ * elemencie rozwijane są w czasie kompilacji (std::index_sequence), więc
+ * dla rozmiarów 2 x 2 - 16 x 16 kompilator generuje kod bez pętli.
+ * W odróżnieniu od basic_matrix operatory +, -, * zwracają nową macierz;
+ * wersje złożone (+=, -=, *=) modyfikują obiekt. static_matrix<N> to
+ * basic_static_matrix<int, N, N>.
+ */
+template <typename T, int R, int C = R>
+class basic_static_matrix {
+    static_assert(R > 0 && C > 0, "static matrix: dimensions must be positive");
+
+    public:
+        typedef T value_type; ///< Typ elementu.
+
+    private:
+        T v[R * C]; ///< Elementy macierzy (wierszami).
+
+        template <typename U, int R2, int C2> friend class basic_static_matrix;
+
+        /**
+         * \brief Dodawanie element po elemencie.
+         */
+        struct plus {
+            constexpr T operator()(T a, T b) const { return static_cast<T>(a + b); }
+        };
+
+        /**
+         * \brief Odejmowanie element po elemencie.
+         */
+        struct minus {
+            constexpr T operator()(T a, T b) const { return static_cast<T>(a - b); }
+        };
+
+        /**
+         * \brief Mnożenie element po elemencie.
+         */
+        struct times {
+            constexpr T operator()(T a, T b) const { return static_cast<T>(a * b); }
+        };
+
+        /**
+         * \brief Rozwinięte v[i] = op(v[i], m.v[i]) dla wszystkich elementów.
+         * \param m Drugi argument.
+         * \param op Operacja.
+         */
+        template <typename Op, std::size_t... I>
+        constexpr void zip(const basic_static_matrix& m, Op op, std::index_sequence<I...>) {
+            int unroll[] = { 0, (v[I] = op(v[I], m.v[I]), 0)... };
+            (void)unroll;
+        }
+
+        /**
+         * \brief Rozwinięte v[i] = op(v[i], a) dla wszystkich elementów.
+         * \param a Skalar.
+         * \param op Operacja.
+         */
+        template <typename Op, std::size_t... I>
+        constexpr void map(T a, Op op, std::index_sequence<I...>) {
+            int unroll[] = { 0, (v[I] = op(v[I], a), 0)... };
+            (void)unroll;
+        }
+
+        /**
+         * \brief Rozwinięte dodanie a * (wiersz k macierzy m) do wiersza i.
+         * \param i Wiersz wyniku.
+         * \param a Współczynnik.
+         * \param m Macierz, której wiersz jest dodawany (o C kolumnach).
+         * \param k Wiersz macierzy m.
+         */
+        template <int K, std::size_t... J>
+        constexpr void addRow(int i, T a, const basic_static_matrix<T, K, C>& m, int k, std::index_sequence<J...>) {
+            int unroll[] = { 0, (v[i * C + J] = static_cast<T>(v[i * C + J] + a * m.v[k * C + J]), 0)... };
+            (void)unroll;
+        }
+
+        /**
+         * \brief Rozwinięte wypełnienie transpozycją t (macierzy C x R).
+         * \param t Macierz transponowana.
+         */
+        template <std::size_t... I>
+        constexpr void transposeFrom(const basic_static_matrix<T, C, R>& t, std::index_sequence<I...>) {
+            int unroll[] = { 0, (v[I] = t.v[(I % C) * R + I / C], 0)... };
+            (void)unroll;
+        }
+
+    public:
+        /**
+         * \brief Konstruktor domyślny; macierz zerowa.
+         */
+        constexpr basic_static_matrix() : v{} {}
+
+        /**
+         * \brief Konstruktor inicjalizujący macierz wartościami podanymi wierszami.
+         *
+         * Brakujące wartości są zerami.
+         * \param t Co najwyżej R * C wartości.
+         * \throw std::invalid_argument Gdy wartości jest więcej niż R * C.
+         */
+        constexpr basic_static_matrix(std::initializer_list<T> t) : v{} {
+            if (t.size() > static_cast<std::size_t>(R) * C) {
+                throw std::invalid_argument("static matrix: too many values");
+            }
+            std::size_t i = 0;
+            for (const T* p = t.begin(); p != t.end(); ++p) {
+                v[i++] = *p;
+            }
+        }
+
+        /**
+         * \brief Konstruktor kopiujący wartości z macierzy dynamicznej.
+         * \param m Macierz o wymiarach R x C.
+         * \throw std::invalid_argument Gdy wymiary m są inne niż R x C.
+         */
+        explicit basic_static_matrix(const basic_matrix<T>& m) : v{} {
+            if (m.getRows() != R || m.getCols() != C) {
+                throw std::invalid_argument("static matrix: shape mismatch");
+            }
+            for (int i = 0; i < R; ++i) {
+                for (int j = 0; j < C; ++j) {
+                    v[i * C + j] = m.show(i, j);
+                }
+            }
+        }
+
+        /**
+         * \brief Tworzy macierz jednostkową.
+         * \return Macierz z jedynkami na głównej przekątnej.
+         */
+        static constexpr basic_static_matrix identity() {
+            basic_static_matrix m;
+            for (int i = 0; i < R && i < C; ++i) {
+                m.v[i * C + i] = T(1);
+            }
+            return m;
+        }
+
+        /**
+         * \brief Zwraca liczbę wierszy.
+         * \return Liczba wierszy.
+         */
+        static constexpr int getRows() { return R; }
+
+        /**
+         * \brief Zwraca liczbę kolumn.
+         * \return Liczba kolumn.
+         */
+        static constexpr int getCols() { return C; }
+
+        /**
+         * \brief Wstawia wartość do macierzy na pozycję (x, y).
+         * \param x Wiersz.
+         * \param y Kolumna.
+         * \param value Wartość do wstawienia.
+         * \return Referencja do obiektu macierzy.
+         */
+        constexpr basic_static_matrix& insert(int x, int y, T value) {
+            if (x >= 0 && x < R && y >= 0 && y < C) {
+                v[x * C + y] = value;
+            }
+            return *this;
+        }
+
+        /**
+         * \brief Zwraca wartość z macierzy na pozycji (x, y).
+         * \param x Wiersz.
+         * \param y Kolumna.
+         * \return Wartość z macierzy (0 poza zakresem).
+         */
+        constexpr T show(int x, int y) const {
+            return x >= 0 && x < R && y >= 0 && y < C ? v[x * C + y] : T(0);
+        }
+
+        /**
+         * \brief Zwraca macierz transponowaną.
+         * \return Nowa macierz C x R.
+         */
+        constexpr basic_static_matrix<T, C, R> transpose() const {
+            basic_static_matrix<T, C, R> t;
+            t.transposeFrom(*this, std::make_index_sequence<R * C>());
+            return t;
+        }
+
+        /**
+         * \brief Kopiuje macierz do macierzy dynamicznej.
+         * \return Macierz R x C.
+         */
+        basic_matrix<T> toDense() const {
+            return basic_matrix<T>(R, C, v);
+        }
+
+        /**
+         * \brief Dodaje macierz do macierzy.
+         * \param m Macierz do dodania.
+         * \return Referencja do obiektu macierzy.
+         */
+        constexpr basic_static_matrix& operator+=(const basic_static_matrix& m) {
+            zip(m, plus(), std::make_index_sequence<R * C>());
+            return *this;
+        }
+
+        /**
+         * \brief Odejmuje macierz od macierzy.
+         * \param m Macierz do odjęcia.
+         * \return Referencja do obiektu macierzy.
+         */
+        constexpr basic_static_matrix& operator-=(const basic_static_matrix& m) {
+            zip(m, minus(), std::make_index_sequence<R * C>());
+            return *this;
+        }
+
+        /**
+         * \brief Mnoży macierz przez skalar.
+         * \param a Skalar.
+         * \return Referencja do obiektu macierzy.
+         */
+        constexpr basic_static_matrix& operator*=(T a) {
+            map(a, times(), std::make_index_sequence<R * C>());
+            return *this;
+        }
+
+        /**
+         * \brief Mnoży macierz kwadratową przez macierz kwadratową (this = this * m).
+         * \param m Macierz do pomnożenia.
+         * \return Referencja do obiektu macierzy.
+         */
+        constexpr basic_static_matrix& operator*=(const basic_static_matrix& m) {
+            static_assert(R == C, "static matrix: in-place multiplication requires a square matrix");
+            *this = *this * m;
+            return *this;
+        }
+
+        /**
+         * \brief Zwraca sumę macierzy.
+         * \param m Macierz do dodania.
+         * \return Nowa macierz this + m.
+         */
+        constexpr basic_static_matrix operator+(const basic_static_matrix& m) const {
+            basic_static_matrix r = *this;
+            r += m;
+            return r;
+        }
+
+        /**
+         * \brief Zwraca różnicę macierzy.
+         * \param m Macierz do odjęcia.
+         * \return Nowa macierz this - m.
+         */
+        constexpr basic_static_matrix operator-(const basic_static_matrix& m) const {
+            basic_static_matrix r = *this;
+            r -= m;
+            return r;
+        }
+
+        /**
+         * \brief Zwraca iloczyn macierzy przez skalar.
+         * \param a Skalar.
+         * \return Nowa macierz this * a.
+         */
+        constexpr basic_static_matrix operator*(T a) const {
+            basic_static_matrix r = *this;
+            r *= a;
+            return r;
+        }
+
+        /**
+         * \brief Zwraca iloczyn macierzy R x C i C x K.
+         *
+         * Kolejność i-k-j: do wiersza wyniku dodawane są rozwinięte
+         * przeskalowane wiersze m, co kompilator wektoryzuje.
+         * \param m Macierz C x K.
+         * \return Nowa macierz R x K.
+         */
+        template <int K>
+        constexpr basic_static_matrix<T, R, K> operator*(const basic_static_matrix<T, C, K>& m) const {
+            basic_static_matrix<T, R, K> r;
+            for (int i = 0; i < R; ++i) {
+                for (int k = 0; k < C; ++k) {
+                    r.addRow(i, v[i * C + k], m, k, std::make_index_sequence<K>());
+                }
+            }
+            return r;
+        }
+
+        /**
+         * \brief Operator porównania macierzy.
+         * \param m Macierz do porównania.
+         * \return true jeśli macierze są równe, false w przeciwnym razie.
+         */
+        constexpr bool operator==(const basic_static_matrix& m) const {
+            for (int i = 0; i < R * C; ++i) {
+                if (!(v[i] == m.v[i])) return false;
+            }
+            return true;
+        }
+
+        /**
+         * \brief Operator różności macierzy.
+         * \param m Macierz do porównania.
+         * \return true jeśli macierze się różnią, false w przeciwnym razie.
+         */
+        constexpr bool operator!=(const basic_static_matrix& m) const {
+            return !(*this == m);
+        }
+
+        /**
+         * \brief Operator wyjścia dla macierzy: wiersz w linii, wartości rozdzielone spacjami (jak matrix_text).
+         * \param o Strumień wyjściowy.
+         * \param m Macierz do wypisania.
+         * \return Strumień wyjściowy.
+         */
+        friend std::ostream& operator<<(std::ostream& o, const basic_static_matrix& m) {
+            for (int i = 0; i < R; ++i) {
+                for (int j = 0; j < C; ++j) {
+                    if (j > 0) {
+                        o << ' ';
+                    }
+                    o << +m.v[i * C + j];
+                }
+                o << '\n';
+            }
+            return o;
+        }
+};
+
+/**
+ * \brief Zwraca iloczyn skalara i macierzy.
+ * \param a Skalar.
+ * \param m Macierz.
+ * \return Nowa macierz a * m.
+ */
+template <typename T, int R, int C>
+constexpr basic_static_matrix<T, R, C> operator*(T a, const basic_static_matrix<T, R, C>& m) {
+    return m * a;
+}
+
+/**
+ * \brief Macierz R x C o elementach int i wymiarach znanych w czasie kompilacji.
+ */
+template <int R, int C = R>
+using static_matrix = basic_static_matrix<int, R, C>;
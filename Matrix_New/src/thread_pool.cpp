@@ -0,0 +1,281 @@
+﻿#include "thread_pool.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/// Czy bieżący wątek wykonuje właśnie zadanie puli.
+static thread_local bool insidePool = false;
+
+/**
+* \brief Zwraca listę procesorów logicznych uporządkowaną węzłami NUMA.
+*
+* Kolejne wątki przypinane są do kolejnych pozycji tej listy, więc sąsiednie
+* porcje zadań trafiają na rdzenie tego samego węzła.
+* \return Numery procesorów logicznych.
+*/
+static std::vector<int> numaOrderedCpus() {
+    std::vector<int> cpus;
+#if defined(__linux__)
+    for (int node = 0; ; ++node) {
+        std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!in) {
+            break;
+        }
+        std::string list;
+        std::getline(in, list);
+        std::stringstream ss(list);
+        std::string range;
+        while (std::getline(ss, range, ',')) {
+            if (range.empty()) continue;
+            const std::size_t dash = range.find('-');
+            const int first = std::stoi(range.substr(0, dash));
+            const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int c = first; c <= last; ++c) {
+                cpus.push_back(c);
+            }
+        }
+    }
+#elif defined(_WIN32)
+    ULONG highest = 0;
+    if (GetNumaHighestNodeNumber(&highest)) {
+        for (ULONG node = 0; node <= highest; ++node) {
+            ULONGLONG mask = 0;
+            if (!GetNumaNodeProcessorMask(static_cast<UCHAR>(node), &mask)) continue;
+            for (int c = 0; c < 64; ++c) {
+                if (mask & (1ULL << c)) cpus.push_back(c);
+            }
+        }
+    }
+#endif
+    if (cpus.empty()) {
+        const int n = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        for (int c = 0; c < n; ++c) {
+            cpus.push_back(c);
+        }
+    }
+    return cpus;
+}
+
+/**
+* \brief Przypina wątek do procesora logicznego.
+* \param t Wątek.
+* \param cpu Numer procesora.
+*/
+static void pinThread(std::thread& t, int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);
+#elif defined(_WIN32)
+    if (cpu < 64) {
+        SetThreadAffinityMask(t.native_handle(), static_cast<DWORD_PTR>(1ULL << cpu));
+    }
+#else
+    (void)t;
+    (void)cpu;
+#endif
+}
+
+/**
+* \brief Zwraca globalną pulę używaną przez jądra obliczeniowe.
+* \return Referencja do puli.
+*/
+thread_pool& thread_pool::instance() {
+    static thread_pool pool;
+    return pool;
+}
+
+/**
+* \brief Konstruktor.
+* \param threads Liczba wątków łącznie z wywołującym (0 - liczba rdzeni).
+* \param pin Czy przypinać wątki do rdzeni (kolejno węzeł NUMA po węźle).
+*/
+thread_pool::thread_pool(int threads, bool pin)
+    : job(nullptr), remaining(0), generation(0), stopping(false), threadCount(1), pinned(false) {
+    configure(threads, pin);
+}
+
+/**
+* \brief Destruktor.
+*/
+thread_pool::~thread_pool() {
+    stop();
+}
+
+/**
+* \brief Zmienia liczbę wątków i przypinanie, restartując wątki.
+* \param threads Liczba wątków łącznie z wywołującym (0 - liczba rdzeni).
+* \param pin Czy przypinać wątki do rdzeni.
+*/
+void thread_pool::configure(int threads, bool pin) {
+    if (insidePool) {
+        throw std::logic_error("thread pool: configure() called from a pool task");
+    }
+    std::lock_guard<std::mutex> guard(submitLock);
+    stop();
+    if (threads <= 0) {
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    threadCount = threads;
+    pinned = pin;
+    start();
+}
+
+/**
+* \brief Uruchamia wątki robocze.
+*/
+void thread_pool::start() {
+    stopping = false;
+    queues.clear();
+    for (int i = 0; i < threadCount; ++i) {
+        queues.emplace_back(new worker_queue());
+    }
+    const std::vector<int> cpus = pinned ? numaOrderedCpus() : std::vector<int>();
+    for (int i = 1; i < threadCount; ++i) {
+        workers.emplace_back(&thread_pool::workerLoop, this, i);
+        if (pinned) {
+            pinThread(workers.back(), cpus[i % cpus.size()]);
+        }
+    }
+}
+
+/**
+* \brief Zatrzymuje i łączy wątki robocze.
+*/
+void thread_pool::stop() {
+    {
+        std::lock_guard<std::mutex> guard(stateLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+    workers.clear();
+}
+
+/**
+* \brief Pętla wątku roboczego.
+* \param id Numer wątku (od 1).
+*/
+void thread_pool::workerLoop(int id) {
+    insidePool = true;
+    unsigned long long seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lk(stateLock);
+            wake.wait(lk, [&] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+        while (runOne(id)) {
+        }
+    }
+}
+
+/**
+* \brief Wykonuje jedno zadanie z własnej kolejki lub podkradzione.
+* \param id Numer wątku.
+* \return false, jeśli wszystkie kolejki są puste.
+*/
+bool thread_pool::runOne(int id) {
+    int task = -1;
+    {
+        worker_queue& own = *queues[id];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            task = own.tasks.front();
+            own.tasks.pop_front();
+        }
+    }
+    for (int i = 1; task < 0 && i < threadCount; ++i) {
+        worker_queue& victim = *queues[(id + i) % threadCount];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+        }
+    }
+    if (task < 0) {
+        return false;
+    }
+    try {
+        (*job)(task);
+    } catch (...) {
+        std::lock_guard<std::mutex> guard(stateLock);
+        if (!failure) {
+            failure = std::current_exception();
+        }
+    }
+    if (remaining.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> guard(stateLock);
+        done.notify_all();
+    }
+    return true;
+}
+
+/**
+* \brief Wykonuje task(i) dla i = 0..count-1 i czeka na zakończenie.
+* \param count Liczba zadań.
+* \param task Funkcja zadania.
+*/
+void thread_pool::parallelFor(int count, const std::function<void(int)>& task) {
+    if (count <= 0) {
+        return;
+    }
+    if (insidePool || threadCount == 1 || count == 1) {
+        for (int i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(submitLock);
+    // configure() mogło zmienić liczbę wątków przed zajęciem blokady.
+    const int threads = threadCount;
+    job = &task;
+    failure = nullptr;
+    remaining = count;
+    for (int q = 0; q < threads; ++q) {
+        const int first = static_cast<int>(static_cast<long long>(count) * q / threads);
+        const int last = static_cast<int>(static_cast<long long>(count) * (q + 1) / threads);
+        std::lock_guard<std::mutex> queueGuard(queues[q]->lock);
+        for (int i = first; i < last; ++i) {
+            queues[q]->tasks.push_back(i);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lk(stateLock);
+        ++generation;
+    }
+    wake.notify_all();
+
+    insidePool = true;
+    while (runOne(0)) {
+    }
+    insidePool = false;
+
+    std::unique_lock<std::mutex> lk(stateLock);
+    done.wait(lk, [&] { return remaining.load() == 0; });
+    job = nullptr;
+    if (failure) {
+        std::exception_ptr e = failure;
+        failure = nullptr;
+        lk.unlock();
+        std::rethrow_exception(e);
+    }
+}
\ No newline at end of file
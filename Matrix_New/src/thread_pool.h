@@ -0,0 +1,121 @@
+﻿#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * \class thread_pool
+ * \brief Trwała pula wątków z kradzieżą zadań.
+ *
+ * Zadania to indeksy 0..count-1 rozdzielane w ciągłych porcjach na kolejki
+ * wątków; wątek, który opróżni swoją kolejkę, podbiera zadania z końca
+ * kolejek pozostałych. Wątek wywołujący parallelFor() pracuje jako wątek 0.
+ */
+class thread_pool {
+    private:
+        /**
+         * \brief Kolejka zadań jednego wątku.
+         */
+        struct worker_queue {
+            std::mutex lock;        ///< Chroni tasks.
+            std::deque<int> tasks;  ///< Indeksy zadań.
+        };
+
+        std::vector<std::thread> workers; ///< Wątki robocze (bez wątku wywołującego).
+        std::vector<std::unique_ptr<worker_queue>> queues; ///< Kolejki; indeks 0 należy do wątku wywołującego.
+        const std::function<void(int)>* job; ///< Aktualnie wykonywane zadanie.
+        std::atomic<int> remaining; ///< Liczba niewykonanych zadań bieżącego wywołania.
+        std::exception_ptr failure; ///< Pierwszy wyjątek zgłoszony przez zadanie.
+        std::mutex stateLock; ///< Chroni generation, stopping i failure.
+        std::condition_variable wake; ///< Budzi wątki przy nowym zadaniu.
+        std::condition_variable done; ///< Sygnalizuje zakończenie wszystkich zadań.
+        unsigned long long generation; ///< Numer kolejnego wywołania parallelFor().
+        bool stopping; ///< Czy wątki mają się zakończyć.
+        std::mutex submitLock; ///< Szereguje wywołania parallelFor().
+        std::atomic<int> threadCount; ///< Liczba wątków łącznie z wywołującym (zmieniana pod submitLock, czytana bez blokady).
+        std::atomic<bool> pinned; ///< Czy wątki są przypięte do rdzeni.
+
+        /**
+         * \brief Uruchamia wątki robocze.
+         */
+        void start();
+
+        /**
+         * \brief Zatrzymuje i łączy wątki robocze.
+         */
+        void stop();
+
+        /**
+         * \brief Pętla wątku roboczego.
+         * \param id Numer wątku (od 1).
+         */
+        void workerLoop(int id);
+
+        /**
+         * \brief Wykonuje jedno zadanie z własnej kolejki lub podkradzione.
+         * \param id Numer wątku.
+         * \return false, jeśli wszystkie kolejki są puste.
+         */
+        bool runOne(int id);
+
+    public:
+        /**
+         * \brief Zwraca globalną pulę używaną przez jądra obliczeniowe.
+         * \return Referencja do puli.
+         */
+        static thread_pool& instance();
+
+        /**
+         * \brief Konstruktor.
+         * \param threads Liczba wątków łącznie z wywołującym (0 - liczba rdzeni).
+         * \param pin Czy przypinać wątki do rdzeni (kolejno węzeł NUMA po węźle).
+         */
+        explicit thread_pool(int threads = 0, bool pin = false);
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        /**
+         * \brief Destruktor.
+         */
+        ~thread_pool();
+
+        /**
+         * \brief Zmienia liczbę wątków i przypinanie, restartując wątki.
+         *
+         * Czeka na zakończenie trwającego parallelFor(). Nie wolno jej
+         * wywoływać z wnętrza zadania puli (czekałaby na samą siebie).
+         * \param threads Liczba wątków łącznie z wywołującym (0 - liczba rdzeni).
+         * \param pin Czy przypinać wątki do rdzeni.
+         * \throw std::logic_error Przy wywołaniu z wnętrza zadania puli.
+         */
+        void configure(int threads, bool pin);
+
+        /**
+         * \brief Zwraca liczbę wątków łącznie z wywołującym.
+         * \return Liczba wątków.
+         */
+        int getThreadCount() const { return threadCount; }
+
+        /**
+         * \brief Zwraca, czy wątki są przypięte do rdzeni.
+         * \return true, jeśli przypięte.
+         */
+        bool getPinning() const { return pinned; }
+
+        /**
+         * \brief Wykonuje task(i) dla i = 0..count-1 i czeka na zakończenie.
+         *
+         * Wywołanie z wnętrza zadania wykonuje się szeregowo. Pierwszy wyjątek
+         * zgłoszony przez zadanie jest ponownie rzucany w wątku wywołującym.
+         * \param count Liczba zadań.
+         * \param task Funkcja zadania.
+         */
+        void parallelFor(int count, const std::function<void(int)>& task);
+};
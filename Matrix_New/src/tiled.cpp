@@ -0,0 +1,521 @@
+﻿#include "tiled.h"
+#include "gemm.h"
+#include "matrix_file.h"
+#include "transpose.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/// Sygnatura pliku.
+static const char MAGIC[8] = { 'M', 'T', 'R', 'X', 'T', 'I', 'L', '\0' };
+
+/// Znacznik kolejności bajtów.
+static const std::uint32_t ENDIAN_MARK = 0x01020304u;
+
+/**
+* \brief Nagłówek pliku kafelkowego (64 bajty).
+*/
+struct tiled_header {
+    char magic[8];            ///< "MTRXTIL" zakończone zerem.
+    std::uint32_t version;    ///< Wersja formatu.
+    std::uint32_t headerSize; ///< Przesunięcie pierwszego kafelka w bajtach.
+    std::uint32_t type;       ///< Typ elementu (matrix_file::element).
+    std::uint32_t typeSize;   ///< Rozmiar elementu w bajtach.
+    std::uint64_t rows;       ///< Liczba wierszy.
+    std::uint64_t cols;       ///< Liczba kolumn.
+    std::uint32_t tile;       ///< Bok kafelka.
+    std::uint32_t byteOrder;  ///< 0x01020304 zapisane w kolejności bajtów pliku.
+    std::uint8_t reserved[16]; ///< Dopełnienie do 64 bajtów (zera).
+};
+
+template <typename T>
+const std::uint32_t tiled_matrix<T>::VERSION;
+
+template <typename T>
+const std::uint32_t tiled_matrix<T>::HEADER_SIZE;
+
+template <typename T>
+const int tiled_matrix<T>::DEFAULT_TILE;
+
+template <typename T>
+const std::size_t tiled_matrix<T>::DEFAULT_BUDGET;
+
+/**
+* \brief Otwarty plik z odczytem i zapisem pod zadanym przesunięciem (bezpieczny wielowątkowo).
+*/
+template <typename T>
+struct tiled_matrix<T>::file {
+#if defined(_WIN32)
+    HANDLE handle; ///< Uchwyt pliku.
+#else
+    int fd;        ///< Deskryptor pliku.
+#endif
+
+    /**
+    * \brief Otwiera plik.
+    * \param p Ścieżka.
+    * \param writable Czy do zapisu.
+    */
+    file(const std::string& p, bool writable) {
+#if defined(_WIN32)
+        handle = CreateFileA(p.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("tiled matrix: cannot open " + p);
+        }
+#else
+        fd = ::open(p.c_str(), writable ? O_RDWR : O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("tiled matrix: cannot open " + p);
+        }
+#endif
+    }
+
+    /**
+    * \brief Zamyka plik.
+    */
+    ~file() {
+#if defined(_WIN32)
+        CloseHandle(handle);
+#else
+        ::close(fd);
+#endif
+    }
+
+    file(const file&) = delete;
+    file& operator=(const file&) = delete;
+
+    /**
+    * \brief Czyta bytes bajtów spod przesunięcia offset.
+    */
+    void read(std::uint64_t offset, void* buffer, std::size_t bytes) const {
+        char* p = static_cast<char*>(buffer);
+        while (bytes > 0) {
+            const std::size_t step = std::min<std::size_t>(bytes, std::size_t(1) << 30);
+#if defined(_WIN32)
+            OVERLAPPED at = {};
+            at.Offset = static_cast<DWORD>(offset);
+            at.OffsetHigh = static_cast<DWORD>(offset >> 32);
+            DWORD done = 0;
+            if (!ReadFile(handle, p, static_cast<DWORD>(step), &done, &at) || done == 0) {
+                throw std::runtime_error("tiled matrix: read failed");
+            }
+#else
+            const ssize_t done = ::pread(fd, p, step, static_cast<off_t>(offset));
+            if (done <= 0) {
+                throw std::runtime_error("tiled matrix: read failed");
+            }
+#endif
+            p += done;
+            offset += static_cast<std::uint64_t>(done);
+            bytes -= static_cast<std::size_t>(done);
+        }
+    }
+
+    /**
+    * \brief Zapisuje bytes bajtów pod przesunięciem offset.
+    */
+    void write(std::uint64_t offset, const void* buffer, std::size_t bytes) {
+        const char* p = static_cast<const char*>(buffer);
+        while (bytes > 0) {
+            const std::size_t step = std::min<std::size_t>(bytes, std::size_t(1) << 30);
+#if defined(_WIN32)
+            OVERLAPPED at = {};
+            at.Offset = static_cast<DWORD>(offset);
+            at.OffsetHigh = static_cast<DWORD>(offset >> 32);
+            DWORD done = 0;
+            if (!WriteFile(handle, p, static_cast<DWORD>(step), &done, &at) || done == 0) {
+                throw std::runtime_error("tiled matrix: write failed");
+            }
+#else
+            const ssize_t done = ::pwrite(fd, p, step, static_cast<off_t>(offset));
+            if (done <= 0) {
+                throw std::runtime_error("tiled matrix: write failed");
+            }
+#endif
+            p += done;
+            offset += static_cast<std::uint64_t>(done);
+            bytes -= static_cast<std::size_t>(done);
+        }
+    }
+};
+
+/**
+* \brief Konstruktor używany przez create() i open().
+*/
+template <typename T>
+tiled_matrix<T>::tiled_matrix(std::shared_ptr<file> f, const std::string& p, int r, int c, int t)
+    : io(std::move(f)), path(p), rows(r), cols(c), tile(t) {}
+
+/**
+* \brief Zwraca przesunięcie kafelka (ti, tj) w pliku.
+* \param ti Wiersz kafelka.
+* \param tj Kolumna kafelka.
+* \return Przesunięcie w bajtach.
+*/
+template <typename T>
+std::uint64_t tiled_matrix<T>::tileOffset(int ti, int tj) const {
+    if (ti < 0 || ti >= getTileRows() || tj < 0 || tj >= getTileCols()) {
+        throw std::out_of_range("tiled matrix: tile index out of range");
+    }
+    const std::uint64_t index = static_cast<std::uint64_t>(ti) * getTileCols() + tj;
+    return HEADER_SIZE + index * tile * tile * sizeof(T);
+}
+
+/**
+* \brief Tworzy plik macierzy zerowej.
+* \param path Ścieżka pliku (nadpisywanego).
+* \param r Liczba wierszy.
+* \param c Liczba kolumn.
+* \param tileSize Bok kafelka.
+* \return Macierz otwarta do odczytu i zapisu.
+*/
+template <typename T>
+tiled_matrix<T> tiled_matrix<T>::create(const std::string& path, int r, int c, int tileSize) {
+    if (r < 0 || c < 0 || tileSize <= 0) {
+        throw std::invalid_argument("tiled matrix: invalid dimensions");
+    }
+    static_assert(sizeof(tiled_header) == HEADER_SIZE, "tiled matrix: header must be 64 bytes");
+    tiled_header h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.headerSize = HEADER_SIZE;
+    h.type = static_cast<std::uint32_t>(matrix_file<T>::elementType());
+    h.typeSize = sizeof(T);
+    h.rows = static_cast<std::uint64_t>(r);
+    h.cols = static_cast<std::uint64_t>(c);
+    h.tile = static_cast<std::uint32_t>(tileSize);
+    h.byteOrder = ENDIAN_MARK;
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        if (!out) {
+            throw std::runtime_error("tiled matrix: cannot create " + path);
+        }
+    }
+    const std::uint64_t tiles = static_cast<std::uint64_t>((r + tileSize - 1) / tileSize) * ((c + tileSize - 1) / tileSize);
+    std::error_code ec;
+    std::filesystem::resize_file(path, HEADER_SIZE + tiles * tileSize * tileSize * sizeof(T), ec);
+    if (ec) {
+        throw std::runtime_error("tiled matrix: cannot create " + path);
+    }
+    return tiled_matrix(std::make_shared<file>(path, true), path, r, c, tileSize);
+}
+
+/**
+* \brief Otwiera istniejący plik macierzy.
+* \param path Ścieżka pliku.
+* \param writable Czy otworzyć do zapisu.
+* \return Macierz.
+*/
+template <typename T>
+tiled_matrix<T> tiled_matrix<T>::open(const std::string& path, bool writable) {
+    std::shared_ptr<file> f = std::make_shared<file>(path, writable);
+    tiled_header h;
+    f->read(0, &h, sizeof(h));
+    if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error("tiled matrix: not a tiled matrix file");
+    }
+    if (h.byteOrder != ENDIAN_MARK) {
+        throw std::runtime_error("tiled matrix: byte order mismatch");
+    }
+    if (h.version == 0 || h.version > VERSION || h.headerSize != HEADER_SIZE) {
+        throw std::runtime_error("tiled matrix: unsupported version");
+    }
+    if (h.type != static_cast<std::uint32_t>(matrix_file<T>::elementType()) || h.typeSize != sizeof(T)) {
+        throw std::runtime_error("tiled matrix: element type mismatch");
+    }
+    if (h.rows > INT32_MAX || h.cols > INT32_MAX || h.tile == 0 || h.tile > INT32_MAX) {
+        throw std::runtime_error("tiled matrix: invalid dimensions");
+    }
+    tiled_matrix m(f, path, static_cast<int>(h.rows), static_cast<int>(h.cols), static_cast<int>(h.tile));
+    const std::uint64_t tiles = static_cast<std::uint64_t>(m.getTileRows()) * m.getTileCols();
+    const std::uint64_t tileElems = static_cast<std::uint64_t>(m.tile) * m.tile;
+    const std::uint64_t room = (std::numeric_limits<std::uint64_t>::max() - HEADER_SIZE) / sizeof(T);
+    if (tileElems > room || tiles > room / tileElems) {
+        throw std::runtime_error("tiled matrix: invalid dimensions");
+    }
+    if (std::filesystem::file_size(path) < HEADER_SIZE + tiles * tileElems * sizeof(T)) {
+        throw std::runtime_error("tiled matrix: truncated file");
+    }
+    return m;
+}
+
+/**
+* \brief Zapisuje macierz z pamięci w formacie kafelkowym.
+* \param m Macierz.
+* \param path Ścieżka pliku (nadpisywanego).
+* \param tileSize Bok kafelka.
+* \return Macierz otwarta do odczytu i zapisu.
+*/
+template <typename T>
+tiled_matrix<T> tiled_matrix<T>::fromMatrix(const basic_matrix<T>& m, const std::string& path, int tileSize) {
+    tiled_matrix t = create(path, m.rows, m.cols, tileSize);
+    std::vector<T> buffer(static_cast<std::size_t>(tileSize) * tileSize);
+    for (int ti = 0; ti < t.getTileRows(); ++ti) {
+        for (int tj = 0; tj < t.getTileCols(); ++tj) {
+            std::fill(buffer.begin(), buffer.end(), T(0));
+            const int h = std::min(tileSize, m.rows - ti * tileSize);
+            const int w = std::min(tileSize, m.cols - tj * tileSize);
+            for (int i = 0; i < h; ++i) {
+                std::memcpy(&buffer[static_cast<std::size_t>(i) * tileSize], m.rowPtr(ti * tileSize + i) + tj * tileSize, w * sizeof(T));
+            }
+            t.writeTile(ti, tj, buffer.data());
+        }
+    }
+    return t;
+}
+
+/**
+* \brief Wczytuje całą macierz do pamięci.
+* \return Macierz.
+*/
+template <typename T>
+basic_matrix<T> tiled_matrix<T>::toMatrix() const {
+    basic_matrix<T> m(rows, cols);
+    std::vector<T> buffer(static_cast<std::size_t>(tile) * tile);
+    for (int ti = 0; ti < getTileRows(); ++ti) {
+        for (int tj = 0; tj < getTileCols(); ++tj) {
+            readTile(ti, tj, buffer.data());
+            const int h = std::min(tile, rows - ti * tile);
+            const int w = std::min(tile, cols - tj * tile);
+            for (int i = 0; i < h; ++i) {
+                std::memcpy(m.rowPtr(ti * tile + i) + tj * tile, &buffer[static_cast<std::size_t>(i) * tile], w * sizeof(T));
+            }
+        }
+    }
+    return m;
+}
+
+/**
+* \brief Wczytuje kafelek (ti, tj).
+* \param ti Wiersz kafelka.
+* \param tj Kolumna kafelka.
+* \param buffer Bufor tile * tile elementów.
+*/
+template <typename T>
+void tiled_matrix<T>::readTile(int ti, int tj, T* buffer) const {
+    io->read(tileOffset(ti, tj), buffer, static_cast<std::size_t>(tile) * tile * sizeof(T));
+}
+
+/**
+* \brief Zapisuje kafelek (ti, tj).
+* \param ti Wiersz kafelka.
+* \param tj Kolumna kafelka.
+* \param buffer Bufor tile * tile elementów.
+*/
+template <typename T>
+void tiled_matrix<T>::writeTile(int ti, int tj, const T* buffer) {
+    io->write(tileOffset(ti, tj), buffer, static_cast<std::size_t>(tile) * tile * sizeof(T));
+}
+
+/**
+* \brief Mnoży macierze: wynik = this * b, zapisywany do nowego pliku.
+* \param b Macierz cols x n o tym samym boku kafelka.
+* \param out Ścieżka pliku wyniku.
+* \param budget Budżet pamięci w bajtach.
+* \return Macierz wynikowa rows x n.
+*/
+template <typename T>
+tiled_matrix<T> tiled_matrix<T>::multiply(const tiled_matrix& b, const std::string& out, std::size_t budget) const {
+    if (cols != b.rows) {
+        throw std::invalid_argument("out-of-core multiplication: inner dimensions differ");
+    }
+    if (tile != b.tile) {
+        throw std::invalid_argument("out-of-core multiplication: tile sizes differ");
+    }
+    const std::size_t tileElems = static_cast<std::size_t>(tile) * tile;
+    const std::size_t slots = budget / (tileElems * sizeof(T));
+    if (slots < 6) {
+        throw std::invalid_argument("out-of-core multiplication: memory budget too small");
+    }
+    tiled_matrix c = create(out, rows, b.cols, tile);
+    const int tilesM = getTileRows();
+    const int tilesN = b.getTileCols();
+    const int tilesK = getTileCols();
+    if (tilesM == 0 || tilesN == 0) {
+        return c;
+    }
+
+    // Blok wyniku bm x bn plus dwa komplety paneli (bm + bn) i kafelek iloczynu.
+    const auto fits = [&](std::size_t bm, std::size_t bn) { return bm * bn + 2 * (bm + bn) + 1 <= slots; };
+    int bm = 1;
+    while (bm < tilesM && fits(bm + 1, bm + 1)) {
+        ++bm;
+    }
+    int bn = bm;
+    while (bn < tilesN && fits(bm, bn + 1)) {
+        ++bn;
+    }
+    bn = std::min(bn, tilesN);
+    while (bm < tilesM && fits(bm + 1, bn)) {
+        ++bm;
+    }
+
+    std::vector<T> block(static_cast<std::size_t>(bm) * bn * tileElems);
+    std::vector<T> panels[2];
+    panels[0].resize(static_cast<std::size_t>(bm + bn) * tileElems);
+    panels[1].resize(panels[0].size());
+    std::vector<T> product(tileElems);
+
+    for (int bi = 0; bi < tilesM; bi += bm) {
+        const int mb = std::min(bm, tilesM - bi);
+        for (int bj = 0; bj < tilesN; bj += bn) {
+            const int nb = std::min(bn, tilesN - bj);
+            std::fill(block.begin(), block.end(), T(0));
+            const auto load = [&](int tk, int set) {
+                T* p = panels[set].data();
+                for (int r = 0; r < mb; ++r) {
+                    readTile(bi + r, tk, p + r * tileElems);
+                }
+                for (int s = 0; s < nb; ++s) {
+                    b.readTile(tk, bj + s, p + (bm + s) * tileElems);
+                }
+            };
+            std::future<void> next;
+            if (tilesK > 0) {
+                next = std::async(std::launch::async, load, 0, 0);
+            }
+            for (int tk = 0; tk < tilesK; ++tk) {
+                next.get();
+                if (tk + 1 < tilesK) {
+                    next = std::async(std::launch::async, load, tk + 1, (tk + 1) & 1);
+                }
+                const T* p = panels[tk & 1].data();
+                const int kd = std::min(tile, cols - tk * tile);
+                for (int r = 0; r < mb; ++r) {
+                    const int mh = std::min(tile, rows - (bi + r) * tile);
+                    for (int s = 0; s < nb; ++s) {
+                        const int nw = std::min(tile, b.cols - (bj + s) * tile);
+                        gemm::multiply(mh, nw, kd, p + r * tileElems, tile, p + (bm + s) * tileElems, tile, product.data(), tile);
+                        T* acc = &block[(static_cast<std::size_t>(r) * bn + s) * tileElems];
+                        for (int i = 0; i < mh; ++i) {
+                            T* dst = acc + static_cast<std::size_t>(i) * tile;
+                            const T* src = &product[static_cast<std::size_t>(i) * tile];
+                            for (int j = 0; j < nw; ++j) {
+                                dst[j] = static_cast<T>(dst[j] + src[j]);
+                            }
+                        }
+                    }
+                }
+            }
+            for (int r = 0; r < mb; ++r) {
+                for (int s = 0; s < nb; ++s) {
+                    c.writeTile(bi + r, bj + s, &block[(static_cast<std::size_t>(r) * bn + s) * tileElems]);
+                }
+            }
+        }
+    }
+    return c;
+}
+
+/**
+* \brief Dodaje macierze kafelek po kafelku: wynik = this + b, zapisywany do nowego pliku.
+* \param b Macierz o tych samych wymiarach i boku kafelka.
+* \param out Ścieżka pliku wyniku.
+* \param budget Budżet pamięci w bajtach.
+* \return Macierz wynikowa.
+*/
+template <typename T>
+tiled_matrix<T> tiled_matrix<T>::add(const tiled_matrix& b, const std::string& out, std::size_t budget) const {
+    if (rows != b.rows || cols != b.cols) {
+        throw std::invalid_argument("out-of-core addition: shape mismatch");
+    }
+    if (tile != b.tile) {
+        throw std::invalid_argument("out-of-core addition: tile sizes differ");
+    }
+    const std::size_t tileElems = static_cast<std::size_t>(tile) * tile;
+    if (budget / (tileElems * sizeof(T)) < 5) {
+        throw std::invalid_argument("out-of-core addition: memory budget too small");
+    }
+    tiled_matrix c = create(out, rows, cols, tile);
+    const int tilesN = getTileCols();
+    const int tiles = getTileRows() * tilesN;
+    std::vector<T> buffers[2];
+    buffers[0].resize(2 * tileElems);
+    buffers[1].resize(2 * tileElems);
+    std::vector<T> sum(tileElems);
+    const auto load = [&](int t, int set) {
+        readTile(t / tilesN, t % tilesN, buffers[set].data());
+        b.readTile(t / tilesN, t % tilesN, buffers[set].data() + tileElems);
+    };
+    std::future<void> next;
+    if (tiles > 0) {
+        next = std::async(std::launch::async, load, 0, 0);
+    }
+    for (int t = 0; t < tiles; ++t) {
+        next.get();
+        if (t + 1 < tiles) {
+            next = std::async(std::launch::async, load, t + 1, (t + 1) & 1);
+        }
+        const T* x = buffers[t & 1].data();
+        const T* y = x + tileElems;
+        for (std::size_t i = 0; i < tileElems; ++i) {
+            sum[i] = static_cast<T>(x[i] + y[i]);
+        }
+        c.writeTile(t / tilesN, t % tilesN, sum.data());
+    }
+    return c;
+}
+
+/**
+* \brief Transponuje macierz kafelek po kafelku do nowego pliku.
+* \param out Ścieżka pliku wyniku.
+* \param budget Budżet pamięci w bajtach.
+* \return Macierz cols x rows.
+*/
+template <typename T>
+tiled_matrix<T> tiled_matrix<T>::transpose(const std::string& out, std::size_t budget) const {
+    const std::size_t tileElems = static_cast<std::size_t>(tile) * tile;
+    if (budget / (tileElems * sizeof(T)) < 3) {
+        throw std::invalid_argument("out-of-core transposition: memory budget too small");
+    }
+    tiled_matrix c = create(out, cols, rows, tile);
+    const int tilesN = getTileCols();
+    const int tiles = getTileRows() * tilesN;
+    std::vector<T> buffers[2];
+    buffers[0].resize(tileElems);
+    buffers[1].resize(tileElems);
+    std::vector<T> result(tileElems);
+    const auto load = [&](int t, int set) {
+        readTile(t / tilesN, t % tilesN, buffers[set].data());
+    };
+    std::future<void> next;
+    if (tiles > 0) {
+        next = std::async(std::launch::async, load, 0, 0);
+    }
+    for (int t = 0; t < tiles; ++t) {
+        next.get();
+        if (t + 1 < tiles) {
+            next = std::async(std::launch::async, load, t + 1, (t + 1) & 1);
+        }
+        const int ti = t / tilesN;
+        const int tj = t % tilesN;
+        std::fill(result.begin(), result.end(), T(0));
+        transposition::copy(std::min(tile, rows - ti * tile), std::min(tile, cols - tj * tile), buffers[t & 1].data(), tile, result.data(), tile);
+        c.writeTile(tj, ti, result.data());
+    }
+    return c;
+}
+
+template class tiled_matrix<std::int8_t>;
+template class tiled_matrix<std::int16_t>;
+template class tiled_matrix<std::int32_t>;
+template class tiled_matrix<std::int64_t>;
+template class tiled_matrix<float>;
+template class tiled_matrix<double>;
\ No newline at end of file
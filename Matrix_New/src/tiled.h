@@ -0,0 +1,180 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "matrix.h"
+
+/**
+ * \class tiled_matrix
+ * \brief Macierz przechowywana na dysku w kafelkach, przetwarzana strumieniowo w zadanym budżecie pamięci.
+ *
+ * Plik zaczyna się 64-bajtowym nagłówkiem, po którym następują kafelki
+ * tile x tile (wierszami, kafelki kolejno wierszami kafelków). Kafelki
+ * brzegowe dopełnione są zerami do pełnego rozmiaru, więc położenie
+ * każdego kafelka wynika z jego numeru. Operacje multiply(), add()
+ * i transpose() zapisują wynik do nowego pliku, trzymając w pamięci tylko
+ * tyle kafelków, ile mieści budżet; kolejne kafelki wczytywane są w tle,
+ * podczas obliczeń na bieżących. Obiekt można kopiować - kopie
+ * współdzielą otwarty plik.
+ */
+template <typename T>
+class tiled_matrix {
+    public:
+        static const std::uint32_t VERSION = 1;      ///< Wersja formatu zapisywana przez create().
+        static const std::uint32_t HEADER_SIZE = 64; ///< Rozmiar nagłówka i przesunięcie pierwszego kafelka w bajtach.
+        static const int DEFAULT_TILE = 1024;        ///< Domyślny bok kafelka.
+        static const std::size_t DEFAULT_BUDGET = std::size_t(1) << 30; ///< Domyślny budżet pamięci operacji (1 GiB).
+
+    private:
+        struct file;
+
+        std::shared_ptr<file> io; ///< Otwarty plik.
+        std::string path;         ///< Ścieżka pliku.
+        int rows;                 ///< Liczba wierszy.
+        int cols;                 ///< Liczba kolumn.
+        int tile;                 ///< Bok kafelka.
+
+        /**
+         * \brief Konstruktor używany przez create() i open().
+         */
+        tiled_matrix(std::shared_ptr<file> f, const std::string& p, int r, int c, int t);
+
+        /**
+         * \brief Zwraca przesunięcie kafelka (ti, tj) w pliku.
+         * \param ti Wiersz kafelka.
+         * \param tj Kolumna kafelka.
+         * \return Przesunięcie w bajtach.
+         */
+        std::uint64_t tileOffset(int ti, int tj) const;
+
+    public:
+        /**
+         * \brief Tworzy plik macierzy zerowej (rzadki, jeśli system plików to obsługuje).
+         * \param path Ścieżka pliku (nadpisywanego).
+         * \param r Liczba wierszy.
+         * \param c Liczba kolumn.
+         * \param tileSize Bok kafelka.
+         * \return Macierz otwarta do odczytu i zapisu.
+         * \throw std::invalid_argument Przy ujemnych wymiarach lub niedodatnim boku kafelka.
+         * \throw std::runtime_error Gdy pliku nie da się utworzyć.
+         */
+        static tiled_matrix create(const std::string& path, int r, int c, int tileSize = DEFAULT_TILE);
+
+        /**
+         * \brief Otwiera istniejący plik macierzy.
+         * \param path Ścieżka pliku.
+         * \param writable Czy otworzyć do zapisu.
+         * \return Macierz.
+         * \throw std::runtime_error Przy błędnym nagłówku, innym typie elementu lub niepełnym pliku.
+         */
+        static tiled_matrix open(const std::string& path, bool writable = false);
+
+        /**
+         * \brief Zapisuje macierz z pamięci w formacie kafelkowym.
+         * \param m Macierz.
+         * \param path Ścieżka pliku (nadpisywanego).
+         * \param tileSize Bok kafelka.
+         * \return Macierz otwarta do odczytu i zapisu.
+         */
+        static tiled_matrix fromMatrix(const basic_matrix<T>& m, const std::string& path, int tileSize = DEFAULT_TILE);
+
+        /**
+         * \brief Wczytuje całą macierz do pamięci.
+         * \return Macierz.
+         */
+        basic_matrix<T> toMatrix() const;
+
+        /**
+         * \brief Zwraca liczbę wierszy.
+         * \return Liczba wierszy.
+         */
+        int getRows() const { return rows; }
+
+        /**
+         * \brief Zwraca liczbę kolumn.
+         * \return Liczba kolumn.
+         */
+        int getCols() const { return cols; }
+
+        /**
+         * \brief Zwraca bok kafelka.
+         * \return Bok kafelka.
+         */
+        int getTileSize() const { return tile; }
+
+        /**
+         * \brief Zwraca liczbę wierszy kafelków.
+         * \return Liczba wierszy kafelków.
+         */
+        int getTileRows() const { return (rows + tile - 1) / tile; }
+
+        /**
+         * \brief Zwraca liczbę kolumn kafelków.
+         * \return Liczba kolumn kafelków.
+         */
+        int getTileCols() const { return (cols + tile - 1) / tile; }
+
+        /**
+         * \brief Zwraca ścieżkę pliku.
+         * \return Ścieżka.
+         */
+        const std::string& getPath() const { return path; }
+
+        /**
+         * \brief Wczytuje kafelek (ti, tj).
+         *
+         * Można wywoływać równolegle z wielu wątków.
+         * \param ti Wiersz kafelka.
+         * \param tj Kolumna kafelka.
+         * \param buffer Bufor tile * tile elementów (wierszami, odstęp tile).
+         * \throw std::out_of_range Dla kafelka spoza macierzy.
+         * \throw std::runtime_error Przy błędzie odczytu.
+         */
+        void readTile(int ti, int tj, T* buffer) const;
+
+        /**
+         * \brief Zapisuje kafelek (ti, tj).
+         * \param ti Wiersz kafelka.
+         * \param tj Kolumna kafelka.
+         * \param buffer Bufor tile * tile elementów; elementy poza macierzą powinny być zerami.
+         * \throw std::out_of_range Dla kafelka spoza macierzy.
+         * \throw std::runtime_error Przy błędzie zapisu (także gdy plik otwarto tylko do odczytu).
+         */
+        void writeTile(int ti, int tj, const T* buffer);
+
+        /**
+         * \brief Mnoży macierze: wynik = this * b, zapisywany do nowego pliku.
+         *
+         * W pamięci trzymany jest blok bm x bn kafelków wyniku oraz dwa
+         * komplety paneli (bm kafelków A i bn kafelków B): jeden liczony,
+         * drugi wczytywany w tle. bm i bn dobierane są jak największe
+         * w budżecie, co ogranicza liczbę ponownych odczytów operandów.
+         * Iloczyny kafelków liczy gemm::multiply() (równolegle).
+         * \param b Macierz cols x n o tym samym boku kafelka.
+         * \param out Ścieżka pliku wyniku.
+         * \param budget Budżet pamięci w bajtach (co najmniej 6 kafelków).
+         * \return Macierz wynikowa rows x n.
+         * \throw std::invalid_argument Przy niezgodnych wymiarach, boku kafelka lub za małym budżecie.
+         */
+        tiled_matrix multiply(const tiled_matrix& b, const std::string& out, std::size_t budget = DEFAULT_BUDGET) const;
+
+        /**
+         * \brief Dodaje macierze kafelek po kafelku: wynik = this + b, zapisywany do nowego pliku.
+         * \param b Macierz o tych samych wymiarach i boku kafelka.
+         * \param out Ścieżka pliku wyniku.
+         * \param budget Budżet pamięci w bajtach (co najmniej 5 kafelków).
+         * \return Macierz wynikowa.
+         * \throw std::invalid_argument Przy niezgodnych wymiarach, boku kafelka lub za małym budżecie.
+         */
+        tiled_matrix add(const tiled_matrix& b, const std::string& out, std::size_t budget = DEFAULT_BUDGET) const;
+
+        /**
+         * \brief Transponuje macierz kafelek po kafelku do nowego pliku.
+         * \param out Ścieżka pliku wyniku.
+         * \param budget Budżet pamięci w bajtach (co najmniej 3 kafelki).
+         * \return Macierz cols x rows.
+         * \throw std::invalid_argument Przy za małym budżecie.
+         */
+        tiled_matrix transpose(const std::string& out, std::size_t budget = DEFAULT_BUDGET) const;
+};
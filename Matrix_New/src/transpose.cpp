@@ -0,0 +1,161 @@
+﻿#include "transpose.h"
+#include "simd.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace transposition {
+
+    /**
+    * \brief Transpozycja bloku 8 x 8 liczb float jądrem int (kopiowanie bitów w rejestrach).
+    */
+    static void transpose8Float(const float* src, std::ptrdiff_t lds, float* dst, std::ptrdiff_t ldd) {
+        simd::active<int>().transpose8(reinterpret_cast<const int*>(src), lds, reinterpret_cast<int*>(dst), ldd);
+    }
+
+    /**
+    * \brief Zwraca jądro transpozycji bloku 8 x 8 dla typu T.
+    */
+    template <typename T>
+    static simd::transposeKernel<T> blockKernel() {
+        return simd::active<T>().transpose8;
+    }
+
+    /**
+    * \brief Dla float używa wektorowego jądra int, o ile nie wymuszono wersji skalarnej.
+    */
+    template <>
+    simd::transposeKernel<float> blockKernel<float>() {
+        return simd::getLevel() != simd::level::scalar ? transpose8Float : simd::active<float>().transpose8;
+    }
+
+    /**
+    * \brief Transponuje prostokąt (rows x cols) z src do dst elementami.
+    */
+    template <typename T>
+    static void copyScalar(int rows, int cols, const T* src, std::ptrdiff_t lds, T* dst, std::ptrdiff_t ldd) {
+        for (int i = 0; i < rows; ++i) {
+            for (int j = 0; j < cols; ++j) {
+                dst[j * ldd + i] = src[i * lds + j];
+            }
+        }
+    }
+
+    /**
+    * \brief Transponuje kafelek (rows x cols) z src do dst blokami 8 x 8.
+    */
+    template <typename T>
+    static void copyTile(simd::transposeKernel<T> kernel, int rows, int cols,
+                         const T* src, std::ptrdiff_t lds, T* dst, std::ptrdiff_t ldd) {
+        const int rows8 = rows / 8 * 8;
+        const int cols8 = cols / 8 * 8;
+        for (int i = 0; i < rows8; i += 8) {
+            for (int j = 0; j < cols8; j += 8) {
+                kernel(src + i * lds + j, lds, dst + j * ldd + i, ldd);
+            }
+        }
+        copyScalar(rows8, cols - cols8, src + cols8, lds, dst + cols8 * ldd, ldd);
+        copyScalar(rows - rows8, cols, src + rows8 * lds, lds, dst + rows8, ldd);
+    }
+
+    /**
+    * \brief Transpozycja poza miejscem: dst (cols x rows) = src (rows x cols)^T.
+    */
+    template <typename T>
+    void copy(int rows, int cols, const T* src, int lds, T* dst, int ldd) {
+        const simd::transposeKernel<T> kernel = blockKernel<T>();
+        for (int i = 0; i < rows; i += TILE) {
+            for (int j = 0; j < cols; j += TILE) {
+                copyTile(kernel, std::min(TILE, rows - i), std::min(TILE, cols - j),
+                         src + static_cast<std::ptrdiff_t>(i) * lds + j, lds,
+                         dst + static_cast<std::ptrdiff_t>(j) * ldd + i, ldd);
+            }
+        }
+    }
+
+    /**
+    * \brief Transponuje w miejscu kafelek leżący na przekątnej (n x n).
+    */
+    template <typename T>
+    static void diagonalTile(simd::transposeKernel<T> kernel, int n, T* a, std::ptrdiff_t lda) {
+        const int n8 = n / 8 * 8;
+        T block[64];
+        for (int i = 0; i < n8; i += 8) {
+            kernel(a + i * lda + i, lda, a + i * lda + i, lda);
+            for (int j = i + 8; j < n8; j += 8) {
+                T* upper = a + i * lda + j;
+                T* lower = a + j * lda + i;
+                kernel(upper, lda, block, 8);
+                kernel(lower, lda, upper, lda);
+                for (int r = 0; r < 8; ++r) {
+                    std::memcpy(lower + r * lda, block + r * 8, 8 * sizeof(T));
+                }
+            }
+        }
+        for (int i = 0; i < n; ++i) {
+            for (int j = std::max(i + 1, n8); j < n; ++j) {
+                std::swap(a[i * lda + j], a[j * lda + i]);
+            }
+        }
+    }
+
+    /**
+    * \brief Zamienia kafelek upper (rows x cols) z transpozycją kafelka lower (cols x rows).
+    */
+    template <typename T>
+    static void swapTiles(simd::transposeKernel<T> kernel, int rows, int cols, T* upper, T* lower, std::ptrdiff_t lda) {
+        const int rows8 = rows / 8 * 8;
+        const int cols8 = cols / 8 * 8;
+        T block[64];
+        for (int i = 0; i < rows8; i += 8) {
+            for (int j = 0; j < cols8; j += 8) {
+                T* u = upper + i * lda + j;
+                T* l = lower + j * lda + i;
+                kernel(u, lda, block, 8);
+                kernel(l, lda, u, lda);
+                for (int r = 0; r < 8; ++r) {
+                    std::memcpy(l + r * lda, block + r * 8, 8 * sizeof(T));
+                }
+            }
+        }
+        for (int i = 0; i < rows; ++i) {
+            for (int j = (i < rows8 ? cols8 : 0); j < cols; ++j) {
+                std::swap(upper[i * lda + j], lower[j * lda + i]);
+            }
+        }
+    }
+
+    /**
+    * \brief Transpozycja w miejscu macierzy kwadratowej n x n.
+    */
+    template <typename T>
+    void inPlace(int n, T* a, int lda) {
+        const simd::transposeKernel<T> kernel = blockKernel<T>();
+        for (int i = 0; i < n; i += TILE) {
+            const int rows = std::min(TILE, n - i);
+            diagonalTile(kernel, rows, a + static_cast<std::ptrdiff_t>(i) * lda + i, lda);
+            for (int j = i + TILE; j < n; j += TILE) {
+                const int cols = std::min(TILE, n - j);
+                swapTiles(kernel, rows, cols,
+                          a + static_cast<std::ptrdiff_t>(i) * lda + j,
+                          a + static_cast<std::ptrdiff_t>(j) * lda + i, lda);
+            }
+        }
+    }
+
+    template void copy<std::int8_t>(int, int, const std::int8_t*, int, std::int8_t*, int);
+    template void copy<std::int16_t>(int, int, const std::int16_t*, int, std::int16_t*, int);
+    template void copy<std::int32_t>(int, int, const std::int32_t*, int, std::int32_t*, int);
+    template void copy<std::int64_t>(int, int, const std::int64_t*, int, std::int64_t*, int);
+    template void copy<float>(int, int, const float*, int, float*, int);
+    template void copy<double>(int, int, const double*, int, double*, int);
+
+    template void inPlace<std::int8_t>(int, std::int8_t*, int);
+    template void inPlace<std::int16_t>(int, std::int16_t*, int);
+    template void inPlace<std::int32_t>(int, std::int32_t*, int);
+    template void inPlace<std::int64_t>(int, std::int64_t*, int);
+    template void inPlace<float>(int, float*, int);
+    template void inPlace<double>(int, double*, int);
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+﻿#pragma once
+
+/**
+ * \namespace transposition
+ * \brief Blokowa transpozycja macierzy przechowywanych wierszami.
+ *
+ * Macierz dzielona jest na kafelki TILE x TILE (para kafelków mieści się
+ * w L1), a te na bloki 8 x 8 transponowane przez simd::kernels::transpose8
+ * (w rejestrach dla typów 4-bajtowych). Końcówki niepodzielne przez 8
+ * obsługiwane są skalarnie. Funkcje konkretyzowane są dla typów elementów
+ * basic_matrix.
+ */
+namespace transposition {
+
+    const int TILE = 64; ///< Bok kafelka w elementach.
+
+    /**
+     * \brief Transpozycja poza miejscem: dst (cols x rows) = src (rows x cols)^T.
+     * \param rows Liczba wierszy src.
+     * \param cols Liczba kolumn src.
+     * \param src Dane źródłowe.
+     * \param lds Odstęp między wierszami src.
+     * \param dst Bufor docelowy (nie może pokrywać się z src).
+     * \param ldd Odstęp między wierszami dst.
+     */
+    template <typename T>
+    void copy(int rows, int cols, const T* src, int lds, T* dst, int ldd);
+
+    /**
+     * \brief Transpozycja w miejscu macierzy kwadratowej n x n.
+     *
+     * Bloki na przekątnej transponowane są w miejscu, a pary bloków
+     * symetrycznych względem przekątnej - zamieniane.
+     * \param n Rozmiar macierzy.
+     * \param a Dane macierzy.
+     * \param lda Odstęp między wierszami.
+     */
+    template <typename T>
+    void inPlace(int n, T* a, int lda);
+}
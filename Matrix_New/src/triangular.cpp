@@ -0,0 +1,254 @@
+﻿#include "triangular.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+/// Liczba wierszy w jednej porcji pracy równoległych jąder.
+static const int ROW_BLOCK = 32;
+
+/**
+* \brief Wykonuje task(first, last) dla porcji po ROW_BLOCK wierszy, równolegle przy dużym koszcie.
+*
+* Porcje są małe, bo koszt wierszy trójkąta rośnie liniowo; nierówności
+* wyrównuje podkradanie zadań w puli.
+* \param rows Liczba wierszy.
+* \param work Przybliżona liczba mnożeń.
+* \param task Funkcja przetwarzająca wiersze [first, last).
+*/
+template <typename F>
+static void forRowBlocks(int rows, double work, const F& task) {
+    if (work < 1 << 18) {
+        task(0, rows);
+        return;
+    }
+    thread_pool::instance().parallelFor((rows + ROW_BLOCK - 1) / ROW_BLOCK, [&](int b) {
+        task(b * ROW_BLOCK, std::min(rows, (b + 1) * ROW_BLOCK));
+    });
+}
+
+/**
+* \brief Konstruktor domyślny (macierz 0 x 0).
+*/
+template <typename T>
+triangular_matrix<T>::triangular_matrix() : size(0), half(part::lower) {}
+
+/**
+* \brief Konstruktor tworzący zerową macierz trójkątną n x n.
+* \param n Rozmiar macierzy.
+* \param p Przechowywana połowa.
+*/
+template <typename T>
+triangular_matrix<T>::triangular_matrix(int n, part p)
+    : size(n), half(p), data(static_cast<std::size_t>(n) * (n + 1) / 2, T(0)) {}
+
+/**
+* \brief Konstruktor kopiujący trójkąt kwadratowej macierzy gęstej (druga połowa jest pomijana).
+* \param m Macierz gęsta n x n.
+* \param p Przechowywana połowa.
+*/
+template <typename T>
+triangular_matrix<T>::triangular_matrix(const basic_matrix<T>& m, part p) : triangular_matrix(m.rows, p) {
+    if (m.rows != m.cols) {
+        throw std::invalid_argument("triangular matrix: source is not square");
+    }
+    for (int i = 0; i < size; ++i) {
+        std::copy(m.rowPtr(i) + firstCol(i), m.rowPtr(i) + endCol(i), triRow(i));
+    }
+}
+
+/**
+* \brief Wstawia wartość na pozycję (x, y); pozycje spoza trójkąta są pomijane.
+* \param x Wiersz.
+* \param y Kolumna.
+* \param value Wartość do wstawienia.
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+triangular_matrix<T>& triangular_matrix<T>::insert(int x, int y, T value) {
+    if (x >= 0 && x < size && y >= firstCol(x) && y < endCol(x)) {
+        triRow(x)[y - firstCol(x)] = value;
+    }
+    return *this;
+}
+
+/**
+* \brief Zwraca wartość z macierzy na pozycji (x, y).
+* \param x Wiersz.
+* \param y Kolumna.
+* \return Wartość (0 poza trójkątem i poza macierzą).
+*/
+template <typename T>
+T triangular_matrix<T>::show(int x, int y) const {
+    if (x >= 0 && x < size && y >= firstCol(x) && y < endCol(x)) {
+        return triRow(x)[y - firstCol(x)];
+    }
+    return T(0);
+}
+
+/**
+* \brief Zamienia macierz na gęstą.
+* \return Macierz gęsta n x n.
+*/
+template <typename T>
+basic_matrix<T> triangular_matrix<T>::toDense() const {
+    basic_matrix<T> result(size);
+    for (int i = 0; i < size; ++i) {
+        std::copy(triRow(i), triRow(i) + (endCol(i) - firstCol(i)), result.rowPtr(i) + firstCol(i));
+    }
+    return result;
+}
+
+/**
+* \brief Zamienia macierz w dolny trójkąt jedynek.
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+triangular_matrix<T>& triangular_matrix<T>::sub_diagonal() {
+    half = part::lower;
+    std::fill(data.begin(), data.end(), T(1));
+    return *this;
+}
+
+/**
+* \brief Zamienia macierz w górny trójkąt jedynek.
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+triangular_matrix<T>& triangular_matrix<T>::super_diagonal() {
+    half = part::upper;
+    std::fill(data.begin(), data.end(), T(1));
+    return *this;
+}
+
+/**
+* \brief Transponuje macierz: trójkąt dolny staje się górnym i odwrotnie.
+*
+* Kolumny trójkąta stają się wierszami wyniku, więc dane są przepisywane
+* do nowego bufora tej samej wielkości.
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+triangular_matrix<T>& triangular_matrix<T>::transpose() {
+    triangular_matrix result(size, half == part::lower ? part::upper : part::lower);
+    for (int i = 0; i < size; ++i) {
+        const T* r = triRow(i);
+        for (int j = firstCol(i); j < endCol(i); ++j) {
+            result.triRow(j)[i - result.firstCol(j)] = r[j - firstCol(i)];
+        }
+    }
+    std::swap(data, result.data);
+    half = result.half;
+    return *this;
+}
+
+/**
+* \brief Suma macierzy trójkątnych tej samej połowy.
+* \param m Macierz do dodania.
+* \return Nowa macierz trójkątna.
+*/
+template <typename T>
+triangular_matrix<T> triangular_matrix<T>::add(const triangular_matrix& m) const {
+    if (size != m.size || half != m.half) {
+        throw std::invalid_argument("triangular addition: shape mismatch");
+    }
+    triangular_matrix result(size, half);
+    const std::size_t n = data.size();
+    for (std::size_t q = 0; q < n; ++q) {
+        result.data[q] = data[q] + m.data[q];
+    }
+    return result;
+}
+
+/**
+* \brief Iloczyn macierzy trójkątnych tej samej połowy (wynik jest tej samej połowy).
+*
+* Wiersz i wyniku to suma wierszy k trójkąta m ważonych elementami a(i, k);
+* dla trójkąta dolnego k <= i, a wiersz k wnosi kolumny 0..k, dla górnego
+* k >= i i kolumny k..n-1 - w obu przypadkach ciągły fragment bufora.
+* \param m Macierz do pomnożenia.
+* \return Nowa macierz trójkątna.
+*/
+template <typename T>
+triangular_matrix<T> triangular_matrix<T>::multiply(const triangular_matrix& m) const {
+    if (size != m.size || half != m.half) {
+        throw std::invalid_argument("triangular multiplication: shape mismatch");
+    }
+    triangular_matrix result(size, half);
+    const double work = static_cast<double>(size) * size * size / 6;
+    forRowBlocks(size, work, [&](int first, int last) {
+        for (int i = first; i < last; ++i) {
+            T* c = result.triRow(i);
+            const int c0 = firstCol(i);
+            const T* a = triRow(i);
+            for (int k = firstCol(i); k < endCol(i); ++k) {
+                const T aik = a[k - c0];
+                const T* b = m.triRow(k);
+                const int j0 = m.firstCol(k);
+                const int n = m.endCol(k) - j0;
+                T* ck = c + (j0 - c0);
+                for (int j = 0; j < n; ++j) {
+                    ck[j] += aik * b[j];
+                }
+            }
+        }
+    });
+    return result;
+}
+
+/**
+* \brief Iloczyn z macierzą gęstą z pominięciem zerowej połowy.
+* \param m Macierz gęsta n x cols.
+* \return Macierz gęsta n x cols.
+*/
+template <typename T>
+basic_matrix<T> triangular_matrix<T>::multiply(const basic_matrix<T>& m) const {
+    if (size != m.rows) {
+        throw std::invalid_argument("triangular multiplication: inner dimensions differ");
+    }
+    basic_matrix<T> result(size, m.cols);
+    const int n = m.cols;
+    const double work = static_cast<double>(size) * size * n / 2;
+    forRowBlocks(size, work, [&](int first, int last) {
+        for (int i = first; i < last; ++i) {
+            T* c = result.rowPtr(i);
+            const int k0 = firstCol(i);
+            const T* a = triRow(i);
+            for (int k = k0; k < endCol(i); ++k) {
+                const T aik = a[k - k0];
+                const T* b = m.rowPtr(k);
+                for (int j = 0; j < n; ++j) {
+                    c[j] += aik * b[j];
+                }
+            }
+        }
+    });
+    return result;
+}
+
+/**
+* \brief Iloczyn z wektorem: y = A * x.
+* \param x Wektor n wartości.
+* \param y Wektor n wartości na wynik (nie może pokrywać się z x).
+*/
+template <typename T>
+void triangular_matrix<T>::multiply(const T* x, T* y) const {
+    for (int i = 0; i < size; ++i) {
+        const int j0 = firstCol(i);
+        const int n = endCol(i) - j0;
+        const T* a = triRow(i);
+        const T* xi = x + j0;
+        T sum = T(0);
+        for (int j = 0; j < n; ++j) {
+            sum += a[j] * xi[j];
+        }
+        y[i] = sum;
+    }
+}
+
+template class triangular_matrix<std::int8_t>;
+template class triangular_matrix<std::int16_t>;
+template class triangular_matrix<std::int32_t>;
+template class triangular_matrix<std::int64_t>;
+template class triangular_matrix<float>;
+template class triangular_matrix<double>;
\ No newline at end of file
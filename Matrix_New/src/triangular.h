@@ -0,0 +1,203 @@
+﻿#pragma once
+#include <cstddef>
+#include <vector>
+#include "matrix.h"
+
+/**
+ * \class triangular_matrix
+ * \brief Macierz trójkątna n x n w upakowanym formacie (tylko niezerowa połowa).
+ *
+ * Wiersze trójkąta zapisane są jeden za drugim: dla trójkąta dolnego
+ * wiersz i ma i + 1 elementów (kolumny 0..i), dla górnego n - i elementów
+ * (kolumny i..n-1). Zajmuje n(n+1)/2 elementów zamiast n^2.
+ *
+ * Jawnie konkretyzowana dla tych samych typów co basic_matrix.
+ */
+template <typename T>
+class triangular_matrix {
+    public:
+        typedef T value_type; ///< Typ elementu.
+
+        /**
+         * \brief Przechowywana połowa macierzy.
+         */
+        enum class part {
+            lower, ///< Trójkąt dolny (j <= i), jak basic_matrix::sub_diagonal().
+            upper  ///< Trójkąt górny (j >= i), jak basic_matrix::super_diagonal().
+        };
+
+    private:
+        int size; ///< Rozmiar macierzy.
+        part half; ///< Przechowywana połowa.
+        std::vector<T> data; ///< Upakowane wiersze trójkąta.
+
+        /**
+         * \brief Zwraca pierwszą kolumnę wiersza i w trójkącie.
+         * \param i Numer wiersza.
+         * \return Pierwsza kolumna.
+         */
+        int firstCol(int i) const { return half == part::lower ? 0 : i; }
+
+        /**
+         * \brief Zwraca kolumnę za ostatnią kolumną wiersza i w trójkącie.
+         * \param i Numer wiersza.
+         * \return Kolumna za ostatnią.
+         */
+        int endCol(int i) const { return half == part::lower ? i + 1 : size; }
+
+        /**
+         * \brief Zwraca pozycję elementu (i, firstCol(i)) w buforze.
+         * \param i Numer wiersza.
+         * \return Pozycja początku wiersza.
+         */
+        std::size_t rowStart(int i) const {
+            const std::size_t k = static_cast<std::size_t>(i);
+            return half == part::lower ? k * (k + 1) / 2 : k * size - k * (k - 1) / 2;
+        }
+
+        /**
+         * \brief Zwraca wskaźnik na element (i, firstCol(i)).
+         * \param i Numer wiersza.
+         * \return Wskaźnik na początek wiersza trójkąta.
+         */
+        T* triRow(int i) { return data.data() + rowStart(i); }
+
+        /**
+         * \brief Zwraca wskaźnik na element (i, firstCol(i)).
+         * \param i Numer wiersza.
+         * \return Wskaźnik na początek wiersza trójkąta.
+         */
+        const T* triRow(int i) const { return data.data() + rowStart(i); }
+
+    public:
+
+        /**
+         * \brief Konstruktor domyślny (macierz 0 x 0).
+         */
+        triangular_matrix();
+
+        /**
+         * \brief Konstruktor tworzący zerową macierz trójkątną n x n.
+         * \param n Rozmiar macierzy.
+         * \param p Przechowywana połowa.
+         */
+        triangular_matrix(int n, part p);
+
+        /**
+         * \brief Konstruktor kopiujący trójkąt kwadratowej macierzy gęstej (druga połowa jest pomijana).
+         * \param m Macierz gęsta n x n.
+         * \param p Przechowywana połowa.
+         * \throw std::invalid_argument Gdy m nie jest kwadratowa.
+         */
+        triangular_matrix(const basic_matrix<T>& m, part p);
+
+        /**
+         * \brief Zwraca rozmiar macierzy.
+         * \return Rozmiar macierzy.
+         */
+        int getSize() const { return size; }
+
+        /**
+         * \brief Zwraca przechowywaną połowę.
+         * \return Połowa macierzy.
+         */
+        part getPart() const { return half; }
+
+        /**
+         * \brief Wstawia wartość na pozycję (x, y); pozycje spoza trójkąta są pomijane.
+         * \param x Wiersz.
+         * \param y Kolumna.
+         * \param value Wartość do wstawienia.
+         * \return Referencja do obiektu macierzy.
+         */
+        triangular_matrix& insert(int x, int y, T value);
+
+        /**
+         * \brief Zwraca wartość z macierzy na pozycji (x, y).
+         * \param x Wiersz.
+         * \param y Kolumna.
+         * \return Wartość (0 poza trójkątem i poza macierzą).
+         */
+        T show(int x, int y) const;
+
+        /**
+         * \brief Zamienia macierz na gęstą.
+         * \return Macierz gęsta n x n.
+         */
+        basic_matrix<T> toDense() const;
+
+        /**
+         * \brief Zamienia macierz w dolny trójkąt jedynek (odpowiednik basic_matrix::sub_diagonal()).
+         * \return Referencja do obiektu macierzy.
+         */
+        triangular_matrix& sub_diagonal();
+
+        /**
+         * \brief Zamienia macierz w górny trójkąt jedynek (odpowiednik basic_matrix::super_diagonal()).
+         * \return Referencja do obiektu macierzy.
+         */
+        triangular_matrix& super_diagonal();
+
+        /**
+         * \brief Transponuje macierz: trójkąt dolny staje się górnym i odwrotnie.
+         * \return Referencja do obiektu macierzy.
+         */
+        triangular_matrix& transpose();
+
+        /**
+         * \brief Suma macierzy trójkątnych tej samej połowy.
+         * \param m Macierz do dodania.
+         * \return Nowa macierz trójkątna.
+         * \throw std::invalid_argument Przy niezgodnym rozmiarze lub połowie.
+         */
+        triangular_matrix add(const triangular_matrix& m) const;
+
+        /**
+         * \brief Iloczyn macierzy trójkątnych tej samej połowy (wynik jest tej samej połowy).
+         *
+         * Liczone są tylko niezerowe składniki: około n^3/6 mnożeń zamiast n^3.
+         * \param m Macierz do pomnożenia.
+         * \return Nowa macierz trójkątna.
+         * \throw std::invalid_argument Przy niezgodnym rozmiarze lub połowie.
+         */
+        triangular_matrix multiply(const triangular_matrix& m) const;
+
+        /**
+         * \brief Iloczyn z macierzą gęstą z pominięciem zerowej połowy (n^2/2 * cols mnożeń).
+         * \param m Macierz gęsta n x cols.
+         * \return Macierz gęsta n x cols.
+         * \throw std::invalid_argument Gdy liczba wierszy m różni się od n.
+         */
+        basic_matrix<T> multiply(const basic_matrix<T>& m) const;
+
+        /**
+         * \brief Iloczyn z wektorem: y = A * x.
+         * \param x Wektor n wartości.
+         * \param y Wektor n wartości na wynik (nie może pokrywać się z x).
+         */
+        void multiply(const T* x, T* y) const;
+};
+
+/**
+ * \brief Tworzy dolny trójkąt jedynek n x n w upakowanym formacie.
+ * \param n Rozmiar macierzy.
+ * \return Macierz trójkątna dolna.
+ */
+template <typename T>
+triangular_matrix<T> basic_matrix<T>::sub_diagonal(int n) {
+    triangular_matrix<T> result(n, triangular_matrix<T>::part::lower);
+    result.sub_diagonal();
+    return result;
+}
+
+/**
+ * \brief Tworzy górny trójkąt jedynek n x n w upakowanym formacie.
+ * \param n Rozmiar macierzy.
+ * \return Macierz trójkątna górna.
+ */
+template <typename T>
+triangular_matrix<T> basic_matrix<T>::super_diagonal(int n) {
+    triangular_matrix<T> result(n, triangular_matrix<T>::part::upper);
+    result.super_diagonal();
+    return result;
+}
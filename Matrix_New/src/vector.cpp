@@ -0,0 +1,387 @@
+﻿#include "vector.h"
+#include "gemv.h"
+#include "instrument.h"
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+/**
+* \brief Alokuje wyzerowany bufor n elementów.
+* \param n Liczba elementów.
+*/
+template <typename T>
+void basic_vector<T>::allocateMemory(int n) {
+    const std::size_t bytes = static_cast<std::size_t>(n) * sizeof(T);
+    MATRIX_ALLOCATION(T, bytes);
+    data = static_cast<T*>(alloc->allocate(bytes, basic_matrix<T>::ALIGNMENT));
+    std::memset(data, 0, bytes);
+}
+
+/**
+* \brief Zwalnia bufor.
+*/
+template <typename T>
+void basic_vector<T>::deallocateMemory() {
+    alloc->deallocate(data, static_cast<std::size_t>(size) * sizeof(T), basic_matrix<T>::ALIGNMENT);
+    data = nullptr;
+}
+
+/**
+* \brief Konstruktor domyślny (wektor pusty).
+*/
+template <typename T>
+basic_vector<T>::basic_vector() : data(nullptr), size(0), alloc(&currentAllocator()) {}
+
+/**
+* \brief Konstruktor tworzący wektor zerowy.
+* \param n Liczba elementów.
+*/
+template <typename T>
+basic_vector<T>::basic_vector(int n) : data(nullptr), size(n), alloc(&currentAllocator()) {
+    allocateMemory(n);
+}
+
+/**
+* \brief Konstruktor kopiujący wartości z tablicy.
+* \param n Liczba elementów.
+* \param t Tablica n wartości.
+*/
+template <typename T>
+basic_vector<T>::basic_vector(int n, const T* t) : basic_vector(n) {
+    std::memcpy(data, t, static_cast<std::size_t>(n) * sizeof(T));
+}
+
+/**
+* \brief Konstruktor tworzący wektor zerowy w pamięci podanego alokatora.
+* \param n Liczba elementów.
+* \param a Alokator.
+*/
+template <typename T>
+basic_vector<T>::basic_vector(int n, allocator& a) : data(nullptr), size(n), alloc(&a) {
+    allocateMemory(n);
+}
+
+/**
+* \brief Konstruktor kopiujący.
+* \param v Wektor do skopiowania.
+*/
+template <typename T>
+basic_vector<T>::basic_vector(const basic_vector& v) : data(nullptr), size(v.size), alloc(&currentAllocator()) {
+    if (v.data == nullptr) {
+        return;
+    }
+    allocateMemory(size);
+    std::memcpy(data, v.data, static_cast<std::size_t>(size) * sizeof(T));
+}
+
+/**
+* \brief Konstruktor przenoszący.
+* \param v Wektor, którego bufor zostanie przejęty.
+*/
+template <typename T>
+basic_vector<T>::basic_vector(basic_vector&& v) noexcept : data(v.data), size(v.size), alloc(v.alloc) {
+    v.data = nullptr;
+    v.size = 0;
+}
+
+/**
+* \brief Kopiujący operator przypisania.
+* \param v Wektor do skopiowania.
+* \return Referencja do obiektu wektora.
+*/
+template <typename T>
+basic_vector<T>& basic_vector<T>::operator=(const basic_vector& v) {
+    if (this == &v) {
+        return *this;
+    }
+    if (data != nullptr && v.data != nullptr && size == v.size) {
+        std::memcpy(data, v.data, static_cast<std::size_t>(size) * sizeof(T));
+        return *this;
+    }
+    basic_vector copy(v);
+    swap(copy);
+    return *this;
+}
+
+/**
+* \brief Przenoszący operator przypisania.
+* \param v Wektor, którego bufor zostanie przejęty.
+* \return Referencja do obiektu wektora.
+*/
+template <typename T>
+basic_vector<T>& basic_vector<T>::operator=(basic_vector&& v) noexcept {
+    if (this != &v) {
+        basic_vector moved(std::move(v));
+        swap(moved);
+    }
+    return *this;
+}
+
+/**
+* \brief Zamienia zawartość dwóch wektorów bez kopiowania danych.
+* \param v Wektor do zamiany.
+*/
+template <typename T>
+void basic_vector<T>::swap(basic_vector& v) noexcept {
+    std::swap(data, v.data);
+    std::swap(size, v.size);
+    std::swap(alloc, v.alloc);
+}
+
+/**
+* \brief Destruktor.
+*/
+template <typename T>
+basic_vector<T>::~basic_vector() {
+    if (data) {
+        deallocateMemory();
+    }
+}
+
+/**
+* \brief Zmienia rozmiar; przy równym rozmiarze zachowuje bufor i dane.
+* \param n Liczba elementów.
+* \return Referencja do obiektu wektora.
+*/
+template <typename T>
+basic_vector<T>& basic_vector<T>::allocate(int n) {
+    if (data != nullptr && size == n) {
+        return *this;
+    }
+    if (data != nullptr) {
+        deallocateMemory();
+    }
+    size = n;
+    allocateMemory(n);
+    return *this;
+}
+
+/**
+* \brief Wstawia wartość na pozycję i.
+* \param i Indeks.
+* \param value Wartość.
+* \return Referencja do obiektu wektora.
+*/
+template <typename T>
+basic_vector<T>& basic_vector<T>::insert(int i, T value) {
+    if (i >= 0 && i < size) {
+        data[i] = value;
+    }
+    return *this;
+}
+
+/**
+* \brief Zwraca wartość na pozycji i.
+* \param i Indeks.
+* \return Wartość.
+*/
+template <typename T>
+T basic_vector<T>::show(int i) const {
+    if (i >= 0 && i < size) {
+        return data[i];
+    }
+    return 0;
+}
+
+/**
+* \brief Wypełnia wektor wartościami o zadanym rozkładzie (globalne ziarno, kolejny strumień).
+* \param o Rozkład i generator.
+* \return Referencja do obiektu wektora.
+*/
+template <typename T>
+basic_vector<T>& basic_vector<T>::randomize(const rng::options& o) {
+    return randomize(o, rng::getSeed(), rng::nextStream());
+}
+
+/**
+* \brief Wypełnia wektor powtarzalnie wartościami o zadanym rozkładzie.
+* \param o Rozkład i generator.
+* \param seed Ziarno.
+* \param stream Numer strumienia.
+* \return Referencja do obiektu wektora.
+*/
+template <typename T>
+basic_vector<T>& basic_vector<T>::randomize(const rng::options& o, std::uint64_t seed, std::uint64_t stream) {
+    rng::fill(data, 1, size, size, o, seed, stream);
+    return *this;
+}
+
+/**
+* \brief Operator porównania wektorów.
+* \param v Wektor do porównania.
+* \return true, jeśli rozmiary i wszystkie elementy są równe.
+*/
+template <typename T>
+bool basic_vector<T>::operator==(const basic_vector& v) const {
+    return size == v.size && (size == 0 || std::memcmp(data, v.data, static_cast<std::size_t>(size) * sizeof(T)) == 0);
+}
+
+/**
+* \brief Iloczyn y = A * x do istniejącego wektora.
+* \param a Macierz m x n.
+* \param x Wektor n elementów.
+* \param y Wektor wyniku (różny od x).
+*/
+template <typename T>
+void basic_vector<T>::multiply(const basic_matrix<T>& a, const basic_vector& x, basic_vector& y) {
+    if (x.size != a.cols) {
+        throw std::invalid_argument("matrix-vector multiplication: dimensions differ");
+    }
+    MATRIX_SCOPE("gemv", T, 2.0 * a.rows * a.cols, (1.0 * a.rows * a.cols + a.cols + a.rows) * sizeof(T));
+    y.allocate(a.rows);
+    gemv::multiply(a.rows, a.cols, a.data, a.stride, x.data, y.data);
+}
+
+/**
+* \brief Iloczyn y = x * A do istniejącego wektora.
+* \param x Wektor m elementów.
+* \param a Macierz m x n.
+* \param y Wektor wyniku (różny od x).
+*/
+template <typename T>
+void basic_vector<T>::multiply(const basic_vector& x, const basic_matrix<T>& a, basic_vector& y) {
+    if (x.size != a.rows) {
+        throw std::invalid_argument("vector-matrix multiplication: dimensions differ");
+    }
+    MATRIX_SCOPE("gemv transposed", T, 2.0 * a.rows * a.cols, (1.0 * a.rows * a.cols + a.cols + a.rows) * sizeof(T));
+    y.allocate(a.cols);
+    gemv::multiplyTransposed(a.rows, a.cols, a.data, a.stride, x.data, y.data);
+}
+
+/**
+* \brief Iloczyn y = A * x dla widoku A.
+* \param a Widok m x n.
+* \param x Wektor n elementów.
+* \param y Wektor wyniku.
+*/
+template <typename T>
+void basic_vector<T>::multiplyView(const matrix_view<const T>& a, const basic_vector& x, basic_vector& y) {
+    if (x.size != a.getCols()) {
+        throw std::invalid_argument("matrix-vector multiplication: dimensions differ");
+    }
+    const int m = a.getRows();
+    const int n = a.getCols();
+    MATRIX_SCOPE("gemv view", T, 2.0 * m * n, (1.0 * m * n + n + m) * sizeof(T));
+    y.allocate(m);
+    const std::ptrdiff_t limit = std::numeric_limits<int>::max();
+    if (a.getColStep() == 1 && a.getRowStep() <= limit) {
+        gemv::multiply(m, n, a.getData(), static_cast<int>(a.getRowStep()), x.data, y.data);
+    } else if (a.getRowStep() == 1 && a.getColStep() <= limit) {
+        // A^T ma ciągłe wiersze: A * x = x * A^T.
+        gemv::multiplyTransposed(n, m, a.getData(), static_cast<int>(a.getColStep()), x.data, y.data);
+    } else {
+        for (int i = 0; i < m; ++i) {
+            T sum = 0;
+            for (int j = 0; j < n; ++j) {
+                sum += a(i, j) * x.data[j];
+            }
+            y.data[i] = sum;
+        }
+    }
+}
+
+/**
+* \brief Iloczyn y = x * A dla widoku A.
+* \param x Wektor m elementów.
+* \param a Widok m x n.
+* \param y Wektor wyniku.
+*/
+template <typename T>
+void basic_vector<T>::multiplyView(const basic_vector& x, const matrix_view<const T>& a, basic_vector& y) {
+    if (x.size != a.getRows()) {
+        throw std::invalid_argument("vector-matrix multiplication: dimensions differ");
+    }
+    const int m = a.getRows();
+    const int n = a.getCols();
+    MATRIX_SCOPE("gemv view transposed", T, 2.0 * m * n, (1.0 * m * n + n + m) * sizeof(T));
+    y.allocate(n);
+    const std::ptrdiff_t limit = std::numeric_limits<int>::max();
+    if (a.getColStep() == 1 && a.getRowStep() <= limit) {
+        gemv::multiplyTransposed(m, n, a.getData(), static_cast<int>(a.getRowStep()), x.data, y.data);
+    } else if (a.getRowStep() == 1 && a.getColStep() <= limit) {
+        // A^T ma ciągłe wiersze: x * A = A^T * x.
+        gemv::multiply(n, m, a.getData(), static_cast<int>(a.getColStep()), x.data, y.data);
+    } else {
+        std::memset(y.data, 0, static_cast<std::size_t>(n) * sizeof(T));
+        for (int i = 0; i < m; ++i) {
+            for (int j = 0; j < n; ++j) {
+                y.data[j] += x.data[i] * a(i, j);
+            }
+        }
+    }
+}
+
+/**
+* \brief Iloczyn A z wieloma wektorami naraz.
+* \param a Macierz m x n.
+* \param xs Macierz k x n (wiersze to wektory wejściowe).
+* \return Macierz k x m (wiersze to wektory wynikowe).
+*/
+template <typename T>
+basic_matrix<T> basic_vector<T>::multiplyBatch(const basic_matrix<T>& a, const basic_matrix<T>& xs) {
+    if (xs.cols != a.cols) {
+        throw std::invalid_argument("batched matrix-vector multiplication: dimensions differ");
+    }
+    MATRIX_SCOPE("gemv batch", T, 2.0 * a.rows * a.cols * xs.rows, (1.0 * a.rows * a.cols + 1.0 * xs.rows * (a.cols + a.rows)) * sizeof(T));
+    basic_matrix<T> ys(xs.rows, a.rows);
+    gemv::multiplyBatch(a.rows, a.cols, a.data, a.stride, xs.rows, xs.data, xs.stride, ys.data, ys.stride);
+    return ys;
+}
+
+/**
+* \brief Operator strumieniowy: elementy w jednym wierszu, rozdzielone spacjami.
+* \param o Strumień wyjściowy.
+* \param v Wektor.
+* \return Strumień wyjściowy.
+*/
+template <typename T>
+std::ostream& operator<<(std::ostream& o, const basic_vector<T>& v) {
+    for (int i = 0; i < v.size; ++i) {
+        if (i > 0) {
+            o << ' ';
+        }
+        // int8_t wypisywany jest jako liczba, nie znak.
+        o << +v.data[i];
+    }
+    return o << '\n';
+}
+
+/**
+* \brief Iloczyn macierz - wektor: A * x.
+* \param a Macierz m x n.
+* \param x Wektor n elementów.
+* \return Nowy wektor m elementów.
+*/
+template <typename T>
+basic_vector<T> operator*(const basic_matrix<T>& a, const basic_vector<T>& x) {
+    basic_vector<T> y;
+    basic_vector<T>::multiply(a, x, y);
+    return y;
+}
+
+/**
+* \brief Iloczyn wektor - macierz: x * A.
+* \param x Wektor m elementów.
+* \param a Macierz m x n.
+* \return Nowy wektor n elementów.
+*/
+template <typename T>
+basic_vector<T> operator*(const basic_vector<T>& x, const basic_matrix<T>& a) {
+    basic_vector<T> y;
+    basic_vector<T>::multiply(x, a, y);
+    return y;
+}
+
+#define VECTOR_INSTANTIATE(T) \
+    template class basic_vector<T>; \
+    template std::ostream& operator<<(std::ostream&, const basic_vector<T>&); \
+    template basic_vector<T> operator*(const basic_matrix<T>&, const basic_vector<T>&); \
+    template basic_vector<T> operator*(const basic_vector<T>&, const basic_matrix<T>&);
+
+VECTOR_INSTANTIATE(std::int8_t)
+VECTOR_INSTANTIATE(std::int16_t)
+VECTOR_INSTANTIATE(std::int32_t)
+VECTOR_INSTANTIATE(std::int64_t)
+VECTOR_INSTANTIATE(float)
+VECTOR_INSTANTIATE(double)
\ No newline at end of file
@@ -0,0 +1,314 @@
+﻿#pragma once
+#include <iostream>
+#include <cstddef>
+#include <cstdint>
+#include "matrix.h"
+#include "memory.h"
+#include "rng.h"
+
+/**
+ * \class basic_vector
+ * \brief Wektor n elementów typu T w ciągłym, wyrównanym buforze.
+ *
+ * Bufor pochodzi z alokatora currentAllocator() (jak w basic_matrix).
+ * Iloczyny z macierzami liczone są jądrami gemv w czasie O(m * n).
+ * Jawnie konkretyzowany dla int8_t, int16_t, int32_t, int64_t, float
+ * i double.
+ */
+template <typename T>
+class basic_vector {
+    public:
+        typedef T value_type; ///< Typ elementu.
+
+    private:
+        T* data;          ///< Bufor elementów.
+        int size;         ///< Liczba elementów.
+        allocator* alloc; ///< Alokator bufora.
+
+        /**
+         * \brief Alokuje wyzerowany bufor n elementów.
+         * \param n Liczba elementów.
+         */
+        void allocateMemory(int n);
+
+        /**
+         * \brief Zwalnia bufor.
+         */
+        void deallocateMemory();
+
+        /**
+         * \brief Iloczyn y = A * x dla widoku A.
+         * \param a Widok m x n.
+         * \param x Wektor n elementów.
+         * \param y Wektor wyniku.
+         */
+        static void multiplyView(const matrix_view<const T>& a, const basic_vector& x, basic_vector& y);
+
+        /**
+         * \brief Iloczyn y = x * A dla widoku A.
+         * \param x Wektor m elementów.
+         * \param a Widok m x n.
+         * \param y Wektor wyniku.
+         */
+        static void multiplyView(const basic_vector& x, const matrix_view<const T>& a, basic_vector& y);
+
+    public:
+        /**
+         * \brief Konstruktor domyślny (wektor pusty).
+         */
+        basic_vector();
+
+        /**
+         * \brief Konstruktor tworzący wektor zerowy.
+         * \param n Liczba elementów.
+         */
+        explicit basic_vector(int n);
+
+        /**
+         * \brief Konstruktor kopiujący wartości z tablicy.
+         * \param n Liczba elementów.
+         * \param t Tablica n wartości.
+         */
+        basic_vector(int n, const T* t);
+
+        /**
+         * \brief Konstruktor tworzący wektor zerowy w pamięci podanego alokatora.
+         * \param n Liczba elementów.
+         * \param a Alokator (musi żyć dłużej niż wektor).
+         */
+        basic_vector(int n, allocator& a);
+
+        /**
+         * \brief Konstruktor kopiujący.
+         * \param v Wektor do skopiowania.
+         */
+        basic_vector(const basic_vector& v);
+
+        /**
+         * \brief Konstruktor przenoszący.
+         * \param v Wektor, którego bufor zostanie przejęty.
+         */
+        basic_vector(basic_vector&& v) noexcept;
+
+        /**
+         * \brief Kopiujący operator przypisania (bez alokacji przy równych rozmiarach).
+         * \param v Wektor do skopiowania.
+         * \return Referencja do obiektu wektora.
+         */
+        basic_vector& operator=(const basic_vector& v);
+
+        /**
+         * \brief Przenoszący operator przypisania.
+         * \param v Wektor, którego bufor zostanie przejęty.
+         * \return Referencja do obiektu wektora.
+         */
+        basic_vector& operator=(basic_vector&& v) noexcept;
+
+        /**
+         * \brief Zamienia zawartość dwóch wektorów bez kopiowania danych.
+         * \param v Wektor do zamiany.
+         */
+        void swap(basic_vector& v) noexcept;
+
+        /**
+         * \brief Destruktor.
+         */
+        ~basic_vector();
+
+        /**
+         * \brief Zmienia rozmiar; przy równym rozmiarze zachowuje bufor i dane, w przeciwnym razie zeruje.
+         * \param n Liczba elementów.
+         * \return Referencja do obiektu wektora.
+         */
+        basic_vector& allocate(int n);
+
+        /**
+         * \brief Zwraca liczbę elementów.
+         * \return Liczba elementów.
+         */
+        int getSize() const { return size; }
+
+        /**
+         * \brief Zwraca wskaźnik na bufor elementów.
+         * \return Wskaźnik na pierwszy element.
+         */
+        T* getData() { return data; }
+
+        /**
+         * \brief Zwraca wskaźnik na bufor elementów.
+         * \return Wskaźnik na pierwszy element.
+         */
+        const T* getData() const { return data; }
+
+        /**
+         * \brief Zwraca alokator bufora.
+         * \return Alokator.
+         */
+        allocator& getAllocator() const { return *alloc; }
+
+        /**
+         * \brief Dostęp do elementu bez sprawdzania zakresu.
+         * \param i Indeks.
+         * \return Referencja do elementu.
+         */
+        T& operator[](int i) { return data[i]; }
+
+        /**
+         * \brief Dostęp do elementu bez sprawdzania zakresu.
+         * \param i Indeks.
+         * \return Referencja do elementu.
+         */
+        const T& operator[](int i) const { return data[i]; }
+
+        /**
+         * \brief Wstawia wartość na pozycję i (poza zakresem - bez zmian).
+         * \param i Indeks.
+         * \param value Wartość.
+         * \return Referencja do obiektu wektora.
+         */
+        basic_vector& insert(int i, T value);
+
+        /**
+         * \brief Zwraca wartość na pozycji i (poza zakresem - 0).
+         * \param i Indeks.
+         * \return Wartość.
+         */
+        T show(int i) const;
+
+        /**
+         * \brief Wypełnia wektor wartościami o zadanym rozkładzie (globalne ziarno, kolejny strumień).
+         * \param o Rozkład i generator.
+         * \return Referencja do obiektu wektora.
+         */
+        basic_vector& randomize(const rng::options& o);
+
+        /**
+         * \brief Wypełnia wektor powtarzalnie wartościami o zadanym rozkładzie.
+         * \param o Rozkład i generator.
+         * \param seed Ziarno.
+         * \param stream Numer strumienia.
+         * \return Referencja do obiektu wektora.
+         */
+        basic_vector& randomize(const rng::options& o, std::uint64_t seed, std::uint64_t stream = 0);
+
+        /**
+         * \brief Operator porównania wektorów.
+         * \param v Wektor do porównania.
+         * \return true, jeśli rozmiary i wszystkie elementy są równe.
+         */
+        bool operator==(const basic_vector& v) const;
+
+        /**
+         * \brief Iloczyn y = A * x do istniejącego wektora (bez alokacji, gdy y ma już rozmiar A.getRows()).
+         * \param a Macierz m x n.
+         * \param x Wektor n elementów.
+         * \param y Wektor wyniku (różny od x).
+         * \throw std::invalid_argument Gdy rozmiar x różni się od liczby kolumn A.
+         */
+        static void multiply(const basic_matrix<T>& a, const basic_vector& x, basic_vector& y);
+
+        /**
+         * \brief Iloczyn y = x * A do istniejącego wektora (bez alokacji, gdy y ma już rozmiar A.getCols()).
+         * \param x Wektor m elementów.
+         * \param a Macierz m x n.
+         * \param y Wektor wyniku (różny od x).
+         * \throw std::invalid_argument Gdy rozmiar x różni się od liczby wierszy A.
+         */
+        static void multiply(const basic_vector& x, const basic_matrix<T>& a, basic_vector& y);
+
+        /**
+         * \brief Iloczyn y = A * x dla widoku A (bloku, wycinka, widoku transponowanego), bez kopiowania A.
+         *
+         * Widok o ciągłych wierszach liczony jest jądrem gemv::multiply(),
+         * widok transponowany - gemv::multiplyTransposed() na danych źródłowych.
+         * \param a Widok m x n.
+         * \param x Wektor n elementów.
+         * \param y Wektor wyniku (różny od x).
+         * \throw std::invalid_argument Gdy rozmiar x różni się od liczby kolumn widoku.
+         */
+        template <typename U>
+        static void multiply(const matrix_view<U>& a, const basic_vector& x, basic_vector& y) {
+            multiplyView(a, x, y);
+        }
+
+        /**
+         * \brief Iloczyn y = x * A dla widoku A (bloku, wycinka, widoku transponowanego), bez kopiowania A.
+         * \param x Wektor m elementów.
+         * \param a Widok m x n.
+         * \param y Wektor wyniku (różny od x).
+         * \throw std::invalid_argument Gdy rozmiar x różni się od liczby wierszy widoku.
+         */
+        template <typename U>
+        static void multiply(const basic_vector& x, const matrix_view<U>& a, basic_vector& y) {
+            multiplyView(x, a, y);
+        }
+
+        /**
+         * \brief Iloczyn A z wieloma wektorami naraz: wiersz v wyniku to A * (wiersz v xs).
+         *
+         * A czytana jest raz dla wszystkich wektorów, co przy k wektorach
+         * zmniejsza ruch w pamięci niemal k-krotnie względem k wywołań multiply().
+         * \param a Macierz m x n.
+         * \param xs Macierz k x n; każdy wiersz to jeden wektor wejściowy.
+         * \return Macierz k x m; każdy wiersz to jeden wektor wynikowy.
+         * \throw std::invalid_argument Gdy liczba kolumn xs różni się od liczby kolumn A.
+         */
+        static basic_matrix<T> multiplyBatch(const basic_matrix<T>& a, const basic_matrix<T>& xs);
+
+        /**
+         * \brief Operator strumieniowy: elementy w jednym wierszu, rozdzielone spacjami.
+         * \param o Strumień wyjściowy.
+         * \param v Wektor.
+         * \return Strumień wyjściowy.
+         */
+        template <typename U>
+        friend std::ostream& operator<<(std::ostream& o, const basic_vector<U>& v);
+};
+
+/**
+ * \brief Iloczyn macierz - wektor: A * x.
+ * \param a Macierz m x n.
+ * \param x Wektor n elementów.
+ * \return Nowy wektor m elementów.
+ * \throw std::invalid_argument Gdy rozmiar x różni się od liczby kolumn A.
+ */
+template <typename T>
+basic_vector<T> operator*(const basic_matrix<T>& a, const basic_vector<T>& x);
+
+/**
+ * \brief Iloczyn wektor - macierz: x * A.
+ * \param x Wektor m elementów.
+ * \param a Macierz m x n.
+ * \return Nowy wektor n elementów.
+ * \throw std::invalid_argument Gdy rozmiar x różni się od liczby wierszy A.
+ */
+template <typename T>
+basic_vector<T> operator*(const basic_vector<T>& x, const basic_matrix<T>& a);
+
+/**
+ * \brief Iloczyn widok - wektor: A * x.
+ * \param a Widok m x n.
+ * \param x Wektor n elementów.
+ * \return Nowy wektor m elementów.
+ * \throw std::invalid_argument Gdy rozmiar x różni się od liczby kolumn widoku.
+ */
+template <typename U>
+basic_vector<typename matrix_view<U>::value_type> operator*(const matrix_view<U>& a, const basic_vector<typename matrix_view<U>::value_type>& x) {
+    basic_vector<typename matrix_view<U>::value_type> y;
+    basic_vector<typename matrix_view<U>::value_type>::multiply(a, x, y);
+    return y;
+}
+
+/**
+ * \brief Iloczyn wektor - widok: x * A.
+ * \param x Wektor m elementów.
+ * \param a Widok m x n.
+ * \return Nowy wektor n elementów.
+ * \throw std::invalid_argument Gdy rozmiar x różni się od liczby wierszy widoku.
+ */
+template <typename U>
+basic_vector<typename matrix_view<U>::value_type> operator*(const basic_vector<typename matrix_view<U>::value_type>& x, const matrix_view<U>& a) {
+    basic_vector<typename matrix_view<U>::value_type> y;
+    basic_vector<typename matrix_view<U>::value_type>::multiply(x, a, y);
+    return y;
+}
@@ -0,0 +1,85 @@
+﻿#include "view.h"
+#include "gemm.h"
+#include "instrument.h"
+#include "transpose.h"
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+/**
+* \brief Zwraca wiersze widoku ułożone ciągle (stały odstęp, kolumny obok siebie).
+*
+* Widok o ciągłych wierszach zwracany jest bez kopiowania. Widok
+* transponowany pakowany jest do buffer blokową transpozycją, a pozostałe -
+* kopiowane element po elemencie.
+* \param v Widok.
+* \param buffer Macierz pomocnicza (alokowana tylko przy pakowaniu).
+* \param ld Odstęp między wierszami zwróconych danych.
+* \return Wskaźnik na element (0, 0).
+*/
+template <typename T>
+static const T* rowMajor(const matrix_view<const T>& v, basic_matrix<T>& buffer, int& ld) {
+    const std::ptrdiff_t limit = std::numeric_limits<int>::max();
+    if (v.getColStep() == 1 && v.getRowStep() <= limit) {
+        ld = static_cast<int>(v.getRowStep());
+        return v.getData();
+    }
+    buffer.allocate(v.getRows(), v.getCols());
+    if (v.getRowStep() == 1 && v.getColStep() <= limit) {
+        transposition::copy(v.getCols(), v.getRows(), v.getData(), static_cast<int>(v.getColStep()), buffer.view().getData(), buffer.getStride());
+    } else {
+        buffer.view() = v;
+    }
+    ld = buffer.getStride();
+    return buffer.view().getData();
+}
+
+/**
+* \brief Mnoży widoki: C = A * B (wynik zapisywany w macierzy, na którą wskazuje c).
+* \param a Widok m x k.
+* \param b Widok k x n.
+* \param c Widok m x n.
+*/
+template <typename T>
+void multiply(const typename matrix_view<T>::const_view& a, const typename matrix_view<T>::const_view& b, const matrix_view<T>& c) {
+    if (a.getCols() != b.getRows()) {
+        throw std::invalid_argument("matrix multiplication: inner dimensions differ");
+    }
+    if (c.getRows() != a.getRows() || c.getCols() != b.getCols()) {
+        throw std::invalid_argument("matrix multiplication: shape mismatch");
+    }
+    const int m = a.getRows();
+    const int n = b.getCols();
+    const int k = a.getCols();
+    MATRIX_SCOPE("view multiply", T, 2.0 * m * n * k, (1.0 * m * k + 1.0 * k * n + 1.0 * m * n) * sizeof(T));
+    if (m == 0 || n == 0) {
+        return;
+    }
+    if (k == 0) {
+        c.fill(0);
+        return;
+    }
+    basic_matrix<T> packedA;
+    basic_matrix<T> packedB;
+    int lda;
+    int ldb;
+    const T* pa = rowMajor(a, packedA, lda);
+    const T* pb = rowMajor(b, packedB, ldb);
+    if (c.getColStep() == 1 && c.getRowStep() <= std::numeric_limits<int>::max()) {
+        gemm::multiply(m, n, k, pa, lda, pb, ldb, c.getData(), static_cast<int>(c.getRowStep()));
+    } else {
+        basic_matrix<T> result(m, n);
+        gemm::multiply(m, n, k, pa, lda, pb, ldb, result.view().getData(), result.getStride());
+        c = result;
+    }
+}
+
+#define VIEW_INSTANTIATE(T) \
+    template void multiply<T>(const matrix_view<T>::const_view&, const matrix_view<T>::const_view&, const matrix_view<T>&);
+
+VIEW_INSTANTIATE(std::int8_t)
+VIEW_INSTANTIATE(std::int16_t)
+VIEW_INSTANTIATE(std::int32_t)
+VIEW_INSTANTIATE(std::int64_t)
+VIEW_INSTANTIATE(float)
+VIEW_INSTANTIATE(double)
\ No newline at end of file
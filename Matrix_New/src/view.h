@@ -0,0 +1,632 @@
+﻿#pragma once
+#include "matrix.h"
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * \class matrix_view
+ * \brief Widok części istniejącej macierzy bez kopiowania i bez alokacji.
+ *
+ * Element (i, j) widoku leży pod adresem data + i * rowStep + j * colStep,
+ * więc jeden typ opisuje bloki, pojedyncze wiersze i kolumny, przekątne,
+ * wycinki z krokiem i widoki transponowane. matrix_view<T> pozwala
+ * zapisywać elementy, matrix_view<const T> - tylko je czytać. Stałość
+ * widoku jest płytka (jak std::span): kopia widoku wskazuje te same dane,
+ * a przypisanie do widoku kopiuje elementy do wskazywanej macierzy.
+ *
+ * Widok jest liściem wyrażeń macierzowych (expr.h), więc operatory +, -
+ * i działania z liczbą przyjmują go bezpośrednio, a przypisanie
+ * wyrażenia do widoku zapisuje wynik w macierzy źródłowej. Widok nie
+ * przedłuża życia macierzy, a zmiana jej wymiarów (allocate, transpose
+ * macierzy prostokątnej, przypisanie) unieważnia widok.
+ */
+template <typename T>
+class matrix_view : public matrix_expr<matrix_view<T>> {
+    public:
+        typedef typename std::remove_const<T>::type value_type; ///< Typ elementu.
+        typedef matrix_view<const value_type> const_view; ///< Widok tylko do odczytu tych samych danych.
+
+    private:
+        T* data; ///< Adres elementu (0, 0).
+        int rows; ///< Liczba wierszy.
+        int cols; ///< Liczba kolumn.
+        std::ptrdiff_t rowStep; ///< Odstęp (w elementach) między kolejnymi wierszami.
+        std::ptrdiff_t colStep; ///< Odstęp (w elementach) między kolejnymi kolumnami.
+
+        template <typename U> friend class matrix_view;
+
+        /**
+         * \brief Sprawdza, czy prostokąt [r0, r0 + r) x [c0, c0 + c) mieści się w widoku.
+         * \throw std::out_of_range Gdy prostokąt wychodzi poza widok.
+         */
+        void check(int r0, int c0, int r, int c) const {
+            if (r0 < 0 || c0 < 0 || r < 0 || c < 0 || r0 > rows - r || c0 > cols - c) {
+                throw std::out_of_range("matrix view: block out of range");
+            }
+        }
+
+        /**
+         * \brief Zwraca zakres adresów zajmowanych przez widok.
+         * \param first Najniższy adres.
+         * \param last Adres za najwyższym elementem.
+         */
+        void extent(const value_type*& first, const value_type*& last) const {
+            first = data;
+            last = data;
+            if (rows > 0 && cols > 0) {
+                last = data + (rows - 1) * rowStep + (cols - 1) * colStep + 1;
+            }
+        }
+
+        /**
+         * \brief Wylicza wyrażenie do elementów widoku fragmentami wierszy.
+         * \param e Węzeł wyrażenia o wymiarach równych wymiarom widoku.
+         * \throw std::invalid_argument Przy niezgodnych wymiarach.
+         */
+        template <typename E>
+        void assign(const E& e) const {
+            static_assert(!std::is_const<T>::value, "matrix view: assignment through a read-only view");
+            static_assert(std::is_same<value_type, typename E::value_type>::value, "matrix view: element type mismatch");
+            if (e.getRows() != rows || e.getCols() != cols) {
+                throw std::invalid_argument("matrix view: shape mismatch");
+            }
+            const int block = basic_matrix<value_type>::EXPR_BLOCK;
+            value_type scratch[basic_matrix<value_type>::EXPR_BLOCK];
+            for (int i = 0; i < rows; ++i) {
+                T* r = data + i * rowStep;
+                for (int j = 0; j < cols; j += block) {
+                    const int n = cols - j < block ? cols - j : block;
+                    if (colStep == 1) {
+                        const value_type* s = e.source(i, j, n, r + j);
+                        if (s != r + j) {
+                            std::memmove(r + j, s, n * sizeof(value_type));
+                        }
+                    } else {
+                        const value_type* s = e.source(i, j, n, scratch);
+                        for (int q = 0; q < n; ++q) {
+                            r[(j + q) * colStep] = s[q];
+                        }
+                    }
+                }
+            }
+        }
+
+        /**
+         * \brief Sprawdza, czy v współdzieli pamięć z widokiem przy innym układzie elementów.
+         *
+         * Wtedy wyliczanie fragmentami wierszy mogłoby czytać elementy
+         * nadpisane już w tym samym przejściu.
+         * \param v Widok.
+         * \return true, gdy zakresy adresów się przecinają, a widoki nie są identyczne.
+         */
+        bool aliases(const const_view& v) const {
+            const value_type* first;
+            const value_type* last;
+            const value_type* vFirst;
+            const value_type* vLast;
+            extent(first, last);
+            v.extent(vFirst, vLast);
+            std::less<const value_type*> before;
+            const bool same = v.data == data && v.rowStep == rowStep && v.colStep == colStep;
+            return !same && before(first, vLast) && before(vFirst, last);
+        }
+
+        /**
+         * \brief Kopiuje elementy v do elementów widoku, przez macierz pomocniczą, gdy v pokrywa się z widokiem.
+         * \param v Widok o tych samych wymiarach.
+         * \throw std::invalid_argument Przy niezgodnych wymiarach.
+         */
+        void copy(const const_view& v) const {
+            if (aliases(v)) {
+                assign(matrix_ref<value_type>(basic_matrix<value_type>(v)));
+            } else {
+                assign(v);
+            }
+        }
+
+        /**
+         * \brief Dodaje (lub odejmuje) elementy v, przez macierz pomocniczą, gdy v pokrywa się z widokiem.
+         * \param v Widok o tych samych wymiarach.
+         * \throw std::invalid_argument Przy niezgodnych wymiarach.
+         */
+        template <bool Subtract>
+        void accumulate(const const_view& v) const {
+            if (aliases(v)) {
+                const basic_matrix<value_type> copy(v);
+                assign(sum_expr<matrix_view, matrix_ref<value_type>, Subtract>(*this, matrix_ref<value_type>(copy)));
+            } else {
+                assign(sum_expr<matrix_view, const_view, Subtract>(*this, v));
+            }
+        }
+
+    public:
+        /**
+         * \brief Konstruktor widoku na dowolnym buforze.
+         * \param d Adres elementu (0, 0).
+         * \param r Liczba wierszy.
+         * \param c Liczba kolumn.
+         * \param rs Odstęp między wierszami w elementach.
+         * \param cs Odstęp między kolumnami w elementach.
+         */
+        matrix_view(T* d, int r, int c, std::ptrdiff_t rs, std::ptrdiff_t cs = 1)
+            : data(d), rows(r), cols(c), rowStep(rs), colStep(cs) {}
+
+        /**
+         * \brief Konwersja widoku zapisywalnego na widok tylko do odczytu.
+         * \param v Widok źródłowy.
+         */
+        template <typename U, typename = typename std::enable_if<std::is_same<const U, T>::value && !std::is_const<U>::value>::type>
+        matrix_view(const matrix_view<U>& v) : data(v.data), rows(v.rows), cols(v.cols), rowStep(v.rowStep), colStep(v.colStep) {}
+
+        matrix_view(const matrix_view&) = default;
+
+        /**
+         * \brief Kopiuje elementy v do elementów widoku (nie zmienia tego, na co wskazuje widok).
+         *
+         * Gdy v pokrywa się w pamięci z widokiem (np. przesunięty blok tej
+         * samej macierzy), elementy kopiowane są najpierw do macierzy pomocniczej.
+         * \param v Widok o tych samych wymiarach.
+         * \return Referencja do widoku.
+         * \throw std::invalid_argument Przy niezgodnych wymiarach.
+         */
+        const matrix_view& operator=(const matrix_view& v) const {
+            copy(v);
+            return *this;
+        }
+
+        /**
+         * \brief Kopiuje elementy v do elementów widoku (nie zmienia tego, na co wskazuje widok).
+         * \param v Widok o tych samych wymiarach i typie elementów.
+         * \return Referencja do widoku.
+         * \throw std::invalid_argument Przy niezgodnych wymiarach.
+         */
+        template <typename U>
+        const matrix_view& operator=(const matrix_view<U>& v) const {
+            copy(v);
+            return *this;
+        }
+
+        /**
+         * \brief Kopiuje elementy macierzy m do elementów widoku.
+         * \param m Macierz o wymiarach widoku.
+         * \return Referencja do widoku.
+         * \throw std::invalid_argument Przy niezgodnych wymiarach.
+         */
+        const matrix_view& operator=(const basic_matrix<value_type>& m) const {
+            copy(m.view());
+            return *this;
+        }
+
+        /**
+         * \brief Zapisuje wartości wyrażenia w elementach widoku.
+         *
+         * Wyrażenie może czytać ten sam widok (np. v = v * 2 + w), ale nie
+         * inne, pokrywające się z nim fragmenty tej samej macierzy.
+         * \param e Wyrażenie o wymiarach widoku.
+         * \return Referencja do widoku.
+         * \throw std::invalid_argument Przy niezgodnych wymiarach.
+         */
+        template <typename E>
+        const matrix_view& operator=(const matrix_expr<E>& e) const {
+            assign(e.self());
+            return *this;
+        }
+
+        /**
+         * \brief Dodaje wyrażenie do elementów widoku.
+         * \param e Wyrażenie o wymiarach widoku.
+         * \return Referencja do widoku.
+         */
+        template <typename E>
+        const matrix_view& operator+=(const matrix_expr<E>& e) const {
+            assign(sum_expr<matrix_view, E, false>(*this, e.self()));
+            return *this;
+        }
+
+        /**
+         * \brief Odejmuje wyrażenie od elementów widoku.
+         * \param e Wyrażenie o wymiarach widoku.
+         * \return Referencja do widoku.
+         */
+        template <typename E>
+        const matrix_view& operator-=(const matrix_expr<E>& e) const {
+            assign(sum_expr<matrix_view, E, true>(*this, e.self()));
+            return *this;
+        }
+
+        /**
+         * \brief Dodaje elementy widoku v; v może pokrywać się z widokiem (np. przesunięty blok).
+         * \param v Widok o wymiarach widoku.
+         * \return Referencja do widoku.
+         */
+        template <typename U>
+        const matrix_view& operator+=(const matrix_view<U>& v) const {
+            accumulate<false>(v);
+            return *this;
+        }
+
+        /**
+         * \brief Odejmuje elementy widoku v; v może pokrywać się z widokiem (np. przesunięty blok).
+         * \param v Widok o wymiarach widoku.
+         * \return Referencja do widoku.
+         */
+        template <typename U>
+        const matrix_view& operator-=(const matrix_view<U>& v) const {
+            accumulate<true>(v);
+            return *this;
+        }
+
+        /**
+         * \brief Dodaje macierz do elementów widoku.
+         * \param m Macierz o wymiarach widoku.
+         * \return Referencja do widoku.
+         */
+        const matrix_view& operator+=(const basic_matrix<value_type>& m) const {
+            return operator+=(matrix_ref<value_type>(m));
+        }
+
+        /**
+         * \brief Odejmuje macierz od elementów widoku.
+         * \param m Macierz o wymiarach widoku.
+         * \return Referencja do widoku.
+         */
+        const matrix_view& operator-=(const basic_matrix<value_type>& m) const {
+            return operator-=(matrix_ref<value_type>(m));
+        }
+
+        /**
+         * \brief Dodaje liczbę do elementów widoku.
+         * \param a Liczba do dodania.
+         * \return Referencja do widoku.
+         */
+        const matrix_view& operator+=(value_type a) const {
+            assign(scalar_expr<matrix_view>(*this, simd::active<value_type>().add, a));
+            return *this;
+        }
+
+        /**
+         * \brief Odejmuje liczbę od elementów widoku.
+         * \param a Liczba do odjęcia.
+         * \return Referencja do widoku.
+         */
+        const matrix_view& operator-=(value_type a) const {
+            assign(scalar_expr<matrix_view>(*this, simd::active<value_type>().sub, a));
+            return *this;
+        }
+
+        /**
+         * \brief Mnoży elementy widoku przez liczbę.
+         * \param a Liczba do pomnożenia.
+         * \return Referencja do widoku.
+         */
+        const matrix_view& operator*=(value_type a) const {
+            assign(scalar_expr<matrix_view>(*this, simd::active<value_type>().mul, a));
+            return *this;
+        }
+
+        /**
+         * \brief Wypełnia widok wartością.
+         * \param value Wartość.
+         * \return Referencja do widoku.
+         */
+        const matrix_view& fill(value_type value) const {
+            static_assert(!std::is_const<T>::value, "matrix view: assignment through a read-only view");
+            for (int i = 0; i < rows; ++i) {
+                T* r = data + i * rowStep;
+                if (colStep == 1) {
+                    simd::active<value_type>().fill(r, cols, value);
+                } else {
+                    for (int j = 0; j < cols; ++j) {
+                        r[j * colStep] = value;
+                    }
+                }
+            }
+            return *this;
+        }
+
+        /**
+         * \brief Zwraca liczbę wierszy.
+         * \return Liczba wierszy.
+         */
+        int getRows() const { return rows; }
+
+        /**
+         * \brief Zwraca liczbę kolumn.
+         * \return Liczba kolumn.
+         */
+        int getCols() const { return cols; }
+
+        /**
+         * \brief Zwraca odstęp między wierszami w elementach.
+         * \return Odstęp między wierszami.
+         */
+        std::ptrdiff_t getRowStep() const { return rowStep; }
+
+        /**
+         * \brief Zwraca odstęp między kolumnami w elementach (1 - elementy wiersza leżą obok siebie).
+         * \return Odstęp między kolumnami.
+         */
+        std::ptrdiff_t getColStep() const { return colStep; }
+
+        /**
+         * \brief Zwraca adres elementu (0, 0).
+         * \return Wskaźnik na dane.
+         */
+        T* getData() const { return data; }
+
+        /**
+         * \brief Dostęp do elementu (i, j) bez sprawdzania zakresu.
+         * \param i Wiersz.
+         * \param j Kolumna.
+         * \return Referencja do elementu.
+         */
+        T& operator()(int i, int j) const { return data[i * rowStep + j * colStep]; }
+
+        /**
+         * \brief Wstawia wartość na pozycję (x, y); pozycje spoza widoku są pomijane.
+         * \param x Wiersz.
+         * \param y Kolumna.
+         * \param value Wartość do wstawienia.
+         * \return Referencja do widoku.
+         */
+        const matrix_view& insert(int x, int y, value_type value) const {
+            if (x >= 0 && x < rows && y >= 0 && y < cols) {
+                (*this)(x, y) = value;
+            }
+            return *this;
+        }
+
+        /**
+         * \brief Zwraca wartość na pozycji (x, y); dla pozycji spoza widoku zwraca 0.
+         * \param x Wiersz.
+         * \param y Kolumna.
+         * \return Wartość elementu.
+         */
+        value_type show(int x, int y) const {
+            if (x >= 0 && x < rows && y >= 0 && y < cols) {
+                return (*this)(x, y);
+            }
+            return 0;
+        }
+
+        /**
+         * \brief Zwraca widok bloku r x c zaczynającego się w (r0, c0).
+         * \param r0 Pierwszy wiersz.
+         * \param c0 Pierwsza kolumna.
+         * \param r Liczba wierszy.
+         * \param c Liczba kolumn.
+         * \return Widok bloku.
+         * \throw std::out_of_range Gdy blok wychodzi poza widok.
+         */
+        matrix_view block(int r0, int c0, int r, int c) const {
+            check(r0, c0, r, c);
+            return matrix_view(data + r0 * rowStep + c0 * colStep, r, c, rowStep, colStep);
+        }
+
+        /**
+         * \brief Zwraca widok wiersza i (1 x cols).
+         * \param i Numer wiersza.
+         * \return Widok wiersza.
+         * \throw std::out_of_range Dla wiersza spoza widoku.
+         */
+        matrix_view row(int i) const {
+            return block(i, 0, 1, cols);
+        }
+
+        /**
+         * \brief Zwraca widok kolumny j (rows x 1).
+         * \param j Numer kolumny.
+         * \return Widok kolumny.
+         * \throw std::out_of_range Dla kolumny spoza widoku.
+         */
+        matrix_view column(int j) const {
+            return block(0, j, rows, 1);
+        }
+
+        /**
+         * \brief Zwraca widok k-tej przekątnej jako wiersz (1 x długość przekątnej).
+         * \param k Numer przekątnej (0 - główna, dodatnie - nad, ujemne - pod główną).
+         * \return Widok przekątnej (pusty, gdy przekątna nie istnieje).
+         */
+        matrix_view diagonal(int k = 0) const {
+            const int r0 = k < 0 ? -k : 0;
+            const int c0 = k > 0 ? k : 0;
+            int n = rows - r0 < cols - c0 ? rows - r0 : cols - c0;
+            if (n < 0) {
+                n = 0;
+            }
+            return matrix_view(n > 0 ? data + r0 * rowStep + c0 * colStep : data, 1, n, rowStep, rowStep + colStep);
+        }
+
+        /**
+         * \brief Zwraca widok co rstep-tego wiersza i co cstep-tej kolumny.
+         * \param r0 Pierwszy wiersz.
+         * \param c0 Pierwsza kolumna.
+         * \param r Liczba wybieranych wierszy.
+         * \param c Liczba wybieranych kolumn.
+         * \param rstep Krok po wierszach (>= 1).
+         * \param cstep Krok po kolumnach (>= 1).
+         * \return Widok wycinka r x c.
+         * \throw std::out_of_range Gdy wycinek wychodzi poza widok lub krok jest mniejszy od 1.
+         */
+        matrix_view slice(int r0, int c0, int r, int c, int rstep, int cstep) const {
+            if (rstep < 1 || cstep < 1) {
+                throw std::out_of_range("matrix view: slice step must be positive");
+            }
+            check(r0, c0, r > 0 ? 1 : 0, c > 0 ? 1 : 0);
+            if (r < 0 || c < 0 || (r > 0 && (r - 1) > (rows - 1 - r0) / rstep) || (c > 0 && (c - 1) > (cols - 1 - c0) / cstep)) {
+                throw std::out_of_range("matrix view: block out of range");
+            }
+            return matrix_view(data + r0 * rowStep + c0 * colStep, r, c, rowStep * rstep, colStep * cstep);
+        }
+
+        /**
+         * \brief Zwraca widok transponowany (cols x rows) tych samych danych.
+         * \return Widok transponowany.
+         */
+        matrix_view transposed() const {
+            return matrix_view(data, cols, rows, colStep, rowStep);
+        }
+
+        /**
+         * \brief Zwraca wskaźnik na fragment wiersza i od kolumny j.
+         *
+         * Gdy elementy wiersza leżą obok siebie, zwraca wskaźnik na dane bez
+         * kopiowania; w przeciwnym razie zbiera n elementów do out.
+         */
+        const value_type* source(int i, int j, int n, value_type* out) const {
+            const T* p = data + i * rowStep + j * colStep;
+            if (colStep == 1) {
+                return p;
+            }
+            for (int q = 0; q < n; ++q) {
+                out[q] = p[q * colStep];
+            }
+            return out;
+        }
+};
+
+/**
+ * \brief Mnoży widoki: C = A * B (wynik zapisywany w macierzy, na którą wskazuje c).
+ *
+ * Operandy, których wiersze leżą w pamięci ciągle, przekazywane są do
+ * gemm::multiply() bez kopiowania. Widoki transponowane pakowane są
+ * blokową transpozycją, a pozostałe (wycinki z krokiem kolumn) -
+ * kopiowane do bufora pomocniczego. C nie może pokrywać się z A ani z B.
+ * Konkretyzowane dla typów elementów basic_matrix.
+ * \param a Widok m x k.
+ * \param b Widok k x n.
+ * \param c Widok m x n.
+ * \throw std::invalid_argument Przy niezgodnych wymiarach.
+ */
+template <typename T>
+void multiply(const typename matrix_view<T>::const_view& a, const typename matrix_view<T>::const_view& b, const matrix_view<T>& c);
+
+/**
+ * \brief Iloczyn widoków: nowa macierz A * B.
+ * \param a Widok m x k.
+ * \param b Widok k x n.
+ * \return Nowa macierz m x n.
+ * \throw std::invalid_argument Gdy liczba kolumn a różni się od liczby wierszy b.
+ */
+template <typename A, typename B>
+basic_matrix<typename matrix_view<A>::value_type> operator*(const matrix_view<A>& a, const matrix_view<B>& b) {
+    typedef typename matrix_view<A>::value_type value_type;
+    static_assert(std::is_same<value_type, typename matrix_view<B>::value_type>::value, "matrix view: element type mismatch");
+    if (a.getCols() != b.getRows()) {
+        throw std::invalid_argument("matrix multiplication: inner dimensions differ");
+    }
+    basic_matrix<value_type> result(a.getRows(), b.getCols());
+    multiply<value_type>(a, b, result.view());
+    return result;
+}
+
+/**
+ * \brief Iloczyn macierzy i widoku: nowa macierz A * B (bez kopiowania widoku o ciągłych wierszach).
+ * \param a Macierz m x k.
+ * \param b Widok k x n.
+ * \return Nowa macierz m x n; a pozostaje bez zmian.
+ * \throw std::invalid_argument Gdy liczba kolumn a różni się od liczby wierszy b.
+ */
+template <typename T, typename U>
+basic_matrix<T> operator*(const basic_matrix<T>& a, const matrix_view<U>& b) {
+    return a.view() * b;
+}
+
+/**
+ * \brief Iloczyn niestałej macierzy i widoku: nowa macierz A * B.
+ *
+ * Dokładne dopasowanie dla niestałego a, rozstrzygające niejednoznaczność
+ * ze składowym operator*(const basic_matrix&) i konwersją widoku na macierz.
+ * \param a Macierz m x k (bez zmian).
+ * \param b Widok k x n.
+ * \return Nowa macierz m x n.
+ * \throw std::invalid_argument Gdy liczba kolumn a różni się od liczby wierszy b.
+ */
+template <typename T, typename U>
+basic_matrix<T> operator*(basic_matrix<T>& a, const matrix_view<U>& b) {
+    return static_cast<const basic_matrix<T>&>(a).view() * b;
+}
+
+/**
+ * \brief Iloczyn widoku i macierzy: nowa macierz A * B (bez kopiowania widoku o ciągłych wierszach).
+ * \param a Widok m x k.
+ * \param b Macierz k x n.
+ * \return Nowa macierz m x n.
+ * \throw std::invalid_argument Gdy liczba kolumn a różni się od liczby wierszy b.
+ */
+template <typename U, typename T>
+basic_matrix<T> operator*(const matrix_view<U>& a, const basic_matrix<T>& b) {
+    return a * b.view();
+}
+
+/**
+* \brief Dodaje elementy widoku; v może pokrywać się z macierzą.
+* \param v Widok o wymiarach macierzy.
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+template <typename U>
+basic_matrix<T>& basic_matrix<T>::operator+=(const matrix_view<U>& v) {
+    view() += v;
+    return *this;
+}
+
+/**
+* \brief Odejmuje elementy widoku; v może pokrywać się z macierzą.
+* \param v Widok o wymiarach macierzy.
+* \return Referencja do obiektu macierzy.
+*/
+template <typename T>
+template <typename U>
+basic_matrix<T>& basic_matrix<T>::operator-=(const matrix_view<U>& v) {
+    view() -= v;
+    return *this;
+}
+
+/**
+* \brief Zwraca widok całej macierzy.
+* \return Widok rows x cols.
+*/
+template <typename T>
+matrix_view<T> basic_matrix<T>::view() {
+    return matrix_view<T>(data, rows, cols, stride);
+}
+
+/**
+* \brief Zwraca widok całej macierzy tylko do odczytu.
+* \return Widok rows x cols.
+*/
+template <typename T>
+matrix_view<const T> basic_matrix<T>::view() const {
+    return matrix_view<const T>(data, rows, cols, stride);
+}
+
+/**
+* \brief Zwraca widok bloku r x c zaczynającego się w (r0, c0).
+* \param r0 Pierwszy wiersz.
+* \param c0 Pierwsza kolumna.
+* \param r Liczba wierszy.
+* \param c Liczba kolumn.
+* \return Widok bloku.
+*/
+template <typename T>
+matrix_view<T> basic_matrix<T>::block(int r0, int c0, int r, int c) {
+    return view().block(r0, c0, r, c);
+}
+
+/**
+* \brief Zwraca widok bloku r x c tylko do odczytu.
+* \param r0 Pierwszy wiersz.
+* \param c0 Pierwsza kolumna.
+* \param r Liczba wierszy.
+* \param c Liczba kolumn.
+* \return Widok bloku.
+*/
+template <typename T>
+matrix_view<const T> basic_matrix<T>::block(int r0, int c0, int r, int c) const {
+    return view().block(r0, c0, r, c);
+}
\ No newline at end of file